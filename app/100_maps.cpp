@@ -2,65 +2,35 @@
  * Video #100: Maps
  */
 
+#include "city.h"
+#include "flat_hash_map.h"
+
 // Needed for uint64_t
 #include <cstddef>
 #include <iostream>
 #include <optional>
 #include <map>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
-struct CityRecord
-{
-  std::string name;
-  uint64_t population;
-  double latitude;
-  double longitude;
-
-  // To use a CityRecord as the key in a std::map (an ordered map), we need to
-  // implement the less than operator so that two elements of the map can be
-  // compared. Note that both the lhs and rhs of the comparison need to be
-  // marked as const.
-  // The less than operator not only plays the role of comparison for an ordered
-  // map, it also defines a unique key within the map. So in this case, if two
-  // cities have the same population, then this can cause problems.
-  // What problems?
-  bool operator<(const CityRecord& other) const {
-    return population < other.population;
-  }
-};
-
-// Define a "template specialization" for std::hash within the std namespace
-// that is "specialized" by the type (CityRecord) that we'll use as the map's
-// key.
-namespace std 
-{
-  // A template "specialization" uses an empty template argument
-  template<>
-  struct hash<CityRecord>
-  {
-    // Overload the call operator and return a 64 bit uint (size_t).
-    size_t operator()(const CityRecord& key)
-    {
-      // Define the hash function here. 
-      return hash<std::string>()(key.name);
-    }
-  };
-}
+// NOTE: CityRecord (and its std::hash specialization) now lives in city.h, so
+// that other examples and benchmarks can share it.
 
 using CityMap = std::unordered_map<std::string, CityRecord>;
-std::optional<uint64_t> get_population(const CityMap& map, std::string key) {
-  // Check to see see if the key exists
-  if (map.find(key) != map.end()) {
-      // Because no const version of the index operator [] exists for maps,
-      // we have to use at() to retrieve the element.
-      return map.at(key).population;
-  }
-
-  // The method above performs two lookups: one for find() and a second for
-  // at(). We can avoid the second (unecessary) lookup by saving the iterator
-  // returned by find(). This method of using find() and at() should always be
-  // preferred.
+std::optional<uint64_t> get_population(const CityMap& map,
+  const std::string& key) {
+  // A first attempt might check to see if the key exists with find(), and
+  // then (because no const version of the index operator [] exists for maps)
+  // retrieve the element with at():
+  //
+  //   if (map.find(key) != map.end()) {
+  //     return map.at(key).population;
+  //   }
+  //
+  // But that performs two lookups: one for find() and a second for at(). We
+  // can avoid the second (unecessary) lookup by saving the iterator returned
+  // by find(). This method should always be preferred.
   if (const auto it = map.find(key); it != map.end()) {
     return (it->second).population;
   }
@@ -69,6 +39,19 @@ std::optional<uint64_t> get_population(const CityMap& map, std::string key) {
   return std::nullopt;
 }
 
+// The same lookup in a FlatHashMap (see flat_hash_map.h), which stores its
+// elements in one flat array instead of a heap-allocated node per element, and
+// can be searched with a std::string_view (no std::string is built just to look
+// a city up).
+using FlatCityMap = FlatHashMap<std::string, CityRecord>;
+std::optional<uint64_t> get_population(const FlatCityMap& map,
+  std::string_view key) {
+  if (const auto it = map.find(key); it != map.end()) {
+    return (it->second).population;
+  }
+  return std::nullopt;
+}
+
 int main() {
   // Create an unordered map (dictionary)
   std::unordered_map<std::string, CityRecord> cities;
@@ -145,4 +128,14 @@ int main() {
     std::cout << record.name << "\n\tpopulation: " << record.population << 
       std::endl;
   }
+
+  // A FlatHashMap has the same basic API as an unordered map.
+  FlatCityMap flat_cities;
+  for (auto& [name, record] : cities) {
+    flat_cities[name] = record;
+  }
+  flat_cities.erase("Boulder");
+  std::cout << "\nFlat map with " << flat_cities.size() << " cities, " <<
+    "Berlin population: " << get_population(flat_cities, "Berlin").value() <<
+    std::endl;
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
  * Video #44: Copying and Copy Constructors
  */
 
+#include "shared_string.h"
 #include "types.h"
 
 #include <iostream>
@@ -18,5 +19,15 @@ int main() {
   str2[2] = 'a';
   std::cout << "Copied and Modifed string: '" << str2  << "'" << std::endl;
 
+  // A SharedString doesn't copy its characters at all: both copies point to
+  // the same buffer until one of them is modified ("copy-on-write").
+  SharedString shared = "Cherno";
+  SharedString shared2 = shared;
+  std::cout << "\nSharedString copies: " << shared.use_count() <<
+    " strings share '" << shared << "'" << std::endl;
+  shared2[2] = 'a';
+  std::cout << "Modified copy: '" << shared2 << "', original: '" << shared <<
+    "' (" << shared.use_count() << " string uses it now)" << std::endl;
+
   std::cin.get();
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
  * Video #62: Threading
  */
 
+#include "stop_token.h"
 #include "utils.h"
 
 #include <iostream>
@@ -9,26 +10,34 @@
 
 using namespace std::literals::chrono_literals;
 
-static bool s_finished = false;
+// NOTE: The original version of this example polled a plain 'static bool
+// s_finished' between 1 second sleeps. Reading a non-atomic variable that
+// another thread writes is a data race (undefined behavior: the compiler may
+// hoist the read out of the loop entirely), and the worker took up to a full
+// second to notice that it should stop. A StopToken (see stop_token.h) fixes
+// both: its flag is atomic, and its sleep_for() returns as soon as a stop is
+// requested.
 
-void do_work() {
+void do_work(StopToken token) {
   // Use the Timer to record how long this function took to execute.
   Timer timer;
 
-  // A function that will do some work...
-  while (!s_finished) {
+  // A function that will do some work... sleep_for() returns false once a stop
+  // has been requested.
+  do {
     std::cout << "Working..." << std::endl;
-    std::this_thread::sleep_for(1s);
-  }
+  } while (token.sleep_for(1s));
 }
 
 int main() {
   // Kick off a worker thread that will call the do_work() fcn.
-  std::thread worker(do_work);
+  StopSource stop;
+  std::thread worker(do_work, stop.get_token());
 
-  // Once the user pressed 'Enter', set the static "finished" var to true
+  // Once the user pressed 'Enter', ask the worker to stop. It wakes up
+  // immediately, even if it's in the middle of sleeping.
   std::cin.get();
-  s_finished = true;
+  stop.request_stop();
 
   // Block execution of the current thread (main) until the worker thread has
   // completed.
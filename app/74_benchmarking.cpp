@@ -1,67 +1,68 @@
 /*
  * Video #74: Benchmarking
- * 
- * NOTE: Build this code in Release mode and not Debug to get a better 
+ *
+ * NOTE: Build this code in Release mode and not Debug to get a better
  * understanding of true performance.
- * 
- * We expect std::make_shared to be faster than std::shared_ptr because 
- * std::make_shared performs one heap-allocation, whereas calling the 
+ *
+ * We expect std::make_shared to be faster than std::shared_ptr because
+ * std::make_shared performs one heap-allocation, whereas calling the
  * std::shared_ptr constructor performs two. See the link below for further
  * discussion:
- * 
+ *
  * https://stackoverflow.com/questions/20895648/difference-in-make-shared-and-normal-shared-ptr-in-c
+ *
+ * The video times a single run of each loop with the scope-based Timer from
+ * utils.h. That's a fine first look, but a single run includes cold caches
+ * and page faults, and says nothing about how noisy the result is. Worse, the
+ * optimizer is free to fold the 'value += 2' loop into a single addition. So
+ * these benchmarks run on the harness in benchmark.h instead, which warms up,
+ * repeats every benchmark and reports the median and its spread. Run with
+ * --help (or any unknown flag) to see the options, e.g. --format=csv.
  */
 
-#include "utils.h"
+#include "benchmark.h"
 #include "types.h"
 
-#include <array>
-#include <iostream>
 #include <memory>
 
-int main() {
-  int value = 0;
-  std::cout << "For loop addition:" << std::endl;
-  {
-    // Use a scope-based timer for benchmarking a simple for loop.
-    Timer timer;
+// The loop from the video. Without do_not_optimize(), the compiler would just
+// compute the final value and skip the loop entirely.
+static void for_loop_addition(bench::State& state) {
+  while (state.keep_running()) {
+    int value = 0;
     int upper = 1'000'000;
     for (int i = 0; i < upper; i++) {
       value += 2;
+      bench::do_not_optimize(value);
     }
   }
-  std::cout << "value: " << value << std::endl;
+}
+BENCHMARK(for_loop_addition);
 
-  // Benchmark the performance of 'make_shared' vs. 'shared_ptr' vs.
-  // 'make_unique'
-  const size_t n_vectors = 100'000;
-  std::cout << "\nstd::make_shared<>():" << std::endl;
-  {
-    std::array<std::shared_ptr<Vec2>, n_vectors> shared;
-    Timer timer;
-    for (int i = 0; i < shared.size(); i++) {
-      shared[i] = std::make_shared<Vec2>(0.0f, 0.0f);
-    }
+// Benchmark the performance of 'make_shared' vs. 'shared_ptr' vs.
+// 'make_unique'. Each iteration creates (and destroys) a single pointer.
+static void make_shared(bench::State& state) {
+  while (state.keep_running()) {
+    std::shared_ptr<Vec2> shared = std::make_shared<Vec2>(0.0f, 0.0f);
+    bench::do_not_optimize(shared);
   }
+}
+BENCHMARK(make_shared);
 
-  // std::shared_ptr
-  std::cout << "\nstd::shared_ptr<>():" << std::endl;
-  {
-    std::array<std::shared_ptr<Vec2>, n_vectors> shared;
-    Timer timer;
-    for (int i = 0; i < shared.size(); i++) {
-      shared[i] = std::shared_ptr<Vec2>(new Vec2(0.0f, 0.0f));
-    }
+static void shared_ptr_new(bench::State& state) {
+  while (state.keep_running()) {
+    std::shared_ptr<Vec2> shared = std::shared_ptr<Vec2>(new Vec2(0.0f, 0.0f));
+    bench::do_not_optimize(shared);
   }
+}
+BENCHMARK(shared_ptr_new);
 
-  // std::make_unique
-  std::cout << "\nstd::make_unique<>():" << std::endl;
-  {
-    std::array<std::unique_ptr<Vec2>, n_vectors> unique;
-    Timer timer;
-    for (int i = 0; i < unique.size(); i++) {
-      unique[i] = std::make_unique<Vec2>(0.0f, 0.0f);
-    }
+static void make_unique(bench::State& state) {
+  while (state.keep_running()) {
+    std::unique_ptr<Vec2> unique = std::make_unique<Vec2>(0.0f, 0.0f);
+    bench::do_not_optimize(unique);
   }
-  
-}
\ No newline at end of file
+}
+BENCHMARK(make_unique);
+
+BENCHMARK_MAIN();
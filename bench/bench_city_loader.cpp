@@ -0,0 +1,163 @@
+/*
+ * Benchmark: loading a CSV file of cities (see city_loader.h).
+ *
+ * Compares:
+ * - a naive loader: std::getline() per row, std::stoull()/std::stod() per
+ *   number, push_back() into a vector,
+ * - load_cities_csv() on the calling thread only, and
+ * - load_cities_csv() on ThreadPools of 1, 2, 4, ... up to N workers (plus the
+ *   calling thread), where N is the number of hardware threads,
+ * and reports MB/s and rows/s for each. Then times building a map from the
+ * loaded cities: std::unordered_map (one insert at a time) vs.
+ * build_city_map() (a single, pre-sized FlatHashMap).
+ *
+ * If 'path' doesn't exist, it's generated first with 'n_rows' rows (see
+ * tools/generate_cities_csv.cpp). Every loader must agree on the cities, or we
+ * exit with 1.
+ *
+ * NOTE: Build this code in Release mode. The file is read once before timing
+ * anything, so that every loader starts with it in the page cache.
+ *
+ * usage: bench_city_loader [path] [n_rows]
+ */
+
+#include "bench_util.h"
+#include "city_loader.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using bench_util::time_ms;
+
+// The obvious way to do it, for comparison.
+std::vector<CityRecord> load_naive(const std::string& path) {
+  std::ifstream file(path);
+  std::vector<CityRecord> cities;
+  std::string line;
+  std::getline(file, line);  // The header.
+  while (std::getline(file, line)) {
+    // Quoted names contain a comma, so split from the right.
+    size_t lon = line.rfind(',');
+    size_t lat = line.rfind(',', lon - 1);
+    size_t population = line.rfind(',', lat - 1);
+    std::string name = line.substr(0, population);
+    if (name.size() >= 2 && name.front() == '"') {
+      name = name.substr(1, name.size() - 2);
+    }
+    cities.push_back({name,
+      std::stoull(line.substr(population + 1, lat - population - 1)),
+      std::stod(line.substr(lat + 1, lon - lat - 1)),
+      std::stod(line.substr(lon + 1))});
+  }
+  return cities;
+}
+
+bool same_cities(const std::vector<CityRecord>& lhs,
+  const std::vector<CityRecord>& rhs) {
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+    [](const CityRecord& a, const CityRecord& b) {
+      return a.name == b.name && a.population == b.population &&
+        a.latitude == b.latitude && a.longitude == b.longitude;
+    });
+}
+
+void print_row(const std::string& name, double ms, size_t bytes,
+  size_t rows) {
+  std::cout << "  " << std::left << std::setw(30) << name << std::right <<
+    std::fixed << std::setprecision(1) << std::setw(10) << ms << " ms" <<
+    std::setw(10) << bytes / 1e3 / ms << " MB/s" << std::setw(10) <<
+    rows / 1e3 / ms << " Mrows/s" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  std::string path = argc > 1 ? argv[1] : "data/cities.csv";
+  size_t n_rows = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1'000'000;
+
+  if (!std::filesystem::exists(path)) {
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+      std::filesystem::create_directories(parent);
+    }
+    std::ofstream file(path, std::ios::binary);
+    city_csv::write_synthetic(file, n_rows);
+    std::cout << "Generated " << n_rows << " cities in '" << path << "'." <<
+      std::endl;
+  }
+
+  size_t bytes = 0;
+  {
+    // Warm the page cache.
+    MappedFile file(path);
+    bytes = file.size();
+    volatile size_t n_lines =
+      std::count(file.data(), file.data() + file.size(), '\n');
+    (void)n_lines;
+  }
+
+  std::vector<CityRecord> expected;
+  double naive_ms = time_ms([&]() { expected = load_naive(path); });
+  std::cout << path << ": " << bytes / 1e6 << " MB, " << expected.size() <<
+    " rows" << std::endl;
+  print_row("getline + stod (naive)", naive_ms, bytes, expected.size());
+
+  bool ok = true;
+  std::vector<CityRecord> cities;
+  double serial_ms = time_ms([&]() { cities = load_cities_csv(path); });
+  print_row("load_cities_csv (serial)", serial_ms, bytes, cities.size());
+  ok = ok && same_cities(cities, expected);
+
+  size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+  for (size_t n_threads = 1; ; n_threads = std::min(n_threads * 2,
+       max_threads)) {
+    ThreadPool pool(n_threads);
+    // Don't time freeing the previous result.
+    cities = std::vector<CityRecord>();
+    double parallel_ms = time_ms([&]() {
+      cities = load_cities_csv(path, pool);
+    });
+    print_row("load_cities_csv (" + std::to_string(n_threads) + " workers)",
+      parallel_ms, bytes, cities.size());
+    ok = ok && same_cities(cities, expected);
+    if (n_threads == max_threads) {
+      break;
+    }
+  }
+
+  std::cout << "building a map of " << cities.size() << " cities" <<
+    std::endl;
+  // (Destroying the maps isn't part of the timing.)
+  std::vector<CityRecord> copy = cities;
+  std::unordered_map<std::string, CityRecord> std_map;
+  double std_ms = time_ms([&]() {
+    for (CityRecord& city : copy) {
+      std_map.emplace(city.name, std::move(city));
+    }
+  });
+  print_row("std::unordered_map", std_ms, bytes, cities.size());
+
+  FlatHashMap<std::string, CityRecord> flat_map;
+  double flat_ms = time_ms([&]() {
+    flat_map = build_city_map(std::move(cities));
+  });
+  print_row("build_city_map (FlatHashMap)", flat_ms, bytes, expected.size());
+  ok = ok && std_map.size() == expected.size() &&
+    flat_map.size() == expected.size();
+
+  if (!ok) {
+    std::cerr << "The loaders disagree!" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,162 @@
+/*
+ * Benchmark: FlatHashMap vs. std::unordered_map, both mapping city names to
+ * CityRecords (see app/100_maps.cpp).
+ *
+ * For 10^3 up to 'max_elements' cities, the time per operation of:
+ * - insert: adding every city to an empty map (no reserve()),
+ * - hit: looking up every city, in random order,
+ * - miss: looking up as many names that aren't in the map,
+ * - erase: removing every city, in random order.
+ * FlatHashMap's lookups use std::string_view keys. Small sizes are repeated and
+ * the fastest run is reported. Exits with 1 if either map gives a wrong answer.
+ *
+ * NOTE: Build this code in Release mode. 10^7 cities need ~4 GB of memory, so
+ * the default stops at 10^6.
+ *
+ * usage: bench_flat_hash_map [max_elements]
+ */
+
+#include "bench_util.h"
+#include "city.h"
+#include "flat_hash_map.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using bench_util::ns_per_item;
+
+// Nanoseconds per operation for each benchmark.
+struct Timings
+{
+  double insert;
+  double hit;
+  double miss;
+  double erase;
+};
+
+/**
+ * @brief Runs every benchmark on a Map. 'lookup' converts a std::string to the
+ * key type used for lookups. Sets 'ok' to false on a wrong answer.
+ */
+template<typename Map, typename Lookup>
+Timings run(const std::vector<CityRecord>& cities,
+  const std::vector<std::string>& hits, const std::vector<std::string>& misses,
+  Lookup lookup, bool& ok) {
+  // Every benchmark changes the map (or depends on the previous one having
+  // done so), so each one only runs once here.
+  Timings timings;
+  Map map;
+  timings.insert = ns_per_item(cities.size(), 1, [&]() {
+    for (const CityRecord& city : cities) {
+      map[city.name] = city;
+    }
+  });
+
+  uint64_t population = 0;
+  timings.hit = ns_per_item(hits.size(), 1, [&]() {
+    for (const std::string& name : hits) {
+      auto it = map.find(lookup(name));
+      if (it != map.end()) {
+        population += it->second.population;
+      }
+    }
+  });
+
+  size_t n_found = 0;
+  timings.miss = ns_per_item(misses.size(), 1, [&]() {
+    for (const std::string& name : misses) {
+      n_found += map.find(lookup(name)) != map.end();
+    }
+  });
+
+  size_t n_erased = 0;
+  timings.erase = ns_per_item(hits.size(), 1, [&]() {
+    for (const std::string& name : hits) {
+      n_erased += map.erase(lookup(name));
+    }
+  });
+
+  // Populations are 1, 2, ..., n.
+  uint64_t n = cities.size();
+  if (population != n * (n + 1) / 2 || n_found != 0 || n_erased != n ||
+      !map.empty()) {
+    std::cerr << "wrong result for n = " << n << std::endl;
+    ok = false;
+  }
+  return timings;
+}
+
+// Keep the fastest of each timing in 'best'.
+void fastest(Timings& best, const Timings& timings) {
+  best.insert = std::min(best.insert, timings.insert);
+  best.hit = std::min(best.hit, timings.hit);
+  best.miss = std::min(best.miss, timings.miss);
+  best.erase = std::min(best.erase, timings.erase);
+}
+
+int main(int argc, char** argv) {
+  size_t max_n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+
+  std::cout << std::setw(10) << "n" << std::setw(10) << "map" <<
+    std::setw(12) << "insert" << std::setw(12) << "hit" << std::setw(12) <<
+    "miss" << std::setw(12) << "erase" << "   (ns per op)" << std::endl;
+
+  bool ok = true;
+  std::mt19937 rng(42);
+  for (size_t n = 1'000; n <= max_n; n *= 10) {
+    std::vector<CityRecord> cities(n);
+    std::vector<std::string> hits(n);
+    std::vector<std::string> misses(n);
+    for (size_t idx = 0; idx < n; idx++) {
+      cities[idx] = {"City" + std::to_string(idx), idx + 1, 0.0, 0.0};
+      hits[idx] = cities[idx].name;
+      misses[idx] = "Town" + std::to_string(idx);
+    }
+    std::shuffle(hits.begin(), hits.end(), rng);
+    std::shuffle(misses.begin(), misses.end(), rng);
+
+    auto as_string = [](const std::string& name) -> const std::string& {
+      return name;
+    };
+    auto as_view = [](const std::string& name) {
+      return std::string_view(name);
+    };
+    // Small maps run in microseconds, so repeat them (at least 10^6 ops in
+    // total) and keep the fastest run of each.
+    Timings std_map =
+      run<std::unordered_map<std::string, CityRecord>>(cities, hits, misses,
+        as_string, ok);
+    Timings flat_map = run<FlatHashMap<std::string, CityRecord>>(cities, hits,
+      misses, as_view, ok);
+    for (size_t rep = 1; rep < 1'000'000 / n; rep++) {
+      fastest(std_map, run<std::unordered_map<std::string, CityRecord>>(
+        cities, hits, misses, as_string, ok));
+      fastest(flat_map, run<FlatHashMap<std::string, CityRecord>>(cities,
+        hits, misses, as_view, ok));
+    }
+
+    auto print = [n](const char* name, const Timings& timings) {
+      std::cout << std::setw(10) << n << std::setw(10) << name << std::fixed <<
+        std::setprecision(1) << std::setw(12) << timings.insert <<
+        std::setw(12) << timings.hit << std::setw(12) << timings.miss <<
+        std::setw(12) << timings.erase << std::endl;
+    };
+    print("std", std_map);
+    print("flat", flat_map);
+    std::cout << std::setw(10) << "" << std::setw(10) << "speedup" <<
+      std::setprecision(2) <<
+      std::setw(11) << std_map.insert / flat_map.insert << "x" <<
+      std::setw(11) << std_map.hit / flat_map.hit << "x" <<
+      std::setw(11) << std_map.miss / flat_map.miss << "x" <<
+      std::setw(11) << std_map.erase / flat_map.erase << "x" << std::endl;
+  }
+  return ok ? 0 : 1;
+}
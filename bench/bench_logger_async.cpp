@@ -0,0 +1,137 @@
+/*
+ * Benchmark: per-call latency of Logger::info() from 1 to 16 threads, writing
+ * synchronously to std::cout vs. handing off to an AsyncLogBackend under each
+ * overflow policy. Everything is written to /dev/null so that we measure the
+ * logging path rather than the terminal.
+ *
+ * NOTE: Build this code in Release mode.
+ *
+ * usage: bench_logger_async [messages_per_thread]
+ */
+
+#include "async_log.h"
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  // Log from 'n_threads' threads at once and return every call's latency.
+  std::vector<uint64_t> run_producers(Logger& logger, size_t n_threads,
+    size_t n_messages) {
+    std::vector<std::vector<uint64_t>> latencies(n_threads);
+    std::vector<std::thread> threads;
+    for (size_t thread = 0; thread < n_threads; thread++) {
+      threads.emplace_back([&logger, &latencies, thread, n_messages]() {
+        std::vector<uint64_t>& mine = latencies[thread];
+        mine.reserve(n_messages);
+        std::string message = "thread " + std::to_string(thread) +
+          " says howdy from the benchmark";
+        for (size_t idx = 0; idx < n_messages; idx++) {
+          auto start = std::chrono::steady_clock::now();
+          logger.info(message.c_str());
+          auto end = std::chrono::steady_clock::now();
+          mine.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            end - start).count());
+        }
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    std::vector<uint64_t> all;
+    for (const std::vector<uint64_t>& mine : latencies) {
+      all.insert(all.end(), mine.begin(), mine.end());
+    }
+    std::sort(all.begin(), all.end());
+    return all;
+  }
+
+  uint64_t percentile(const std::vector<uint64_t>& sorted, double p) {
+    size_t idx = static_cast<size_t>(p * (sorted.size() - 1));
+    return sorted[idx];
+  }
+
+  void report(const char* name, size_t n_threads,
+    const std::vector<uint64_t>& sorted, uint64_t dropped) {
+    std::cout << std::left << std::setw(18) << name << std::right <<
+      std::setw(8) << n_threads <<
+      std::setw(10) << percentile(sorted, 0.50) <<
+      std::setw(10) << percentile(sorted, 0.90) <<
+      std::setw(10) << percentile(sorted, 0.99) <<
+      std::setw(10) << percentile(sorted, 0.999) <<
+      std::setw(12) << sorted.back() <<
+      std::setw(12) << dropped << std::endl;
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t n_messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20'000;
+
+  // The Logger prints to std::cout when it's created and destroyed (and on
+  // every call when synchronous), so point std::cout at /dev/null while a
+  // Logger is alive and swap the original buffer back in to print results.
+  std::ofstream dev_null("/dev/null");
+  // The writer thread gets its own stream, sharing one with std::cout would be
+  // a data race.
+  std::ofstream async_sink("/dev/null");
+  std::streambuf* cout_buffer = std::cout.rdbuf();
+
+  std::cout << "latencies in ns" << std::endl;
+  std::cout << std::left << std::setw(18) << "backend" << std::right <<
+    std::setw(8) << "threads" << std::setw(10) << "p50" <<
+    std::setw(10) << "p90" << std::setw(10) << "p99" <<
+    std::setw(10) << "p99.9" << std::setw(12) << "max" <<
+    std::setw(12) << "dropped" << std::endl;
+
+  const AsyncLogBackend::OverflowPolicy policies[] = {
+    AsyncLogBackend::BLOCK, AsyncLogBackend::DROP,
+    AsyncLogBackend::OVERWRITE_OLDEST };
+  const char* policy_names[] = {
+    "async (block)", "async (drop)", "async (overwrite)" };
+
+  for (size_t n_threads = 1; n_threads <= 16; n_threads *= 2) {
+    // Synchronous: every call formats, writes and flushes std::cout.
+    {
+      std::cout.rdbuf(dev_null.rdbuf());
+      std::vector<uint64_t> sorted;
+      {
+        Logger logger(Logger::INFO);
+        sorted = run_producers(logger, n_threads, n_messages);
+      }
+      std::cout.rdbuf(cout_buffer);
+      report("sync (cout)", n_threads, sorted, 0);
+    }
+
+    for (size_t policy = 0; policy < 3; policy++) {
+      AsyncLogBackend::Options options;
+      options.overflow_policy = policies[policy];
+      std::vector<uint64_t> sorted;
+      uint64_t dropped = 0;
+
+      std::cout.rdbuf(dev_null.rdbuf());
+      {
+        AsyncLogBackend backend(async_sink, options);
+        Logger logger(Logger::INFO);
+        logger.set_async_backend(&backend);
+        sorted = run_producers(logger, n_threads, n_messages);
+        backend.flush();
+        dropped = backend.dropped();
+      }
+      std::cout.rdbuf(cout_buffer);
+      report(policy_names[policy], n_threads, sorted, dropped);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,192 @@
+/*
+ * Benchmark: the cost per message (and the bytes written per message) of the
+ * Logger's text output vs. binary logging (see binary_log.h), for messages
+ * with 0 to 6 numeric arguments. Output goes to a stream that only counts the
+ * bytes, so we measure formatting and encoding rather than the disk.
+ *
+ * If a file name is given, a sample binary log is also written to it so that
+ * the decoder has something to chew on:
+ *
+ *   ./bench_logger_binary 1000000 sample.binlog
+ *   ./binary_log_decode sample.binlog
+ *
+ * NOTE: Build this code in Release mode.
+ *
+ * usage: bench_logger_binary [messages] [sample.binlog]
+ */
+
+#include "binary_log.h"
+#include "log.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace
+{
+  // A stream buffer that throws everything away, but counts the bytes.
+  class CountingBuffer : public std::streambuf
+  {
+    public:
+      size_t count() const { return count_; }
+      void reset() { count_ = 0; }
+
+    protected:
+      std::streamsize xsputn(const char*, std::streamsize n) override {
+        count_ += n;
+        return n;
+      }
+      int overflow(int c) override {
+        count_++;
+        return c;
+      }
+
+    private:
+      size_t count_{0};
+  };
+
+  struct Result
+  {
+    double ns_per_message;
+    double bytes_per_message;
+  };
+
+  template<typename Fn>
+  Result measure(CountingBuffer& buffer, size_t n_messages, Fn log_one) {
+    buffer.reset();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t idx = 0; idx < n_messages; idx++) {
+      log_one(idx);
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+    return { elapsed.count() / n_messages,
+      static_cast<double>(buffer.count()) / n_messages };
+  }
+
+  /**
+   * @brief Log 'n_messages' messages with the given (integer and floating
+   * point) arguments, as text formatted by snprintf (the way callers have to
+   * today, since Logger only takes a const char*) and in binary.
+   */
+  template<typename... Args>
+  void run(size_t n_messages, const char* text_format,
+    const char* binary_format, Args... args) {
+    CountingBuffer text_buffer;
+    std::streambuf* cout_buffer = std::cout.rdbuf(&text_buffer);
+    Result text;
+    Result binary;
+    {
+      Logger logger(Logger::INFO);
+      text = measure(text_buffer, n_messages, [&](size_t idx) {
+        char message[256];
+        std::snprintf(message, sizeof(message), text_format, idx, args...);
+        logger.info(message);
+      });
+
+      CountingBuffer binary_buffer;
+      std::ostream binary_out(&binary_buffer);
+      BinaryLogWriter writer(binary_out);
+      logger.set_binary_writer(&writer);
+      binary = measure(binary_buffer, n_messages, [&](size_t idx) {
+        LOG_BINARY(logger, Logger::INFO, binary_format, idx, args...);
+      });
+      writer.flush();
+      binary.bytes_per_message =
+        static_cast<double>(binary_buffer.count()) / n_messages;
+    }
+    std::cout.rdbuf(cout_buffer);
+
+    std::cout << std::setw(6) << sizeof...(Args) + 1 << std::fixed <<
+      std::setprecision(1) <<
+      std::setw(14) << text.ns_per_message <<
+      std::setw(14) << binary.ns_per_message <<
+      std::setw(14) << text.bytes_per_message <<
+      std::setw(14) << binary.bytes_per_message << std::endl;
+  }
+
+  // Every format has the message index as its first argument, so the
+  // "0 argument" row is a message with no arguments at all.
+  void run_no_args(size_t n_messages) {
+    CountingBuffer text_buffer;
+    std::streambuf* cout_buffer = std::cout.rdbuf(&text_buffer);
+    Result text;
+    Result binary;
+    {
+      Logger logger(Logger::INFO);
+      text = measure(text_buffer, n_messages, [&](size_t) {
+        logger.info("cache flushed");
+      });
+
+      CountingBuffer binary_buffer;
+      std::ostream binary_out(&binary_buffer);
+      BinaryLogWriter writer(binary_out);
+      logger.set_binary_writer(&writer);
+      binary = measure(binary_buffer, n_messages, [&](size_t) {
+        LOG_BINARY(logger, Logger::INFO, "cache flushed");
+      });
+      writer.flush();
+      binary.bytes_per_message =
+        static_cast<double>(binary_buffer.count()) / n_messages;
+    }
+    std::cout.rdbuf(cout_buffer);
+
+    std::cout << std::setw(6) << 0 << std::fixed << std::setprecision(1) <<
+      std::setw(14) << text.ns_per_message <<
+      std::setw(14) << binary.ns_per_message <<
+      std::setw(14) << text.bytes_per_message <<
+      std::setw(14) << binary.bytes_per_message << std::endl;
+  }
+
+  void write_sample(const char* path, size_t n_messages) {
+    std::ofstream file(path, std::ios::binary);
+    BinaryLogWriter writer(file);
+    std::streambuf* cout_buffer = std::cout.rdbuf(nullptr);
+    {
+      Logger logger(Logger::INFO);
+      logger.set_binary_writer(&writer);
+      for (size_t idx = 0; idx < n_messages; idx++) {
+        LOG_BINARY(logger, Logger::INFO, "record {} has population {}", idx,
+          static_cast<int>(idx * 37 % 100'000));
+        if (idx % 1000 == 0) {
+          LOG_BINARY(logger, Logger::WARNING, "checkpoint {} at {} percent",
+            idx, 100.0 * idx / n_messages);
+        }
+      }
+    }
+    std::cout.rdbuf(cout_buffer);
+    std::cout << "Wrote a sample binary log to '" << path << "'." << std::endl;
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t n_messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+
+  std::cout << std::setw(6) << "args" << std::setw(14) << "text ns" <<
+    std::setw(14) << "binary ns" << std::setw(14) << "text B" <<
+    std::setw(14) << "binary B" << std::endl;
+
+  run_no_args(n_messages);
+  run(n_messages, "request %zu done", "request {} done");
+  run(n_messages, "request %zu took %f ms", "request {} took {} ms", 12.5);
+  run(n_messages, "request %zu took %f ms, status %d",
+    "request {} took {} ms, status {}", 12.5, 200);
+  run(n_messages, "request %zu took %f ms, status %d, %ld bytes",
+    "request {} took {} ms, status {}, {} bytes", 12.5, 200, 4096L);
+  run(n_messages, "request %zu took %f ms, status %d, %ld bytes, retry %d",
+    "request {} took {} ms, status {}, {} bytes, retry {}", 12.5, 200, 4096L,
+    3);
+  run(n_messages,
+    "request %zu took %f ms, status %d, %ld bytes, retry %d, load %f",
+    "request {} took {} ms, status {}, {} bytes, retry {}, load {}", 12.5, 200,
+    4096L, 3, 0.75);
+
+  if (argc > 2) {
+    write_sample(argv[2], n_messages);
+  }
+  return 0;
+}
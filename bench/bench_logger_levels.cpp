@@ -0,0 +1,56 @@
+/*
+ * Benchmark: the cost of info() calls that are filtered out, when the message
+ * is built up front (eager) vs. only on demand (lazy, via LOG_INFO).
+ *
+ * Configure with -DLOG_COMPILE_LEVEL=WARNING to compile info() out entirely.
+ * The eager row still pays for building the message, because that happens
+ * before info() is even called, which is why LOG_INFO exists.
+ *
+ * NOTE: Build this code in Release mode.
+ *
+ * usage: bench_logger_levels [calls]
+ */
+
+#include "log.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+  size_t n_calls = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+
+  // INFO is filtered at runtime (if it wasn't already compiled out).
+  Logger logger(Logger::WARNING);
+  std::cout << "compiled level: " << Logger::kCompiledLevel <<
+    ", runtime level: WARNING" << std::endl;
+
+  {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t idx = 0; idx < n_calls; idx++) {
+      std::string message = "processed record " + std::to_string(idx);
+      logger.info(message.c_str());
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+    std::cout << std::left << std::setw(10) << "eager" << std::right <<
+      std::setw(10) << std::fixed << std::setprecision(2) <<
+      elapsed.count() / n_calls << " ns/call" << std::endl;
+  }
+
+  {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t idx = 0; idx < n_calls; idx++) {
+      LOG_INFO(logger, "processed record " + std::to_string(idx));
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+    std::cout << std::left << std::setw(10) << "lazy" << std::right <<
+      std::setw(10) << std::fixed << std::setprecision(2) <<
+      elapsed.count() / n_calls << " ns/call" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,113 @@
+/*
+ * Benchmark: the overhead of a PROFILE_SCOPE, measured as the difference
+ * between a loop of small work items with and without a scope around each one.
+ * Then profiles a few nested scopes on several threads and prints the
+ * aggregated summary. If a file name is given, the Chrome trace is written to
+ * it.
+ *
+ * Configure with -DPROFILING=OFF to check that the scopes compile out.
+ *
+ * NOTE: Build this code in Release mode.
+ *
+ * usage: bench_profiler [iterations] [trace.json]
+ */
+
+#include "profiler.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+static volatile uint64_t s_sink = 0;
+
+namespace
+{
+  // A few nanoseconds of work that the compiler can't throw away.
+  inline void work(uint64_t idx) {
+    s_sink = s_sink + idx * 2654435761u;
+  }
+
+  double ns_per_iteration(size_t n_iterations, bool profiled) {
+    auto start = std::chrono::steady_clock::now();
+    if (profiled) {
+      for (size_t idx = 0; idx < n_iterations; idx++) {
+        PROFILE_SCOPE("work");
+        work(idx);
+      }
+    }
+    else {
+      for (size_t idx = 0; idx < n_iterations; idx++) {
+        work(idx);
+      }
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+    return elapsed.count() / n_iterations;
+  }
+
+  void parse_row(size_t row) {
+    PROFILE_FUNCTION();
+    for (size_t idx = 0; idx < 200; idx++) {
+      work(row + idx);
+    }
+  }
+
+  void load_batch(size_t batch) {
+    PROFILE_FUNCTION();
+    for (size_t row = 0; row < 100; row++) {
+      parse_row(batch * 100 + row);
+    }
+    {
+      PROFILE_SCOPE("index_batch");
+      for (size_t idx = 0; idx < 5000; idx++) {
+        work(idx);
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t n_iterations = argc > 1 ?
+    std::strtoull(argv[1], nullptr, 10) : 5'000'000;
+
+  std::cout << "PROFILING_ENABLED: " << PROFILING_ENABLED << std::endl;
+
+  // Warm up (and let the profiler register this thread) before measuring.
+  ns_per_iteration(n_iterations / 10, true);
+  Profiler::get().reset();
+
+  double bare = ns_per_iteration(n_iterations, false);
+  double profiled = ns_per_iteration(n_iterations, true);
+  std::cout << "without scope: " << bare << " ns/iteration" << std::endl;
+  std::cout << "with scope:    " << profiled << " ns/iteration" << std::endl;
+  std::cout << "overhead:      " << profiled - bare << " ns/scope" << std::endl;
+  Profiler::get().reset();
+
+  // Nested scopes on several threads.
+  std::vector<std::thread> threads;
+  for (size_t thread = 0; thread < 4; thread++) {
+    threads.emplace_back([thread]() {
+      PROFILE_SCOPE("worker");
+      for (size_t batch = 0; batch < 25; batch++) {
+        load_batch(thread * 25 + batch);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  std::cout << std::endl;
+  Profiler::get().print_summary(std::cout);
+
+  if (argc > 2) {
+    std::ofstream trace(argv[2]);
+    Profiler::get().write_chrome_trace(trace);
+    std::cout << "\nWrote the trace to '" << argv[2] << "'." << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,160 @@
+/*
+ * Benchmark: copying SharedStrings vs. deep-copying Strings (types.h) vs.
+ * std::strings.
+ *
+ * A "pipeline" of 'n_stages' stages, each of which keeps its own copy of
+ * 'n_strings' strings (of 16, 256 and 4096 characters), like a pipeline that
+ * passes the same strings from stage to stage without changing them. Reports
+ * the time per copy and the heap memory held by all the stages together. Then
+ * times taking a substring of every string (the middle half), and overwriting
+ * one character of every copy in the last stage (which makes SharedString
+ * unshare). Exits with 1 if any copy or substring has the wrong characters, or
+ * if a write shows up in another copy.
+ *
+ * NOTE: Build this code in Release mode. String logs every copy to std::cout,
+ * which would swamp everything else, so std::cout is silenced while String is
+ * timed.
+ *
+ * usage: bench_shared_string [n_strings] [n_stages]
+ */
+
+// Count every byte allocated on the heap, to measure memory use.
+#define BENCH_COUNT_ALLOCATIONS
+#include "bench_util.h"
+#include "shared_string.h"
+#include "types.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using bench_util::s_allocated_bytes;
+using bench_util::time_ns;
+using bench_util::view;
+
+std::string_view view(const SharedString& string) { return string; }
+
+// String has no substr(), so build a new one from the characters.
+String substring(const String& string, size_t pos, size_t count) {
+  return String(std::string(view(string).substr(pos, count)).c_str());
+}
+SharedString substring(const SharedString& string, size_t pos,
+  size_t count) {
+  return string.substr(pos, count);
+}
+std::string substring(const std::string& string, size_t pos, size_t count) {
+  return string.substr(pos, count);
+}
+
+// One row of the table.
+struct Result
+{
+  double ns_per_copy;
+  double copy_mb;
+  double ns_per_substr;
+  double ns_per_write;
+};
+
+/**
+ * @brief Runs the pipeline with string type T. Sets 'ok' to false if a string
+ * ends up with the wrong characters.
+ */
+template<typename T>
+Result run(const std::vector<std::string>& sources, size_t n_stages,
+  bool& ok) {
+  size_t n_strings = sources.size();
+  std::vector<std::vector<T>> stages(n_stages);
+  stages[0].reserve(n_strings);
+  for (const std::string& source : sources) {
+    stages[0].emplace_back(source.c_str());
+  }
+
+  // Every stage copies the previous stage's strings.
+  size_t bytes_before = s_allocated_bytes;
+  double copy_ns = time_ns([&]() {
+    for (size_t stage = 1; stage < n_stages; stage++) {
+      stages[stage].reserve(n_strings);
+      for (const T& string : stages[stage - 1]) {
+        stages[stage].push_back(string);
+      }
+    }
+  });
+  size_t copy_bytes = s_allocated_bytes - bytes_before;
+
+  size_t length = sources.front().size();
+  std::vector<T> substrings;
+  substrings.reserve(n_strings);
+  double substr_ns = time_ns([&]() {
+    for (const T& string : stages.back()) {
+      substrings.push_back(substring(string, length / 4, length / 2));
+    }
+  });
+
+  // Mutate the last stage: the first stage must not notice.
+  double write_ns = time_ns([&]() {
+    for (T& string : stages.back()) {
+      string[0] = '#';
+    }
+  });
+
+  for (size_t idx = 0; idx < n_strings; idx++) {
+    std::string_view source = sources[idx];
+    ok = ok && view(stages.front()[idx]) == source &&
+      view(stages[n_stages / 2][idx]) == source &&
+      view(stages.back()[idx]).substr(1) == source.substr(1) &&
+      view(stages.back()[idx])[0] == '#' &&
+      view(substrings[idx]) == source.substr(length / 4, length / 2);
+  }
+
+  size_t n_copies = n_strings * (n_stages - 1);
+  return {copy_ns / n_copies, copy_bytes / 1e6, substr_ns / n_strings,
+    write_ns / n_strings};
+}
+
+void print_row(size_t length, const char* name, const Result& result) {
+  std::cout << std::setw(8) << length << std::setw(14) << name << std::fixed <<
+    std::setprecision(1) << std::setw(12) << result.ns_per_copy <<
+    std::setw(12) << result.copy_mb << std::setw(12) <<
+    result.ns_per_substr << std::setw(12) << result.ns_per_write << std::endl;
+}
+
+int main(int argc, char** argv) {
+  size_t n_strings = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000;
+  size_t n_stages = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20;
+  n_stages = std::max<size_t>(n_stages, 2);
+
+  std::cout << n_strings << " strings, " << n_stages << " stages" <<
+    std::endl << std::setw(8) << "length" << std::setw(14) << "type" <<
+    std::setw(12) << "ns/copy" << std::setw(12) << "copies MB" <<
+    std::setw(12) << "ns/substr" << std::setw(12) << "ns/write" << std::endl;
+
+  bool ok = true;
+  for (size_t length : {16, 256, 4096}) {
+    std::vector<std::string> sources(n_strings);
+    for (size_t idx = 0; idx < n_strings; idx++) {
+      sources[idx] = std::string(length, 'a');
+      for (size_t pos = 0; pos < length; pos += 7) {
+        sources[idx][pos] = static_cast<char>('a' + (idx + pos) % 26);
+      }
+    }
+
+    Result string_result;
+    {
+      bench_util::SilenceCout silence;
+      string_result = run<String>(sources, n_stages, ok);
+    }
+    print_row(length, "String", string_result);
+    print_row(length, "SharedString", run<SharedString>(sources, n_stages, ok));
+    print_row(length, "std::string", run<std::string>(sources, n_stages, ok));
+  }
+
+  if (!ok) {
+    std::cerr << "A string has the wrong characters!" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,184 @@
+/*
+ * Benchmark: SmallString vs. String (types.h) vs. std::string.
+ *
+ * For strings of 8, 16, 32 and 256 characters, the time (and the number of
+ * heap allocations) per operation of:
+ * - construct: creating (and destroying) a string from a const char*,
+ * - copy: copy-constructing (and destroying) a string,
+ * - move: moving a string out and back again (a move construction plus a move
+ *   assignment),
+ * - compare: comparing two strings of the same size that only differ in their
+ *   last character.
+ * Up to 23 characters, SmallString never touches the heap. Exits with 1 if a
+ * string doesn't hold the characters it was created from.
+ *
+ * NOTE: Build this code in Release mode. String logs every operation to
+ * std::cout, which would swamp everything else, so std::cout is silenced
+ * while String is timed.
+ *
+ * usage: bench_small_string [n_rounds]
+ */
+
+// Count every heap allocation, so that we can report allocations per operation.
+#define BENCH_COUNT_ALLOCATIONS
+#include "bench_util.h"
+#include "small_string.h"
+#include "types.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Prevent the compiler from optimizing the whole workload away.
+static volatile size_t s_sink = 0;
+
+using bench_util::s_allocations;
+using bench_util::time_ns;
+using bench_util::view;
+
+std::string_view view(const SmallString& string) { return string; }
+
+// The time and heap allocations per operation.
+struct Cost
+{
+  double ns;
+  double allocations;
+};
+
+struct Costs
+{
+  Cost construct;
+  Cost copy;
+  Cost move;
+  Cost compare;
+};
+
+template<typename Function>
+Cost measure(size_t n_ops, Function function) {
+  size_t allocations = s_allocations;
+  double ns = time_ns(function);
+  return {ns / n_ops,
+    static_cast<double>(s_allocations - allocations) / n_ops};
+}
+
+/**
+ * @brief Times every operation on 'sources' (strings of the same length) with
+ * string type T. Sets 'ok' to false if a string doesn't match its source.
+ */
+template<typename T>
+Costs run(const std::vector<std::string>& sources, size_t n_rounds, bool& ok) {
+  size_t n_ops = sources.size() * n_rounds;
+  std::vector<T> strings;
+  strings.reserve(sources.size());
+  for (const std::string& source : sources) {
+    strings.emplace_back(source.c_str());
+    ok = ok && view(strings.back()) == source;
+  }
+
+  Cost construct = measure(n_ops, [&]() {
+    size_t total = 0;
+    for (size_t round = 0; round < n_rounds; round++) {
+      for (const std::string& source : sources) {
+        T string(source.c_str());
+        total += view(string).size();
+      }
+    }
+    s_sink = s_sink + total;
+  });
+
+  Cost copy = measure(n_ops, [&]() {
+    size_t total = 0;
+    for (size_t round = 0; round < n_rounds; round++) {
+      for (const T& string : strings) {
+        T copied(string);
+        total += view(copied).size();
+      }
+    }
+    s_sink = s_sink + total;
+  });
+
+  Cost move = measure(n_ops, [&]() {
+    size_t total = 0;
+    for (size_t round = 0; round < n_rounds; round++) {
+      for (T& string : strings) {
+        T moved(std::move(string));
+        total += view(moved).size();
+        string = std::move(moved);
+      }
+    }
+    s_sink = s_sink + total;
+  });
+
+  Cost compare = measure(n_ops, [&]() {
+    size_t n_equal = 0;
+    for (size_t round = 0; round < n_rounds; round++) {
+      for (size_t idx = 1; idx < strings.size(); idx++) {
+        n_equal += view(strings[idx - 1]) == view(strings[idx]);
+      }
+      n_equal += view(strings.back()) == view(strings.front());
+    }
+    s_sink = s_sink + n_equal;
+  });
+
+  // Everything must have survived being moved out and back.
+  for (size_t idx = 0; idx < sources.size(); idx++) {
+    ok = ok && view(strings[idx]) == sources[idx];
+  }
+
+  return {construct, copy, move, compare};
+}
+
+// One row per operation.
+void print_rows(size_t length, const char* name, const Costs& costs) {
+  for (auto [operation, cost] : {std::pair{"construct", costs.construct},
+       {"copy", costs.copy}, {"move", costs.move},
+       {"compare", costs.compare}}) {
+    std::cout << std::setw(8) << length << std::setw(14) << name <<
+      std::setw(11) << operation << std::fixed << std::setprecision(2) <<
+      std::setw(10) << cost.ns << std::setw(13) << cost.allocations <<
+      std::endl;
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t n_rounds = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000;
+  constexpr size_t kStringsPerSize = 1'000;
+
+  std::cout << std::setw(8) << "length" << std::setw(14) << "type" <<
+    std::setw(11) << "operation" << std::setw(10) << "ns/op" <<
+    std::setw(13) << "allocs/op" << std::endl;
+
+  bool ok = true;
+  for (size_t length : {8, 16, 32, 256}) {
+    // Strings that only differ in their last character(s), so that comparing
+    // two of them has to look at every character.
+    std::vector<std::string> sources;
+    for (size_t idx = 0; idx < kStringsPerSize; idx++) {
+      std::string source(length, 'a');
+      source[length - 1] = static_cast<char>('a' + idx % 26);
+      source[length - 2] = static_cast<char>('a' + idx / 26 % 26);
+      sources.push_back(source);
+    }
+
+    Costs string_costs;
+    {
+      bench_util::SilenceCout silence;
+      string_costs = run<String>(sources, n_rounds, ok);
+    }
+    print_rows(length, "String", string_costs);
+    print_rows(length, "SmallString", run<SmallString>(sources, n_rounds, ok));
+    print_rows(length, "std::string", run<std::string>(sources, n_rounds, ok));
+  }
+
+  if (!ok) {
+    std::cerr << "A string doesn't match the characters it was created from!"
+      << std::endl;
+    return 1;
+  }
+  return 0;
+}
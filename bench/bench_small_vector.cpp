@@ -0,0 +1,59 @@
+/*
+ * Benchmark: Vector<T> vs. SmallVector<T, 8> vs. std::vector<T> for lots of
+ * tiny, short-lived containers.
+ *
+ * Each round builds a container of 0..15 elements, sums it and throws it
+ * away. Up to 8 elements, SmallVector never touches the heap.
+ *
+ * NOTE: Build this code in Release mode and not Debug to get a better
+ * understanding of true performance.
+ *
+ * usage: bench_small_vector [n_rounds]
+ */
+
+#include "small_vector.h"
+#include "utils.h"
+#include "vector.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Prevent the compiler from optimizing the whole workload away.
+static volatile long long s_sink = 0;
+
+template<typename Container>
+void build_and_discard(size_t n_rounds, size_t max_elements) {
+  long long sum = 0;
+  for (size_t round = 0; round < n_rounds; round++) {
+    Container container;
+    size_t n_elements = round % max_elements;
+    for (size_t idx = 0; idx < n_elements; idx++) {
+      container.push_back(static_cast<int>(idx));
+    }
+    for (int value : container) {
+      sum += value;
+    }
+  }
+  s_sink = s_sink + sum;
+}
+
+template<typename Container>
+void run(const char* name, size_t n_rounds) {
+  // Containers of up to 8 elements (fits inline) and up to 16 elements (the
+  // SmallVector spills about half the time).
+  for (size_t max_elements : {8, 16}) {
+    std::cout << name << " (0.." << max_elements - 1 << " elements):" <<
+      std::endl;
+    Timer timer;
+    build_and_discard<Container>(n_rounds, max_elements);
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t n_rounds = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+
+  run<Vector<int>>("Vector<int>", n_rounds);
+  run<SmallVector<int, 8>>("SmallVector<int, 8>", n_rounds);
+  run<std::vector<int>>("std::vector<int>", n_rounds);
+}
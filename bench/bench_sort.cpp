@@ -0,0 +1,148 @@
+/*
+ * Benchmark: the algorithms in sort.h vs. std::sort.
+ *
+ * For 10^4 up to 'max_elements' random keys:
+ * - std::sort
+ * - radix_sort (single-threaded)
+ * - parallel_sort on a ThreadPool with 1, 2, 4, ... up to N workers, where N
+ *   is the number of hardware threads.
+ * for int, float and "records sorted by a member" (sort_by_key).
+ *
+ * NOTE: Build this code in Release mode. Sorting 10^8 keys needs a couple of
+ * GB of memory, so the default stops at 10^7.
+ *
+ * usage: bench_sort [max_elements]
+ */
+
+#include "sort.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A record that we sort by one of its members.
+struct Record
+{
+  uint64_t id;
+  float score;
+  uint32_t payload[2];
+};
+
+// A cheap, deterministic pseudo-random sequence (xorshift).
+uint32_t next_random(uint32_t& state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+std::vector<int> make_ints(size_t n) {
+  std::vector<int> values(n);
+  uint32_t state = 2463534242u;
+  for (int& value : values) {
+    value = static_cast<int>(next_random(state));
+  }
+  return values;
+}
+
+std::vector<float> make_floats(size_t n) {
+  std::vector<float> values(n);
+  uint32_t state = 2463534242u;
+  for (float& value : values) {
+    value = (static_cast<float>(next_random(state)) / 4294967296.0f - 0.5f) *
+      1e6f;
+  }
+  return values;
+}
+
+std::vector<Record> make_records(size_t n) {
+  std::vector<Record> records(n);
+  uint32_t state = 2463534242u;
+  for (size_t idx = 0; idx < n; idx++) {
+    records[idx] = {idx, static_cast<float>(next_random(state) % 100'000),
+      {0, 0}};
+  }
+  return records;
+}
+
+/**
+ * @brief Times 'sort' on a fresh copy of 'input' and verifies the result
+ * against 'is_sorted'.
+ */
+template<typename T, typename Sort, typename IsSorted>
+void run(const std::string& name, const std::vector<T>& input, Sort sort,
+  IsSorted is_sorted) {
+  std::vector<T> values = input;
+  auto start = std::chrono::steady_clock::now();
+  sort(values);
+  std::chrono::duration<double, std::milli> elapsed =
+    std::chrono::steady_clock::now() - start;
+
+  std::cout << "  " << std::left << std::setw(24) << name << std::right <<
+    std::setw(12) << std::fixed << std::setprecision(3) << elapsed.count() <<
+    " ms" << (is_sorted(values) ? "" : "  (NOT SORTED!)") << std::endl;
+}
+
+template<typename T, typename Less, typename RadixSort>
+void run_all(const char* label, const std::vector<T>& input, Less less,
+  RadixSort radix, const std::vector<std::unique_ptr<ThreadPool>>& pools) {
+  auto is_sorted = [&less](const std::vector<T>& values) {
+    return std::is_sorted(values.begin(), values.end(), less);
+  };
+
+  std::cout << label << ", n = " << input.size() << std::endl;
+  run("std::sort", input, [&less](std::vector<T>& values) {
+    std::sort(values.begin(), values.end(), less);
+  }, is_sorted);
+  run("radix", input, radix, is_sorted);
+  for (const std::unique_ptr<ThreadPool>& pool : pools) {
+    std::string name = "parallel_sort (" + std::to_string(pool->size()) +
+      " cores)";
+    run(name, input, [&pool, &less](std::vector<T>& values) {
+      parallel_sort(*pool, values.begin(), values.end(), less);
+    }, is_sorted);
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t max_n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+
+  // Pools of 1, 2, 4, ... workers, up to the number of hardware threads.
+  size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::unique_ptr<ThreadPool>> pools;
+  for (size_t n_threads = 1; n_threads < max_threads; n_threads *= 2) {
+    pools.push_back(std::make_unique<ThreadPool>(n_threads));
+  }
+  pools.push_back(std::make_unique<ThreadPool>(max_threads));
+
+  for (size_t n = 10'000; n <= max_n; n *= 10) {
+    run_all("int", make_ints(n), std::less<int>(),
+      [](std::vector<int>& values) {
+        radix_sort(values.begin(), values.end());
+      }, pools);
+
+    run_all("float", make_floats(n), std::less<float>(),
+      [](std::vector<float>& values) {
+        radix_sort(values.begin(), values.end());
+      }, pools);
+
+    run_all("Record by score", make_records(n),
+      [](const Record& lhs, const Record& rhs) {
+        return lhs.score < rhs.score;
+      },
+      [](std::vector<Record>& records) {
+        sort_by_key(records.begin(), records.end(),
+          [](const Record& record) { return record.score; });
+      }, pools);
+    std::cout << std::endl;
+  }
+}
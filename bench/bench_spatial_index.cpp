@@ -0,0 +1,213 @@
+/*
+ * Benchmark: SpatialIndex (a k-d tree) vs. a brute-force linear scan.
+ *
+ * For 10^4 up to 'max_cities' random cities (see city_csv::write_synthetic),
+ * times 'n_queries' random queries of:
+ * - nearest(k = 1) and nearest(k = 10),
+ * - within(50 km) and within(500 km),
+ * answered by scanning every city, by the index one query at a time, and by
+ * the index's batch queries on a ThreadPool with one worker per hardware
+ * thread. Reports queries per second, and checks that every answer matches
+ * the linear scan (exits with 1 if not).
+ *
+ * NOTE: Build this code in Release mode.
+ *
+ * usage: bench_spatial_index [max_cities] [n_queries]
+ */
+
+#include "bench_util.h"
+#include "city_loader.h"
+#include "spatial_index.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using bench_util::ns_per_item;
+
+using Neighbors = std::vector<SpatialIndex::Neighbor>;
+
+/**
+ * @brief The brute-force baseline: the distance to every city, for every
+ * query. Uses the same unit vectors as the index, so the answers must match
+ * exactly.
+ */
+class LinearScan
+{
+  public:
+    explicit LinearScan(const std::vector<CityRecord>& cities) {
+      positions_.reserve(cities.size());
+      for (const CityRecord& city : cities) {
+        positions_.push_back(
+          geo::to_unit_vector(city.latitude, city.longitude));
+      }
+    }
+
+    // Keeps the best 'k' so far in a max-heap, like the index does.
+    Neighbors nearest(const GeoPoint& query, size_t k) const {
+      geo::UnitVector position =
+        geo::to_unit_vector(query.latitude, query.longitude);
+      std::vector<std::pair<double, uint32_t>> heap;
+      for (size_t idx = 0; idx < positions_.size() && k > 0; idx++) {
+        double distance = geo::chord2(position, positions_[idx]);
+        if (heap.size() < k) {
+          heap.emplace_back(distance, static_cast<uint32_t>(idx));
+          std::push_heap(heap.begin(), heap.end());
+        }
+        else if (distance < heap.front().first) {
+          std::pop_heap(heap.begin(), heap.end());
+          heap.back() = {distance, static_cast<uint32_t>(idx)};
+          std::push_heap(heap.begin(), heap.end());
+        }
+      }
+      std::sort_heap(heap.begin(), heap.end());
+      return _to_neighbors(heap);
+    }
+
+    Neighbors within(const GeoPoint& query, double radius_km) const {
+      geo::UnitVector position =
+        geo::to_unit_vector(query.latitude, query.longitude);
+      double max_chord2 = geo::km_to_chord2(radius_km);
+      std::vector<std::pair<double, uint32_t>> found;
+      for (size_t idx = 0; idx < positions_.size(); idx++) {
+        double distance = geo::chord2(position, positions_[idx]);
+        if (distance <= max_chord2) {
+          found.emplace_back(distance, static_cast<uint32_t>(idx));
+        }
+      }
+      std::sort(found.begin(), found.end());
+      return _to_neighbors(found);
+    }
+
+  private:
+    static Neighbors _to_neighbors(
+      const std::vector<std::pair<double, uint32_t>>& found) {
+      Neighbors neighbors;
+      for (const auto& [chord2, index] : found) {
+        neighbors.push_back({index, geo::chord2_to_km(chord2)});
+      }
+      return neighbors;
+    }
+
+    std::vector<geo::UnitVector> positions_;
+};
+
+// Ties aside (there are none in random data), the same cities in the same
+// order.
+bool same(const Neighbors& lhs, const Neighbors& rhs) {
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+    [](const SpatialIndex::Neighbor& a, const SpatialIndex::Neighbor& b) {
+      return a.index == b.index && a.distance_km == b.distance_km;
+    });
+}
+
+int main(int argc, char** argv) {
+  size_t max_n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+  size_t n_queries = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1'000;
+
+  ThreadPool pool;
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<double> latitude(-90.0, 90.0);
+  std::uniform_real_distribution<double> longitude(-180.0, 180.0);
+  std::vector<GeoPoint> queries(n_queries);
+  for (GeoPoint& query : queries) {
+    query = {latitude(rng), longitude(rng)};
+  }
+
+  std::cout << std::setw(10) << "cities" << std::setw(16) << "query" <<
+    std::setw(14) << "linear" << std::setw(14) << "index" << std::setw(14) <<
+    "batch" << std::setw(10) << "speedup" << "   (queries/s)" << std::endl;
+
+  bool ok = true;
+  for (size_t n = 10'000; n <= max_n; n *= 10) {
+    std::stringstream csv;
+    city_csv::write_synthetic(csv, n);
+    std::vector<CityRecord> cities;
+    city_csv::parse(csv.str(), cities);
+
+    auto start = std::chrono::steady_clock::now();
+    SpatialIndex index(cities);
+    std::chrono::duration<double, std::milli> build =
+      std::chrono::steady_clock::now() - start;
+    LinearScan scan(cities);
+    std::cout << std::setw(10) << n << "  (built in " << std::fixed <<
+      std::setprecision(1) << build.count() << " ms)" << std::endl;
+
+    struct Query
+    {
+      std::string name;
+      std::function<Neighbors(const GeoPoint&)> linear;
+      std::function<Neighbors(const GeoPoint&)> single;
+      std::function<std::vector<Neighbors>()> batch;
+    };
+    std::vector<Query> kinds;
+    for (size_t k : {1, 10}) {
+      kinds.push_back({"nearest k=" + std::to_string(k),
+        [&scan, k](const GeoPoint& query) { return scan.nearest(query, k); },
+        [&index, k](const GeoPoint& query) {
+          return index.nearest(query, k);
+        },
+        [&index, &queries, &pool, k]() {
+          return index.nearest(queries, k, pool);
+        }});
+    }
+    for (double km : {50.0, 500.0}) {
+      kinds.push_back({"within " + std::to_string(int(km)) + " km",
+        [&scan, km](const GeoPoint& query) {
+          return scan.within(query, km);
+        },
+        [&index, km](const GeoPoint& query) {
+          return index.within(query, km);
+        },
+        [&index, &queries, &pool, km]() {
+          return index.within(queries, km, pool);
+        }});
+    }
+
+    for (const Query& kind : kinds) {
+      std::vector<Neighbors> expected(n_queries);
+      std::vector<Neighbors> actual(n_queries);
+      std::vector<Neighbors> batched;
+      // Queries per second, from the nanoseconds per query.
+      double linear_qps = 1e9 / ns_per_item(n_queries, 1, [&]() {
+        for (size_t idx = 0; idx < n_queries; idx++) {
+          expected[idx] = kind.linear(queries[idx]);
+        }
+      });
+      double index_qps = 1e9 / ns_per_item(n_queries, 1, [&]() {
+        for (size_t idx = 0; idx < n_queries; idx++) {
+          actual[idx] = kind.single(queries[idx]);
+        }
+      });
+      double batch_qps = 1e9 / ns_per_item(n_queries, 1, [&]() {
+        batched = kind.batch();
+      });
+
+      for (size_t idx = 0; idx < n_queries; idx++) {
+        if (!same(actual[idx], expected[idx]) ||
+            !same(batched[idx], expected[idx])) {
+          std::cerr << kind.name << ", query " << idx << ": the index " <<
+            "disagrees with the linear scan!" << std::endl;
+          ok = false;
+          break;
+        }
+      }
+      std::cout << std::setw(10) << "" << std::setw(16) << kind.name <<
+        std::setprecision(0) << std::setw(14) << linear_qps <<
+        std::setw(14) << index_qps << std::setw(14) << batch_qps <<
+        std::setprecision(1) << std::setw(9) << index_qps / linear_qps <<
+        "x" << std::endl;
+    }
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+/*
+ * Benchmark: how long it takes to stop a group of sleeping worker threads.
+ *
+ * For 1, 4, 16, ... up to 'max_workers' workers that are all asleep (or
+ * waiting for work), we measure the time from asking them to stop until every
+ * one of them has been joined, plus how long each worker took to wake up.
+ * Workers wait with:
+ * - an atomic flag polled between std::this_thread::sleep_for() calls (the
+ *   pattern app/62_threading.cpp used to use, with a 10 ms instead of a 1 s
+ *   sleep),
+ * - StopToken::sleep_for(), and
+ * - Event::wait() with a StopToken.
+ *
+ * Exits with 1 if the interruptible waits aren't faster to stop than
+ * polling, or if an Event doesn't wake up (or time out) when it should.
+ *
+ * usage: bench_stop_latency [max_workers]
+ */
+
+#include "stop_token.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::literals::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+struct Latency
+{
+  double join_us;  // From requesting the stop until the last join returns.
+  double wake_p50_us;  // From requesting the stop until a worker noticed.
+  double wake_max_us;
+};
+
+/**
+ * @brief Start 'n_workers' threads running wait(token, woke_at), give them time
+ * to fall asleep, then stop them with 'stop' and time it.
+ */
+Latency measure(size_t n_workers,
+  const std::function<void(const StopToken&, Clock::time_point&)>& wait,
+  const std::function<void(StopSource&)>& stop) {
+  StopSource source;
+  std::vector<Clock::time_point> woke_at(n_workers);
+  std::vector<std::thread> workers;
+  workers.reserve(n_workers);
+  for (size_t idx = 0; idx < n_workers; idx++) {
+    workers.emplace_back([&wait, &woke_at, idx, token = source.get_token()]() {
+      wait(token, woke_at[idx]);
+    });
+  }
+  // Not a multiple of the 10 ms polling interval, or polling workers would
+  // happen to wake up right when we stop them.
+  std::this_thread::sleep_for(55ms);
+
+  Clock::time_point start = Clock::now();
+  stop(source);
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  std::chrono::duration<double, std::micro> join = Clock::now() - start;
+
+  std::vector<double> wake(n_workers);
+  for (size_t idx = 0; idx < n_workers; idx++) {
+    wake[idx] = std::chrono::duration<double, std::micro>(
+      woke_at[idx] - start).count();
+  }
+  std::sort(wake.begin(), wake.end());
+  return {join.count(), wake[wake.size() / 2], wake.back()};
+}
+
+void print_row(const std::string& name, size_t n_workers,
+  const Latency& latency) {
+  std::cout << "  " << std::left << std::setw(28) << name << std::right <<
+    std::setw(8) << n_workers << std::fixed << std::setprecision(1) <<
+    std::setw(14) << latency.join_us << std::setw(14) <<
+    latency.wake_p50_us << std::setw(14) << latency.wake_max_us << std::endl;
+}
+
+// Event::wait_for() must time out when nobody sets the event, and wait() must
+// return as soon as somebody does.
+bool check_event() {
+  Event event;
+  Clock::time_point start = Clock::now();
+  if (event.wait_for(5ms) || Clock::now() - start < 5ms) {
+    std::cerr << "Event::wait_for() didn't time out properly." << std::endl;
+    return false;
+  }
+  std::thread setter([&event]() {
+    std::this_thread::sleep_for(5ms);
+    event.set();
+  });
+  bool woke = event.wait_for(10s);
+  setter.join();
+  if (!woke || !event.is_set()) {
+    std::cerr << "Event::wait() missed a set()." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  size_t max_workers = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 256;
+
+  // The old way: a flag that's polled between sleeps. (At least it's atomic.)
+  std::atomic<bool> finished{false};
+  auto poll = [&finished](const StopToken&, Clock::time_point& woke_at) {
+    while (!finished.load()) {
+      std::this_thread::sleep_for(10ms);
+    }
+    woke_at = Clock::now();
+  };
+  auto stop_poll = [&finished](StopSource&) { finished = true; };
+
+  auto sleep = [](const StopToken& token, Clock::time_point& woke_at) {
+    while (token.sleep_for(1h)) {}
+    woke_at = Clock::now();
+  };
+  // Each worker waits on its own Event for work that never comes.
+  auto wait_event = [](const StopToken& token, Clock::time_point& woke_at) {
+    Event work_ready;
+    work_ready.wait(token);
+    woke_at = Clock::now();
+  };
+  auto request_stop = [](StopSource& source) { source.request_stop(); };
+
+  std::cout << "  " << std::left << std::setw(28) << "wait" << std::right <<
+    std::setw(8) << "workers" << std::setw(14) << "join (us)" <<
+    std::setw(14) << "wake p50 (us)" << std::setw(14) << "wake max (us)" <<
+    std::endl;
+
+  bool ok = check_event();
+  for (size_t n_workers = 1; n_workers <= max_workers; n_workers *= 4) {
+    finished = false;
+    Latency polled = measure(n_workers, poll, stop_poll);
+    Latency slept = measure(n_workers, sleep, request_stop);
+    Latency waited = measure(n_workers, wait_event, request_stop);
+    print_row("sleep_for(10ms) polling", n_workers, polled);
+    print_row("StopToken::sleep_for", n_workers, slept);
+    print_row("Event::wait", n_workers, waited);
+
+    // Polling wakes up 5 ms late on average. Anything that reacts to the stop
+    // itself should beat it by a wide margin (except when there are so many
+    // workers that just joining them dominates).
+    if (n_workers <= 16 && (slept.wake_p50_us > polled.wake_p50_us ||
+                            waited.wake_p50_us > polled.wake_p50_us)) {
+      std::cerr << "Interruptible waits were slower to stop than polling!" <<
+        std::endl;
+      ok = false;
+    }
+  }
+  return ok ? 0 : 1;
+}
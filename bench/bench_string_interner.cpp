@@ -0,0 +1,191 @@
+/*
+ * Benchmark: StringInterner vs. plain std::strings, for a workload of many
+ * copies of relatively few names (like city or player names).
+ *
+ * Draws 'n_names' names from a vocabulary of 'n_distinct' made-up names
+ * (skewed, so that a few names are very common), then compares:
+ * - memory: a std::vector<std::string> of the names vs. a
+ *   std::vector<InternedString> plus the interner,
+ * - interning every name, on the calling thread and on a ThreadPool with one
+ *   worker per hardware thread,
+ * - equality: counting the copies of one name with std::string's operator==
+ *   vs. InternedString's,
+ * - counting the copies of every name in a hash map keyed by std::string
+ *   (std::unordered_map and FlatHashMap) vs. one keyed by InternedString.
+ * Exits with 1 if a handle doesn't give back its name, or if any two ways of
+ * counting disagree.
+ *
+ * NOTE: Build this code in Release mode. The default 10^7 names need ~1 GB.
+ *
+ * usage: bench_string_interner [n_names] [n_distinct]
+ */
+
+// Count every byte allocated on the heap, to measure memory use.
+#define BENCH_COUNT_ALLOCATIONS
+#include "bench_util.h"
+#include "flat_hash_map.h"
+#include "string_interner.h"
+#include "thread_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using bench_util::s_allocated_bytes;
+using bench_util::time_ms;
+
+// A made-up name of 1-3 words, e.g. "Norbelin" or "Kasta Ver Miron".
+std::string make_name(std::mt19937& rng) {
+  static const char* const kSyllables[] = {"ber", "lin", "ka", "sta", "ver",
+    "mi", "ron", "no", "del", "port", "an", "to", "ri", "va", "sel", "hol",
+    "mar", "en", "qu", "is"};
+  std::string name;
+  size_t n_words = 1 + rng() % 3;
+  for (size_t word = 0; word < n_words; word++) {
+    if (word > 0) {
+      name += ' ';
+    }
+    size_t start = name.size();
+    for (size_t syllable = 0, n = 1 + rng() % 3; syllable < n; syllable++) {
+      name += kSyllables[rng() % 20];
+    }
+    name[start] = static_cast<char>(name[start] - 'a' + 'A');
+  }
+  return name;
+}
+
+void print_row(const std::string& name, double ms, size_t n_ops) {
+  std::cout << "  " << std::left << std::setw(40) << name << std::right <<
+    std::fixed << std::setprecision(1) << std::setw(10) << ms << " ms" <<
+    std::setw(10) << ms * 1e6 / n_ops << " ns/name" << std::endl;
+}
+
+/**
+ * @brief Counts the copies of every name in a Map, keyed by whatever 'key'
+ * returns for each name, and returns the count of the most common one.
+ */
+template<typename Map, typename Names, typename Key>
+size_t count_names(const char* label, const Names& names, Key key) {
+  size_t most_common = 0;
+  Map counts;
+  double ms = time_ms([&]() {
+    for (const auto& name : names) {
+      counts[key(name)]++;
+    }
+    for (const auto& [name, count] : counts) {
+      most_common = std::max<size_t>(most_common, count);
+    }
+  });
+  print_row(label, ms, names.size());
+  return most_common;
+}
+
+int main(int argc, char** argv) {
+  size_t n_names = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+  size_t n_distinct = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100'000;
+
+  std::mt19937 rng(42);
+  std::vector<std::string> vocabulary(n_distinct);
+  for (std::string& name : vocabulary) {
+    name = make_name(rng);
+  }
+
+  // Cubing a uniform number skews the draws towards the front.
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  size_t bytes_before = s_allocated_bytes.load();
+  std::vector<std::string> names;
+  names.reserve(n_names);
+  for (size_t idx = 0; idx < n_names; idx++) {
+    double skewed = uniform(rng);
+    skewed = skewed * skewed * skewed;
+    names.push_back(vocabulary[static_cast<size_t>(skewed * n_distinct)]);
+  }
+  size_t string_bytes = s_allocated_bytes.load() - bytes_before;
+
+  bool ok = true;
+  std::cout << "interning " << n_names << " names:" << std::endl;
+  StringInterner interner;
+  std::vector<InternedString> handles(n_names);
+  double serial_ms = time_ms([&]() {
+    for (size_t idx = 0; idx < n_names; idx++) {
+      handles[idx] = interner.intern(names[idx]);
+    }
+  });
+  print_row("StringInterner::intern (serial)", serial_ms, n_names);
+
+  {
+    // A fresh interner, so the pool has to add the names too.
+    ThreadPool pool;
+    StringInterner shared;
+    std::vector<InternedString> shared_handles(n_names);
+    double parallel_ms = time_ms([&]() {
+      pool.parallel_for(0, n_names, [&](size_t idx) {
+        shared_handles[idx] = shared.intern(names[idx]);
+      });
+    });
+    print_row("StringInterner::intern (" + std::to_string(pool.size()) +
+      " workers)", parallel_ms, n_names);
+    for (size_t idx = 0; idx < n_names && ok; idx++) {
+      ok = shared.view(shared_handles[idx]) == names[idx];
+    }
+  }
+
+  for (size_t idx = 0; idx < n_names && ok; idx++) {
+    ok = interner.view(handles[idx]) == names[idx];
+  }
+
+  size_t handle_bytes = handles.capacity() * sizeof(InternedString);
+  size_t interner_bytes = interner.memory_usage();
+  std::cout << "memory (" << interner.size() << " distinct names):" <<
+    std::endl << std::setprecision(1) << "  " << std::left << std::setw(40) <<
+    "std::vector<std::string>" << std::right << std::setw(10) <<
+    string_bytes / 1e6 << " MB" << std::endl << "  " << std::left <<
+    std::setw(40) << "std::vector<InternedString> + interner" << std::right <<
+    std::setw(10) << (handle_bytes + interner_bytes) / 1e6 << " MB" <<
+    "   (" << interner_bytes / 1e6 << " MB interner)" << std::endl;
+
+  std::cout << "counting the copies of one name:" << std::endl;
+  const std::string& target = names[n_names / 2];
+  InternedString target_handle = interner.intern(target);
+  size_t n_strings = 0;
+  double string_ms = time_ms([&]() {
+    for (const std::string& name : names) {
+      n_strings += name == target;
+    }
+  });
+  print_row("std::string ==", string_ms, n_names);
+  size_t n_handles = 0;
+  double handle_ms = time_ms([&]() {
+    for (InternedString handle : handles) {
+      n_handles += handle == target_handle;
+    }
+  });
+  print_row("InternedString ==", handle_ms, n_names);
+  ok = ok && n_strings == n_handles;
+
+  std::cout << "counting the copies of every name:" << std::endl;
+  auto as_string = [](const std::string& name) -> const std::string& {
+    return name;
+  };
+  auto as_handle = [](InternedString handle) { return handle; };
+  size_t std_max = count_names<std::unordered_map<std::string, uint32_t>>(
+    "std::unordered_map<std::string, ...>", names, as_string);
+  size_t flat_max = count_names<FlatHashMap<std::string, uint32_t>>(
+    "FlatHashMap<std::string, ...>", names, as_string);
+  size_t interned_max = count_names<FlatHashMap<InternedString, uint32_t>>(
+    "FlatHashMap<InternedString, ...>", handles, as_handle);
+  ok = ok && std_max == flat_max && flat_max == interned_max;
+
+  if (!ok) {
+    std::cerr << "The interned names don't match the originals!" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * Benchmark: ThreadPool vs. spawning a std::thread per task.
+ *
+ * Runs the same batch of CPU-bound tasks:
+ * - fine-grained: 'n_fine' tasks of ~1 us each, and
+ * - coarse-grained: 'n_coarse' tasks of ~1 ms each,
+ * with
+ * - one std::thread per task (at most N alive at a time),
+ * - ThreadPool::submit (a future per task), and
+ * - ThreadPool::parallel_for (the pool picks the chunk size),
+ * on pools of 1, 2, 4, ... up to N workers, where N is the number of hardware
+ * threads. The "overhead" column is the time per task beyond the work itself,
+ * i.e. (elapsed * workers - total work) / tasks.
+ *
+ * NOTE: Build this code in Release mode. On a machine with a single hardware
+ * thread there's nothing to scale, but the overhead column still applies.
+ *
+ * usage: bench_thread_pool [n_fine] [n_coarse]
+ */
+
+#include "bench_util.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using bench_util::time_ms;
+
+// Keep the compiler from optimizing the busy work away.
+static volatile uint32_t s_sink;
+
+// Burn CPU for 'iterations' steps of xorshift.
+void spin(size_t iterations) {
+  uint32_t state = 2463534242u;
+  for (size_t idx = 0; idx < iterations; idx++) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+  }
+  s_sink = state;
+}
+
+// How many spin() iterations take one microsecond on this machine.
+size_t calibrate_spin() {
+  const size_t iterations = 10'000'000;
+  auto start = std::chrono::steady_clock::now();
+  spin(iterations);
+  std::chrono::duration<double, std::micro> elapsed =
+    std::chrono::steady_clock::now() - start;
+  return std::max<size_t>(1, iterations / elapsed.count());
+}
+
+void print_row(const std::string& name, size_t workers, double ms,
+  double baseline_ms, size_t n_tasks, double task_us) {
+  double overhead_us = (ms * 1000.0 * workers - n_tasks * task_us) / n_tasks;
+  std::cout << "  " << std::left << std::setw(28) << name << std::right <<
+    std::setw(8) << workers << std::setw(12) << std::fixed <<
+    std::setprecision(3) << ms << std::setw(10) << std::setprecision(2) <<
+    baseline_ms / ms << "x" << std::setw(14) << overhead_us << std::endl;
+}
+
+/**
+ * @brief Runs 'n_tasks' tasks of 'task_us' microseconds each with every
+ * strategy, on every pool.
+ */
+void run_all(const char* label, size_t n_tasks, double task_us,
+  size_t spins_per_us, const std::vector<std::unique_ptr<ThreadPool>>& pools) {
+  const size_t spins = static_cast<size_t>(task_us * spins_per_us);
+  auto task = [spins]() { spin(spins); };
+
+  std::cout << label << ": " << n_tasks <<
+    " tasks of ~" << std::setprecision(0) << std::fixed << task_us <<
+    " us" << std::endl;
+  std::cout << "  " << std::left << std::setw(28) << "strategy" <<
+    std::right << std::setw(8) << "workers" << std::setw(12) << "time (ms)" <<
+    std::setw(11) << "speedup" << std::setw(14) << "overhead (us)" <<
+    std::endl;
+
+  // A thread per task, but no more than one per hardware thread alive at a
+  // time (or we'd just be measuring the scheduler).
+  const size_t max_threads = pools.back()->size();
+  double thread_ms = time_ms([&]() {
+    std::vector<std::thread> threads;
+    threads.reserve(max_threads);
+    for (size_t idx = 0; idx < n_tasks; idx++) {
+      threads.emplace_back(task);
+      if (threads.size() == max_threads) {
+        for (std::thread& thread : threads) {
+          thread.join();
+        }
+        threads.clear();
+      }
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  });
+
+  // Speedups are relative to the pool with a single worker.
+  double submit_baseline = 0.0;
+  double for_baseline = 0.0;
+  std::vector<std::future<void>> futures(n_tasks);
+  for (const std::unique_ptr<ThreadPool>& pool : pools) {
+    double submit_ms = time_ms([&]() {
+      for (std::future<void>& future : futures) {
+        future = pool->submit(task);
+      }
+      for (std::future<void>& future : futures) {
+        future.get();
+      }
+    });
+    double for_ms = time_ms([&]() {
+      pool->parallel_for(0, n_tasks, [&task](size_t) { task(); });
+    });
+    if (pool == pools.front()) {
+      submit_baseline = submit_ms;
+      for_baseline = for_ms;
+      print_row("std::thread per task", max_threads, thread_ms,
+        submit_baseline, n_tasks, task_us);
+    }
+    print_row("ThreadPool::submit", pool->size(), submit_ms, submit_baseline,
+      n_tasks, task_us);
+    print_row("ThreadPool::parallel_for", pool->size(), for_ms, for_baseline,
+      n_tasks, task_us);
+  }
+  std::cout << std::endl;
+}
+
+int main(int argc, char** argv) {
+  size_t n_fine = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20'000;
+  size_t n_coarse = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200;
+
+  // Pools of 1, 2, 4, ... workers, up to the number of hardware threads.
+  size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::unique_ptr<ThreadPool>> pools;
+  for (size_t n_threads = 1; n_threads < max_threads; n_threads *= 2) {
+    pools.push_back(std::make_unique<ThreadPool>(n_threads));
+  }
+  pools.push_back(std::make_unique<ThreadPool>(max_threads));
+
+  size_t spins_per_us = calibrate_spin();
+  std::cout << "hardware threads: " << max_threads << ", spin iterations " <<
+    "per us: " << spins_per_us << "\n" << std::endl;
+
+  run_all("fine-grained", n_fine, 1, spins_per_us, pools);
+  run_all("coarse-grained", n_coarse, 1000, spins_per_us, pools);
+
+  // A sanity check that parallel_reduce adds everything up exactly once.
+  const size_t n = 1'000'000;
+  uint64_t sum = pools.back()->parallel_reduce(0, n, uint64_t(0),
+    [](size_t idx) { return static_cast<uint64_t>(idx); },
+    [](uint64_t lhs, uint64_t rhs) { return lhs + rhs; });
+  if (sum != uint64_t(n) * (n - 1) / 2) {
+    std::cerr << "parallel_reduce returned " << sum << ", expected " <<
+      uint64_t(n) * (n - 1) / 2 << std::endl;
+    return 1;
+  }
+  return 0;
+}
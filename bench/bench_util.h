@@ -0,0 +1,99 @@
+/*
+ * Small helpers shared by the benchmarks in bench/: timing a piece of code,
+ * counting heap allocations, silencing std::cout and viewing the different
+ * string classes as std::string_views.
+ *
+ * To count allocations, define BENCH_COUNT_ALLOCATIONS before including this
+ * file. That replaces the global operator new/delete, so only do it in the
+ * one file with the benchmark's main().
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+// Include to get 'size_t'
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <streambuf>
+#include <string_view>
+
+namespace bench_util
+{
+  // Updated by operator new (if BENCH_COUNT_ALLOCATIONS is defined). Atomic,
+  // so that allocations made by worker threads count too.
+  inline std::atomic<size_t> s_allocations{0};
+  inline std::atomic<size_t> s_allocated_bytes{0};
+
+  // How long a single call to 'function' takes.
+  template<typename Function>
+  double time_ms(Function function) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+  }
+
+  template<typename Function>
+  double time_ns(Function function) {
+    return time_ms(function) * 1e6;
+  }
+
+  // The fastest of 'n_reps' runs of 'run', in nanoseconds per item, for code
+  // that processes 'n_items' items per run.
+  inline double ns_per_item(size_t n_items, size_t n_reps,
+    const std::function<void()>& run) {
+    double best = 1e300;
+    for (size_t rep = 0; rep < n_reps; rep++) {
+      best = std::min(best, time_ns(run) / n_items);
+    }
+    return best;
+  }
+
+  // A stream buffer that swallows everything written to it.
+  class NullBuffer : public std::streambuf
+  {
+    protected:
+      int overflow(int c) override { return c; }
+      std::streamsize xsputn(const char*, std::streamsize n) override {
+        return n;
+      }
+  };
+
+  // Silences std::cout for as long as it's in scope.
+  class SilenceCout
+  {
+    public:
+      SilenceCout() : previous_(std::cout.rdbuf(&buffer_)) {}
+      ~SilenceCout() { std::cout.rdbuf(previous_); }
+
+    private:
+      NullBuffer buffer_;
+      std::streambuf* previous_;
+  };
+
+  // Any string with c_str() and size(), e.g. std::string or String (types.h),
+  // which has no conversion to std::string_view of its own.
+  template<typename StringType>
+  std::string_view view(const StringType& string) {
+    return {string.c_str(), string.size()};
+  }
+}
+
+#ifdef BENCH_COUNT_ALLOCATIONS
+void* operator new(size_t size) {
+  bench_util::s_allocations.fetch_add(1, std::memory_order_relaxed);
+  bench_util::s_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  if (void* block = std::malloc(size)) {
+    return block;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept { std::free(block); }
+void operator delete(void* block, size_t) noexcept { std::free(block); }
+#endif
@@ -0,0 +1,228 @@
+/*
+ * Benchmark: "array of structs" vs. "structure of arrays" for 3D vectors.
+ *
+ * Runs the same four kernels over 'n' vectors stored three ways:
+ * - Vector<Vec3> (types.h): each element is 32 bytes (x, y, z, padding and a
+ *   pointer to a heap block) for 12 bytes of coordinates,
+ * - std::vector<math::Vec3>: packed x, y, z, 12 bytes per element,
+ * - Vec3SoA: separate arrays of x's, y's and z's, with SIMD bulk operations,
+ * and reports nanoseconds per vector (the fastest of 'n_reps' runs):
+ * - transform: p = rotation * p + translation, in place,
+ * - sum: the sum of all the vectors,
+ * - bounds: the bounding box of all the vectors,
+ * - distance: the distance from every vector to a point.
+ * The first two use plain loops (which the compiler vectorizes if it can), the
+ * last the Vec3SoA member functions. Also times converting the Vector<Vec3>
+ * to a Vec3SoA and back. Exits with 1 if the results don't agree (the sums
+ * only up to rounding, since Vec3SoA::sum() adds in a different order).
+ *
+ * NOTE: Build this code in Release mode. Vec3 logs every copy, move and
+ * destruction to std::cout, so std::cout is silenced while the kernels run
+ * and the results are printed afterwards.
+ *
+ * usage: bench_vec3_soa [n] [n_reps]
+ */
+
+#include "bench_util.h"
+#include "vec3_soa.h"
+#include "vec_math.h"
+#include "types.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using bench_util::ns_per_item;
+
+// Nanoseconds per vector for one kernel in each container.
+struct Row
+{
+  const char* kernel;
+  double aos_ns;
+  double packed_ns;
+  double soa_ns;
+};
+
+struct Results
+{
+  std::vector<Row> rows;
+  double to_soa_ns;
+  double to_aos_ns;
+  // Whether the three containers agree.
+  bool ok;
+};
+
+void print_row(const Row& row) {
+  std::cout << std::setw(10) << row.kernel << std::fixed <<
+    std::setprecision(3) << std::setw(14) << row.aos_ns << std::setw(14) <<
+    row.packed_ns << std::setw(10) << row.soa_ns << std::setprecision(2) <<
+    std::setw(9) << row.aos_ns / row.soa_ns << "x" << std::endl;
+}
+
+// The same arithmetic as Vec3SoA's kernels, one vector at a time.
+math::Vec3 coordinates(const Vec3& vec) { return {vec.x, vec.y, vec.z}; }
+math::Vec3 coordinates(math::Vec3 vec) { return vec; }
+
+void set_coordinates(Vec3& vec, math::Vec3 value) {
+  vec.x = value.x;
+  vec.y = value.y;
+  vec.z = value.z;
+}
+void set_coordinates(math::Vec3& vec, math::Vec3 value) { vec = value; }
+
+template<typename Container>
+void transform(Container& vecs, const math::Mat3& matrix,
+  math::Vec3 translation) {
+  for (size_t idx = 0; idx < vecs.size(); idx++) {
+    set_coordinates(vecs[idx], matrix * coordinates(vecs[idx]) + translation);
+  }
+}
+
+template<typename Container>
+math::Vec3 sum(const Container& vecs) {
+  math::Vec3 total{0.0f, 0.0f, 0.0f};
+  for (size_t idx = 0; idx < vecs.size(); idx++) {
+    total = total + coordinates(vecs[idx]);
+  }
+  return total;
+}
+
+template<typename Container>
+math::Box3 bounding_box(const Container& vecs) {
+  math::Box3 box;
+  for (size_t idx = 0; idx < vecs.size(); idx++) {
+    box = math::grow(box, coordinates(vecs[idx]));
+  }
+  return box;
+}
+
+template<typename Container>
+void distances_to(const Container& vecs, math::Vec3 point, float* out) {
+  for (size_t idx = 0; idx < vecs.size(); idx++) {
+    out[idx] = math::length(coordinates(vecs[idx]) - point);
+  }
+}
+
+bool same(math::Vec3 a, math::Vec3 b) { return a == b; }
+bool same(const math::Box3& a, const math::Box3& b) {
+  return a.min == b.min && a.max == b.max;
+}
+
+// Equal up to an error of 'tolerance' times 'scale'.
+bool close(math::Vec3 a, math::Vec3 b, float scale, float tolerance) {
+  return math::length(a - b) <= tolerance * scale;
+}
+
+// Times every kernel on the same 'n' random vectors in all three containers.
+Results run(size_t n, size_t n_reps) {
+  Results results;
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> value(-100.0f, 100.0f);
+  Vector<Vec3> aos(n);
+  std::vector<math::Vec3> packed(n);
+  for (size_t idx = 0; idx < n; idx++) {
+    packed[idx] = {value(rng), value(rng), value(rng)};
+    aos.emplace_back(packed[idx].x, packed[idx].y, packed[idx].z);
+  }
+
+  Vec3SoA soa;
+  results.to_soa_ns = ns_per_item(n, n_reps, [&]() { soa = Vec3SoA(aos); });
+  Vector<Vec3> round_trip;
+  results.to_aos_ns = ns_per_item(n, n_reps, [&]() {
+    soa.to_vector(round_trip);
+  });
+  bool ok = true;
+  for (size_t idx = 0; idx < n; idx++) {
+    ok = ok && same(coordinates(round_trip[idx]), soa[idx]) &&
+      same(coordinates(aos[idx]), packed[idx]);
+  }
+
+  // A rotation by 'angle' around the z axis, plus a small shift.
+  float angle = 0.1f;
+  math::Mat3 rotation{{{std::cos(angle), -std::sin(angle), 0.0f},
+    {std::sin(angle), std::cos(angle), 0.0f}, {0.0f, 0.0f, 1.0f}}};
+  math::Vec3 shift{0.5f, -0.25f, 1.0f};
+  results.rows.push_back({"transform",
+    ns_per_item(n, n_reps, [&]() { transform(aos, rotation, shift); }),
+    ns_per_item(n, n_reps, [&]() { transform(packed, rotation, shift); }),
+    ns_per_item(n, n_reps, [&]() { soa.transform(rotation, shift); })});
+  for (size_t idx = 0; idx < n; idx++) {
+    ok = ok && same(coordinates(aos[idx]), packed[idx]) &&
+      same(packed[idx], soa[idx]);
+  }
+
+  math::Vec3 sums[3];
+  results.rows.push_back({"sum",
+    ns_per_item(n, n_reps, [&]() { sums[0] = sum(aos); }),
+    ns_per_item(n, n_reps, [&]() { sums[1] = sum(packed); }),
+    ns_per_item(n, n_reps, [&]() { sums[2] = soa.sum(); })});
+  // Float sums of 'n' vectors of length up to ~200 can be off by a few ulps
+  // of the sum of their lengths.
+  float scale = 200.0f * n;
+  ok = ok && close(sums[0], sums[1], scale, 1e-6f) &&
+    close(sums[1], sums[2], scale, 1e-6f);
+
+  math::Box3 boxes[3];
+  results.rows.push_back({"bounds",
+    ns_per_item(n, n_reps, [&]() { boxes[0] = bounding_box(aos); }),
+    ns_per_item(n, n_reps, [&]() { boxes[1] = bounding_box(packed); }),
+    ns_per_item(n, n_reps, [&]() { boxes[2] = soa.bounding_box(); })});
+  ok = ok && same(boxes[0], boxes[1]) && same(boxes[1], boxes[2]);
+
+  std::vector<float> distances[3];
+  for (std::vector<float>& out : distances) {
+    out.resize(n);
+  }
+  math::Vec3 point{1.0f, 2.0f, 3.0f};
+  results.rows.push_back({"distance",
+    ns_per_item(n, n_reps, [&]() {
+      distances_to(aos, point, distances[0].data());
+    }),
+    ns_per_item(n, n_reps, [&]() {
+      distances_to(packed, point, distances[1].data());
+    }),
+    ns_per_item(n, n_reps, [&]() {
+      soa.distances_to(point, distances[2].data());
+    })});
+  ok = ok && distances[0] == distances[1] && distances[1] == distances[2];
+
+  results.ok = ok;
+  return results;
+}
+
+int main(int argc, char** argv) {
+  size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+  size_t n_reps = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20;
+  n = std::max<size_t>(n, 1);
+
+  std::cout << n << " vectors, SIMD: " << math::simd_instruction_set() <<
+    std::endl << "bytes per vector: Vector<Vec3> " << sizeof(Vec3) <<
+    " (+ a heap block), std::vector<math::Vec3> " << sizeof(math::Vec3) <<
+    ", Vec3SoA " << 3 * sizeof(float) << std::endl << std::setw(10) <<
+    "kernel" << std::setw(14) << "Vector<Vec3>" << std::setw(14) <<
+    "vector<Vec3>" << std::setw(10) << "Vec3SoA" << std::setw(10) <<
+    "speedup" << "   (ns per vector)" << std::endl;
+
+  Results results;
+  {
+    bench_util::SilenceCout silence;
+    results = run(n, n_reps);
+  }
+  for (const Row& row : results.rows) {
+    print_row(row);
+  }
+  std::cout << "convert Vector<Vec3> -> Vec3SoA: " << std::setprecision(3) <<
+    results.to_soa_ns << " ns per vector, Vec3SoA -> Vector<Vec3>: " <<
+    results.to_aos_ns << " ns per vector" << std::endl;
+
+  if (!results.ok) {
+    std::cerr << "The three containers don't agree!" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * Benchmark: Vector<T> with the default heap allocator vs. the allocators in
+ * allocators.h for a "build-and-discard" workload.
+ *
+ * Each "request" builds a handful of small Vectors, reads them back, and then
+ * throws all of them away. This is exactly the pattern where an arena shines:
+ * instead of freeing every Vector individually, the whole request's memory is
+ * released with a single Arena::reset().
+ *
+ * NOTE: Build this code in Release mode and not Debug to get a better
+ * understanding of true performance.
+ *
+ * usage: bench_vector_allocators [n_requests]
+ */
+
+#include "allocators.h"
+#include "utils.h"
+#include "vector.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+// The number of Vectors built per request, and the largest of them.
+const size_t kVectorsPerRequest = 32;
+const size_t kMaxElements = 100;
+
+// Prevent the compiler from optimizing the whole workload away.
+static volatile long long s_sink = 0;
+
+/**
+ * @brief Build and discard the Vectors for a single request.
+ *
+ * @tparam Allocator
+ * @param allocator
+ */
+template<typename Allocator>
+void handle_request(size_t request, const Allocator& allocator) {
+  long long sum = 0;
+  for (size_t idx = 0; idx < kVectorsPerRequest; idx++) {
+    Vector<int, Allocator> vec(allocator);
+    size_t n_elements = (request * 7 + idx * 13) % kMaxElements;
+    for (size_t elem = 0; elem < n_elements; elem++) {
+      vec.push_back(static_cast<int>(elem));
+    }
+    for (int value : vec) {
+      sum += value;
+    }
+  }
+  s_sink = s_sink + sum;
+}
+
+int main(int argc, char** argv) {
+  size_t n_requests = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100'000;
+  std::cout << n_requests << " requests x " << kVectorsPerRequest <<
+    " Vectors each." << std::endl;
+
+  std::cout << "\nstd::allocator (operator new):" << std::endl;
+  {
+    Timer timer;
+    for (size_t request = 0; request < n_requests; request++) {
+      handle_request(request, std::allocator<int>());
+    }
+  }
+
+  // One arena per "worker". Every request is released with a single reset().
+  std::cout << "\nArenaAllocator (reset per request):" << std::endl;
+  {
+    Arena arena;
+    Timer timer;
+    for (size_t request = 0; request < n_requests; request++) {
+      handle_request(request, ArenaAllocator<int>(arena));
+      arena.reset();
+    }
+  }
+
+  std::cout << "\nPoolAllocator:" << std::endl;
+  {
+    Pool pool;
+    Timer timer;
+    for (size_t request = 0; request < n_requests; request++) {
+      handle_request(request, PoolAllocator<int>(pool));
+    }
+  }
+
+  std::cout << "\nThreadLocalAllocator:" << std::endl;
+  {
+    Timer timer;
+    for (size_t request = 0; request < n_requests; request++) {
+      handle_request(request, ThreadLocalAllocator<int>());
+    }
+  }
+}
@@ -0,0 +1,130 @@
+/*
+ * Benchmark: Vector's bulk operations (insert, append_range, erase_if) vs.
+ * emulating them with repeated push_back/pop_back.
+ *
+ * 1. Insert a batch into the middle of a Vector. The emulation pops the tail
+ *    off, pushes the batch and then pushes the tail back.
+ * 2. Append a batch with append_range vs. one push_back per element.
+ * 3. Remove every third element with erase_if vs. one erase() per element
+ *    (which shifts the whole tail every time).
+ *
+ * NOTE: Build this code in Release mode.
+ *
+ * usage: bench_vector_bulk_ops [n_elements]
+ */
+
+#include "utils.h"
+#include "vector.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Prevent the compiler from optimizing the whole workload away.
+static volatile long long s_sink = 0;
+
+// NOTE: Vector doesn't define a copy constructor yet (the implicit one would
+// perform a shallow copy), so fill the Vector in-place rather than returning
+// it by value.
+void fill(Vector<int>& vec, size_t n) {
+  for (size_t idx = 0; idx < n; idx++) {
+    vec.push_back(static_cast<int>(idx));
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100'000;
+  const size_t n_batches = 100;
+  std::vector<int> batch(1'000, 42);
+
+  std::cout << "1. Insert " << n_batches << " batches of " << batch.size() <<
+    " into the middle of a Vector of " << n << " ints." << std::endl;
+  std::cout << "push_back/pop_back emulation:" << std::endl;
+  {
+    Vector<int> vec;
+    fill(vec, n);
+    Timer timer;
+    std::vector<int> tail;
+    for (size_t b = 0; b < n_batches; b++) {
+      size_t middle = vec.size() / 2;
+      tail.clear();
+      while (vec.size() > middle) {
+        tail.push_back(vec[vec.size() - 1]);
+        vec.pop_back();
+      }
+      for (int value : batch) {
+        vec.push_back(value);
+      }
+      for (size_t idx = tail.size(); idx > 0; idx--) {
+        vec.push_back(tail[idx - 1]);
+      }
+    }
+    s_sink = s_sink + vec.size();
+  }
+  std::cout << "Vector::insert:" << std::endl;
+  {
+    Vector<int> vec;
+    fill(vec, n);
+    Timer timer;
+    for (size_t b = 0; b < n_batches; b++) {
+      Vector<int>::Iterator middle = vec.begin();
+      for (size_t idx = 0; idx < vec.size() / 2; idx++) {
+        ++middle;
+      }
+      vec.insert(middle, batch.begin(), batch.end());
+    }
+    s_sink = s_sink + vec.size();
+  }
+
+  std::cout << "\n2. Append " << n_batches << " batches of " << batch.size() <<
+    " ints." << std::endl;
+  std::cout << "push_back:" << std::endl;
+  {
+    Timer timer;
+    Vector<int> vec;
+    for (size_t b = 0; b < n_batches; b++) {
+      for (int value : batch) {
+        vec.push_back(value);
+      }
+    }
+    s_sink = s_sink + vec.size();
+  }
+  std::cout << "Vector::append_range:" << std::endl;
+  {
+    Timer timer;
+    Vector<int> vec;
+    for (size_t b = 0; b < n_batches; b++) {
+      vec.append_range(batch);
+    }
+    s_sink = s_sink + vec.size();
+  }
+
+  // Removing one element at a time is quadratic, so use a smaller Vector.
+  size_t n_erase = n / 4;
+  std::cout << "\n3. Remove every third element from a Vector of " <<
+    n_erase << " ints." << std::endl;
+  std::cout << "Vector::erase (one at a time):" << std::endl;
+  {
+    Vector<int> vec;
+    fill(vec, n_erase);
+    Timer timer;
+    Vector<int>::Iterator it = vec.begin();
+    while (it != vec.end()) {
+      if (*it % 3 == 0) {
+        it = vec.erase(it);
+      }
+      else {
+        ++it;
+      }
+    }
+    s_sink = s_sink + vec.size();
+  }
+  std::cout << "erase_if:" << std::endl;
+  {
+    Vector<int> vec;
+    fill(vec, n_erase);
+    Timer timer;
+    erase_if(vec, [](int value) { return value % 3 == 0; });
+    s_sink = s_sink + vec.size();
+  }
+}
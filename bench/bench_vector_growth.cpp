@@ -0,0 +1,64 @@
+/*
+ * Benchmark: reallocation count and total time to append n ints to a Vector
+ * under each growth policy in growth_policy.h, plus a Vector that reserve()s
+ * the final size up front.
+ *
+ * NOTE: Build this code in Release mode. Appending 10^8 ints needs over a GB
+ * of memory at peak, so the default stops at 10^7.
+ *
+ * usage: bench_vector_growth [max_appends]
+ */
+
+#include "growth_policy.h"
+#include "vector.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+template<typename GrowthPolicy>
+using CountedVector =
+  Vector<int, std::allocator<int>, GrowthPolicy, CountingInstrumentation>;
+
+template<typename GrowthPolicy>
+void run(const char* name, size_t n, bool reserve) {
+  auto start = std::chrono::steady_clock::now();
+  CountedVector<GrowthPolicy> vec;
+  if (reserve) {
+    vec.reserve(n);
+  }
+  for (size_t idx = 0; idx < n; idx++) {
+    vec.push_back(static_cast<int>(idx));
+  }
+  std::chrono::duration<double, std::milli> elapsed =
+    std::chrono::steady_clock::now() - start;
+
+  const CountingInstrumentation& counters = vec.instrumentation();
+  std::cout << std::left << std::setw(18) << name << std::right <<
+    std::setw(12) << n <<
+    std::setw(10) << counters.reallocations() <<
+    std::setw(16) << counters.bytes_moved() <<
+    std::setw(14) << vec.capacity() <<
+    std::setw(14) << std::fixed << std::setprecision(3) << elapsed.count() <<
+    std::endl;
+}
+
+int main(int argc, char** argv) {
+  size_t max_n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+
+  std::cout << std::left << std::setw(18) << "policy" << std::right <<
+    std::setw(12) << "appends" << std::setw(10) << "reallocs" <<
+    std::setw(16) << "bytes moved" << std::setw(14) << "capacity" <<
+    std::setw(14) << "time (ms)" << std::endl;
+
+  for (size_t n = 1'000; n <= max_n; n *= 10) {
+    run<GrowHalf>("GrowHalf (1.5x)", n, false);
+    run<GrowDouble>("GrowDouble (2x)", n, false);
+    run<GrowPageRounded>("GrowPageRounded", n, false);
+    run<GrowSizeClass>("GrowSizeClass", n, false);
+    run<GrowHalf>("reserve(n)", n, true);
+    std::cout << std::endl;
+  }
+}
@@ -0,0 +1,95 @@
+/*
+ * Benchmark: Vector<T>::_reallocate with and without the trivially
+ * relocatable fast path (see traits.h).
+ *
+ * Every element type is benchmarked twice: once as-is (int, Vec2 and String
+ * all take the memcpy path) and once wrapped in 'ElementWise<T>', which has a
+ * user-defined move constructor and destructor and therefore forces the
+ * "move-construct then destroy" path for each element.
+ *
+ * NOTE: Build this code in Release mode.
+ *
+ * usage: bench_vector_relocation [max_elements]
+ */
+
+#include "types.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+
+/**
+ * @brief Wraps a T so that it is NOT trivially relocatable.
+ *
+ * @tparam T
+ */
+template<typename T>
+struct ElementWise
+{
+  T value;
+
+  template<typename... Args>
+  ElementWise(Args&&... args) : value(std::forward<Args>(args)...) {}
+
+  ElementWise(ElementWise&& other) noexcept : value(std::move(other.value)) {}
+  ~ElementWise() {}
+};
+
+/**
+ * @brief Pushes 'n' elements into a fresh Vector and returns the best time (in
+ * ms) over a few repetitions.
+ */
+template<typename VectorType, typename Make>
+double time_push_back(size_t n, Make make) {
+  using Clock = std::chrono::steady_clock;
+  double best = 1e300;
+  for (int rep = 0; rep < 5; rep++) {
+    auto start = Clock::now();
+    {
+      VectorType vec;
+      for (size_t idx = 0; idx < n; idx++) {
+        make(vec, idx);
+      }
+    }
+    std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+template<typename T, typename Make>
+void run(const char* name, size_t max_n, Make make) {
+  for (size_t n = 1'000; n <= max_n; n *= 10) {
+    // Our String class prints diagnostics to std::cout. Detach the stream
+    // buffer so that we time the container and not the terminal.
+    std::streambuf* buffer = std::cout.rdbuf(nullptr);
+    double slow = time_push_back<Vector<ElementWise<T>>>(n, make);
+    double fast = time_push_back<Vector<T>>(n, make);
+    std::cout.rdbuf(buffer);
+    std::cout.clear();
+
+    std::cout << name << "\tn=" << n << "\tmemcpy: " << fast << " ms"
+      << "\telement-wise: " << slow << " ms"
+      << "\tspeedup: " << slow / fast << "x" << std::endl;
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t max_n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+
+  run<int>("Vector<int>", max_n, [](auto& vec, size_t idx) {
+    vec.emplace_back(static_cast<int>(idx));
+  });
+
+  run<Vec2>("Vector<Vec2>", max_n, [](auto& vec, size_t idx) {
+    vec.emplace_back(static_cast<float>(idx), 1.0f);
+  });
+
+  // Strings perform a heap allocation each, so cap the element count.
+  run<String>("Vector<String>", std::min<size_t>(max_n, 100'000),
+    [](auto& vec, size_t) { vec.emplace_back("Cherno"); });
+}
@@ -0,0 +1,104 @@
+/*
+ * Benchmark: running the STL algorithms directly over our Vector, now that
+ * VectorIterator is a proper random access iterator.
+ *
+ * Compares std::sort and std::lower_bound over Vector<int> and std::vector<int>
+ * and, if TBB is available (see CMakeLists.txt), the parallel version of
+ * std::sort using std::execution::par.
+ *
+ * NOTE: Build this code in Release mode.
+ *
+ * usage: bench_vector_std_algorithms [n_elements]
+ */
+
+#include "utils.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#ifdef HAS_PARALLEL_STL
+  #include <execution>
+#endif
+
+// Prevent the compiler from optimizing the whole workload away.
+static volatile long long s_sink = 0;
+
+// A cheap, deterministic pseudo-random sequence (xorshift).
+uint32_t next_random(uint32_t& state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+template<typename Container>
+void fill(Container& container, size_t n) {
+  uint32_t state = 2463534242u;
+  for (size_t idx = 0; idx < n; idx++) {
+    container.push_back(static_cast<int>(next_random(state) >> 1));
+  }
+}
+
+template<typename Container>
+void lookups(const Container& container, size_t n_lookups) {
+  uint32_t state = 88172645u;
+  long long found = 0;
+  for (size_t idx = 0; idx < n_lookups; idx++) {
+    int key = static_cast<int>(next_random(state) >> 1);
+    auto it = std::lower_bound(container.begin(), container.end(), key);
+    found += it != container.end();
+  }
+  s_sink = s_sink + found;
+}
+
+int main(int argc, char** argv) {
+  size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+  size_t n_lookups = 1'000'000;
+
+  std::cout << "std::sort over " << n << " ints:" << std::endl;
+  Vector<int> vec;
+  std::vector<int> std_vec;
+  fill(vec, n);
+  fill(std_vec, n);
+  {
+    std::cout << "Vector<int>:" << std::endl;
+    Timer timer;
+    std::sort(vec.begin(), vec.end());
+  }
+  {
+    std::cout << "std::vector<int>:" << std::endl;
+    Timer timer;
+    std::sort(std_vec.begin(), std_vec.end());
+  }
+
+  std::cout << "\nstd::lower_bound x " << n_lookups << ":" << std::endl;
+  {
+    std::cout << "Vector<int>:" << std::endl;
+    Timer timer;
+    lookups(vec, n_lookups);
+  }
+  {
+    std::cout << "std::vector<int>:" << std::endl;
+    Timer timer;
+    lookups(std_vec, n_lookups);
+  }
+
+#ifdef HAS_PARALLEL_STL
+  std::cout << "\nstd::sort(std::execution::par) over " << n << " ints:" <<
+    std::endl;
+  Vector<int> par_vec;
+  fill(par_vec, n);
+  {
+    std::cout << "Vector<int>:" << std::endl;
+    Timer timer;
+    std::sort(std::execution::par, par_vec.begin(), par_vec.end());
+  }
+  s_sink = s_sink + std::is_sorted(par_vec.cbegin(), par_vec.cend());
+#else
+  std::cout << "\nTBB not found, skipping std::execution::par." << std::endl;
+#endif
+}
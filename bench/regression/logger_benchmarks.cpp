@@ -0,0 +1,66 @@
+/*
+ * Logger benchmarks for the regression gate (tools/benchmark_runner.cpp).
+ * Logger prints to std::cout (even just to say it was created), so each
+ * benchmark points std::cout at a buffer that throws everything away.
+ */
+
+#include "../bench_util.h"
+#include "async_log.h"
+#include "benchmark.h"
+#include "binary_log.h"
+#include "log.h"
+
+#include <iostream>
+#include <string>
+
+using bench_util::NullBuffer;
+using bench_util::SilenceCout;
+
+// A message that's filtered out at runtime should cost next to nothing.
+static void logger_info_filtered_lazy(bench::State& state) {
+  SilenceCout silence;
+  Logger logger(Logger::WARNING);
+  size_t idx = 0;
+  while (state.keep_running()) {
+    LOG_INFO(logger, "processed record " + std::to_string(idx++));
+    bench::clobber_memory();
+  }
+}
+BENCHMARK(logger_info_filtered_lazy);
+
+static void logger_info_text(bench::State& state) {
+  SilenceCout silence;
+  Logger logger(Logger::INFO);
+  while (state.keep_running()) {
+    logger.info("processed another record");
+  }
+}
+BENCHMARK(logger_info_text);
+
+static void logger_binary_2_args(bench::State& state) {
+  SilenceCout silence;
+  NullBuffer buffer;
+  std::ostream out(&buffer);
+  BinaryLogWriter writer(out);
+  Logger logger(Logger::INFO);
+  logger.set_binary_writer(&writer);
+  int idx = 0;
+  while (state.keep_running()) {
+    LOG_BINARY(logger, Logger::INFO, "record {} took {} ms", idx++, 1.5);
+  }
+}
+BENCHMARK(logger_binary_2_args);
+
+static void logger_async_enqueue(bench::State& state) {
+  SilenceCout silence;
+  NullBuffer buffer;
+  std::ostream out(&buffer);
+  AsyncLogBackend backend(out);
+  Logger logger(Logger::INFO);
+  logger.set_async_backend(&backend);
+  while (state.keep_running()) {
+    logger.info("processed another record");
+  }
+  backend.flush();
+}
+BENCHMARK(logger_async_enqueue);
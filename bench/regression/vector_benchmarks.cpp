@@ -0,0 +1,64 @@
+/*
+ * Vector benchmarks for the regression gate (tools/benchmark_runner.cpp).
+ */
+
+#include "benchmark.h"
+#include "vector.h"
+
+#include <numeric>
+#include <vector>
+
+static void vector_push_back_1k(bench::State& state) {
+  while (state.keep_running()) {
+    Vector<int> vec;
+    for (int idx = 0; idx < 1000; idx++) {
+      vec.push_back(idx);
+    }
+    bench::do_not_optimize(vec.data());
+  }
+}
+BENCHMARK(vector_push_back_1k);
+
+static void vector_push_back_reserved_1k(bench::State& state) {
+  while (state.keep_running()) {
+    Vector<int> vec;
+    vec.reserve(1000);
+    for (int idx = 0; idx < 1000; idx++) {
+      vec.push_back(idx);
+    }
+    bench::do_not_optimize(vec.data());
+  }
+}
+BENCHMARK(vector_push_back_reserved_1k);
+
+static void vector_iterate_sum_100k(bench::State& state) {
+  Vector<int> vec;
+  vec.resize(100'000, 1);
+  while (state.keep_running()) {
+    long long sum = std::accumulate(vec.begin(), vec.end(), 0LL);
+    bench::do_not_optimize(sum);
+  }
+}
+BENCHMARK(vector_iterate_sum_100k);
+
+static void vector_append_range_10k(bench::State& state) {
+  std::vector<int> source(10'000, 7);
+  while (state.keep_running()) {
+    Vector<int> vec;
+    vec.append_range(source);
+    bench::do_not_optimize(vec.data());
+  }
+}
+BENCHMARK(vector_append_range_10k);
+
+static void vector_erase_if_10k(bench::State& state) {
+  std::vector<int> source(10'000);
+  std::iota(source.begin(), source.end(), 0);
+  while (state.keep_running()) {
+    Vector<int> vec;
+    vec.append_range(source);
+    size_t erased = vec.erase_if([](int value) { return value % 3 == 0; });
+    bench::do_not_optimize(erased);
+  }
+}
+BENCHMARK(vector_erase_if_10k);
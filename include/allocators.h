@@ -0,0 +1,220 @@
+/*
+ * A small collection of std-compatible allocators that can be plugged into our
+ * custom Vector container (or any STL container).
+ *
+ * - ArenaAllocator: a "monotonic" bump allocator. Allocation is a pointer
+ *   increment, deallocation is a no-op, and ALL memory is released at once by
+ *   calling Arena::reset() (an O(1) operation).
+ * - PoolAllocator: rounds every request up to a power-of-two "size class" and
+ *   recycles freed blocks through a free-list per size class.
+ * - ThreadLocalAllocator: a stateless allocator that caches freed blocks in a
+ *   free-list owned by the calling thread, so it never takes a lock.
+ *
+ * Each stateful allocator is just a pointer to a "memory resource" (an Arena or
+ * a Pool) that must outlive every container using it.
+ */
+#pragma once
+
+// Include to get 'size_t'
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/**
+ * @brief A monotonic memory resource. Memory is carved out of large chunks by
+ * bumping a pointer. Individual deallocations are ignored.
+ */
+class Arena
+{
+  public:
+    explicit Arena(size_t chunk_size = 64 * 1024);
+    ~Arena();
+
+    // An Arena owns its chunks, so it cannot be copied.
+    Arena(const Arena& other) = delete;
+    Arena& operator=(const Arena& other) = delete;
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * @brief Releases every allocation made from this arena in O(1). The chunks
+     * themselves are kept around and reused by subsequent allocations.
+     *
+     * NOTE: Any container still using memory from this arena is left dangling!
+     */
+    void reset();
+
+    // The total number of bytes reserved from the system.
+    size_t capacity() const;
+
+  private:
+    struct Chunk
+    {
+      char* data;
+      size_t size;
+    };
+
+    std::vector<Chunk> chunks_;
+    size_t current_{0};
+    size_t offset_{0};
+    size_t chunk_size_;
+};
+
+/**
+ * @brief A memory resource that serves requests from power-of-two size classes
+ * (16 bytes up to 64 KiB). Freed blocks are pushed onto a free-list for their
+ * size class and handed out again by the next request of that class. Requests
+ * larger than the largest size class go straight to operator new.
+ */
+class Pool
+{
+  public:
+    static constexpr size_t kMinClassSize = 16;
+    static constexpr size_t kMaxClassSize = 64 * 1024;
+    static constexpr size_t kNumClasses = 13;
+
+    Pool() = default;
+    ~Pool();
+
+    Pool(const Pool& other) = delete;
+    Pool& operator=(const Pool& other) = delete;
+
+    void* allocate(size_t bytes);
+    void deallocate(void* ptr, size_t bytes);
+
+  private:
+    // A freed block stores a pointer to the next free block in-place.
+    struct FreeBlock
+    {
+      FreeBlock* next;
+    };
+
+    void* _refill(size_t size_class);
+
+    FreeBlock* free_lists_[kNumClasses]{};
+    std::vector<void*> chunks_;
+};
+
+// The thread-local free-lists used by ThreadLocalAllocator. Defined in
+// allocators.cpp.
+void* thread_local_allocate(size_t bytes);
+void thread_local_deallocate(void* ptr, size_t bytes);
+
+/**
+ * @brief A std-compatible allocator handle to an Arena.
+ *
+ * @tparam T
+ */
+template<typename T>
+class ArenaAllocator
+{
+  public:
+    using value_type = T;
+
+    ArenaAllocator(Arena& arena) : arena_(&arena) {}
+
+    // The "rebind" constructor. Containers may need to allocate types other
+    // than T (e.g. nodes) from the same arena.
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+    T* allocate(size_t n) {
+      return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    // Memory is only released by Arena::reset().
+    void deallocate(T* /*ptr*/, size_t /*n*/) {}
+
+    Arena* arena() const { return arena_; }
+
+  private:
+    Arena* arena_;
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+  return lhs.arena() == rhs.arena();
+}
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+  return !(lhs == rhs);
+}
+
+/**
+ * @brief A std-compatible allocator handle to a Pool.
+ *
+ * @tparam T
+ */
+template<typename T>
+class PoolAllocator
+{
+  public:
+    using value_type = T;
+
+    PoolAllocator(Pool& pool) : pool_(&pool) {}
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>& other) : pool_(other.pool()) {}
+
+    T* allocate(size_t n) {
+      return static_cast<T*>(pool_->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) { pool_->deallocate(ptr, n * sizeof(T)); }
+
+    Pool* pool() const { return pool_; }
+
+  private:
+    Pool* pool_;
+};
+
+template<typename T, typename U>
+bool operator==(const PoolAllocator<T>& lhs, const PoolAllocator<U>& rhs) {
+  return lhs.pool() == rhs.pool();
+}
+
+template<typename T, typename U>
+bool operator!=(const PoolAllocator<T>& lhs, const PoolAllocator<U>& rhs) {
+  return !(lhs == rhs);
+}
+
+/**
+ * @brief A stateless, std-compatible allocator backed by per-thread
+ * free-lists. Memory freed on one thread may be reused by that thread, no
+ * matter which thread allocated it.
+ *
+ * @tparam T
+ */
+template<typename T>
+class ThreadLocalAllocator
+{
+  public:
+    using value_type = T;
+
+    ThreadLocalAllocator() = default;
+
+    template<typename U>
+    ThreadLocalAllocator(const ThreadLocalAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+      return static_cast<T*>(thread_local_allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) {
+      thread_local_deallocate(ptr, n * sizeof(T));
+    }
+};
+
+// Every ThreadLocalAllocator can free memory allocated by any other.
+template<typename T, typename U>
+bool operator==(const ThreadLocalAllocator<T>&,
+  const ThreadLocalAllocator<U>&) {
+  return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const ThreadLocalAllocator<T>&,
+  const ThreadLocalAllocator<U>&) {
+  return false;
+}
@@ -0,0 +1,110 @@
+/*
+ * An asynchronous backend for our Logger.
+ */
+#pragma once
+
+#include "log.h"
+#include "ring_buffer.h"
+
+#include <atomic>
+#include <condition_variable>
+// Include to get 'size_t'
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief A single queued log message. Messages are copied into a fixed-size
+ * record (and truncated if they don't fit) so that logging never allocates.
+ */
+struct LogRecord
+{
+  static constexpr size_t kMaxMessageLength = 240;
+
+  Logger::LogLevel level;
+  uint16_t length;
+  char message[kMaxMessageLength];
+};
+
+/**
+ * @brief Moves the cost of writing log messages off of the calling thread.
+ *
+ * Callers copy their message into a lock-free ring buffer (see ring_buffer.h)
+ * and return immediately. A dedicated writer thread drains the ring buffer in
+ * batches, formats the messages and writes each batch to the sink with a
+ * single write and a single flush.
+ *
+ *   AsyncLogBackend backend;
+ *   Logger logger(Logger::INFO);
+ *   logger.set_async_backend(&backend);
+ *   logger.info("Howdy!");  // Returns as soon as the message is queued.
+ *
+ * The backend must outlive every Logger that uses it. Destroying the backend
+ * writes out everything that's still queued.
+ */
+class AsyncLogBackend
+{
+  public:
+    // What to do when a message is logged while the ring buffer is full.
+    enum OverflowPolicy
+    {
+      BLOCK = 0,            // Wait (spin) until the writer frees up a slot.
+      DROP = 1,             // Throw the NEW message away.
+      OVERWRITE_OLDEST = 2  // Throw the OLDEST queued message away.
+    };
+
+    struct Options
+    {
+      size_t capacity = 8192;
+      OverflowPolicy overflow_policy = BLOCK;
+      // The writer writes (and flushes) at most this many messages at once.
+      size_t max_batch_size = 256;
+    };
+
+    explicit AsyncLogBackend(std::ostream& sink = std::cout);
+    AsyncLogBackend(std::ostream& sink, const Options& options);
+    ~AsyncLogBackend();
+
+    AsyncLogBackend(const AsyncLogBackend& other) = delete;
+    AsyncLogBackend& operator=(const AsyncLogBackend& other) = delete;
+
+    /**
+     * @brief Queue a message for the writer thread. Safe to call from any
+     * number of threads at once.
+     *
+     * @return false if the message was dropped (DROP policy only).
+     */
+    bool enqueue(Logger::LogLevel level, const char* message);
+
+    // Block until every message queued before this call has been written.
+    void flush();
+
+    // The number of messages thrown away because the ring buffer was full.
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+  private:
+    void _writer_loop();
+    void _wake_writer();
+
+    std::ostream& sink_;
+    Options options_;
+    RingBuffer<LogRecord> buffer_;
+
+    // 'pushed_' counts successfully queued messages and 'consumed_' counts
+    // messages that have left the queue (written or overwritten), so that
+    // flush() knows when it's caught up.
+    std::atomic<uint64_t> pushed_{0};
+    std::atomic<uint64_t> consumed_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    // The writer sleeps on a condition variable when there's nothing to do.
+    // Producers only touch the mutex if the writer is actually asleep.
+    std::atomic<bool> writer_sleeping_{false};
+    std::atomic<bool> stopping_{false};
+    std::mutex mutex_;
+    std::condition_variable wake_up_;
+
+    std::thread writer_;
+};
@@ -0,0 +1,197 @@
+/*
+ * A small micro-benchmark harness. Timing a single run with the Timer from
+ * utils.h is easy to get wrong: the first run pays for cold caches and page
+ * faults, one run tells us nothing about noise, and the optimizer is free to
+ * delete work whose result is never used. Instead:
+ *
+ *   #include "benchmark.h"
+ *
+ *   void make_shared_vec2(bench::State& state) {
+ *     while (state.keep_running()) {
+ *       auto ptr = std::make_shared<Vec2>(0.0f, 0.0f);
+ *       bench::do_not_optimize(ptr);
+ *     }
+ *   }
+ *   BENCHMARK(make_shared_vec2);
+ *
+ *   BENCHMARK_MAIN();
+ *
+ * For each registered benchmark, the harness:
+ * 1. Calibrates the number of iterations so that one repetition takes at least
+ *    --min-time-ms (which also warms up caches, the branch predictor and the
+ *    allocator), then runs --warmup-ms worth of untimed repetitions.
+ * 2. Times --repetitions repetitions and reports the median time per iteration
+ *    along with the median absolute deviation (MAD), which unlike the mean and
+ *    standard deviation isn't thrown off by the odd run that gets preempted.
+ *
+ * With --perf-counters, the timed repetitions also collect hardware counters
+ * (see perf_counters.h) and report cycles, IPC, cache misses and branch misses
+ * per iteration, or just the times if counters aren't available.
+ *
+ * Results print as a table, or as CSV/JSON with --format=csv|json (see
+ * bench::run_main() for every flag).
+ */
+#pragma once
+
+#include "perf_counters.h"
+
+#include <atomic>
+// Include to get 'size_t'
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Two levels of macros so that __LINE__ is expanded before it's pasted.
+#define BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_IMPL(a, b)
+
+// Register 'fn', a void(bench::State&), under its own name.
+#define BENCHMARK(fn) \
+  static const bool BENCHMARK_CONCAT(benchmark_registered_, __LINE__) = \
+    bench::register_benchmark(#fn, fn)
+
+// Define main() to run every registered benchmark. Defining BENCHMARK_NO_MAIN
+// turns this off, so that a file's benchmarks can also be linked into another
+// program, e.g. the regression gate in tools/benchmark_runner.cpp.
+#ifdef BENCHMARK_NO_MAIN
+  #define BENCHMARK_MAIN()
+#else
+  #define BENCHMARK_MAIN() \
+    int main(int argc, char** argv) { return bench::run_main(argc, argv); }
+#endif
+
+namespace bench
+{
+  /**
+   * @brief Makes the compiler assume that 'value' is read (and, for the
+   * non-const overload, modified) here, so that the computation that produced
+   * it can't be optimized away or hoisted out of the loop.
+   */
+#if defined(__GNUC__) || defined(__clang__)
+  template<typename T>
+  inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+  }
+
+  template<typename T>
+  inline void do_not_optimize(T& value) {
+    asm volatile("" : "+r,m"(value) : : "memory");
+  }
+
+  // Forces every pending write to memory to actually happen here.
+  inline void clobber_memory() { asm volatile("" : : : "memory"); }
+#else
+  // Without inline assembly, fall back to reading through a volatile pointer.
+  template<typename T>
+  inline void do_not_optimize(const T& value) {
+    const volatile char* bytes = reinterpret_cast<const volatile char*>(&value);
+    (void)*bytes;
+  }
+
+  inline void clobber_memory() {
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+  }
+#endif
+
+  /**
+   * @brief Handed to every benchmark, which runs its body once per call to
+   * keep_running() that returns true.
+   */
+  class State
+  {
+    public:
+      explicit State(size_t iterations) : remaining_(iterations),
+        iterations_(iterations) {}
+
+      bool keep_running() {
+        if (remaining_ == 0) {
+          return false;
+        }
+        remaining_--;
+        return true;
+      }
+
+      size_t iterations() const { return iterations_; }
+
+    private:
+      size_t remaining_;
+      size_t iterations_;
+  };
+
+  using BenchmarkFunction = void (*)(State&);
+
+  struct Options
+  {
+    size_t repetitions = 10;
+    double min_time_ms = 20.0;
+    double warmup_ms = 50.0;
+    // Only run benchmarks whose name contains this.
+    std::string filter;
+    // Also collect hardware counters, if they're available.
+    bool perf_counters = false;
+  };
+
+  // Every time is in nanoseconds per iteration.
+  struct Result
+  {
+    std::string name;
+    size_t iterations;
+    double median;
+    double mad;
+    double min;
+    double max;
+    std::vector<double> samples;
+    // Hardware counts per iteration, averaged over every repetition. Only
+    // valid with Options::perf_counters (and if the counters are available).
+    PerfCounters::Sample counters;
+  };
+
+  bool register_benchmark(const char* name, BenchmarkFunction fn);
+
+  // Run a single benchmark.
+  Result run(const char* name, BenchmarkFunction fn, const Options& options);
+
+  // Run every registered benchmark that matches 'options.filter'.
+  std::vector<Result> run_all(const Options& options);
+
+  void write_table(std::ostream& out, const std::vector<Result>& results);
+  void write_csv(std::ostream& out, const std::vector<Result>& results);
+  void write_json(std::ostream& out, const std::vector<Result>& results);
+
+  /**
+   * @brief Read results back in from the output of write_json(). Only the
+   * name, iterations, median_ns, mad_ns, min_ns, max_ns, samples_ns and
+   * counters fields are used, anything else is ignored. Throws
+   * std::runtime_error if the input isn't valid JSON.
+   */
+  std::vector<Result> read_json(std::istream& in);
+
+  /**
+   * @brief If 'arg' is "<flag>=<value>", store the value and return true. For
+   * tools that add flags of their own to the ones below.
+   */
+  bool parse_flag(const char* arg, const char* flag, std::string& value);
+
+  /**
+   * @brief If 'arg' is one of the options below, store it in 'options' and
+   * return true:
+   *   --filter=<substring>   only run matching benchmarks
+   *   --repetitions=<n>      timed repetitions per benchmark
+   *   --min-time-ms=<ms>     minimum duration of one repetition
+   *   --warmup-ms=<ms>       untimed running before the repetitions
+   *   --perf-counters        also collect hardware counters
+   */
+  bool parse_option(const char* arg, Options& options);
+
+  /**
+   * @brief The body of BENCHMARK_MAIN(). Understands every parse_option() flag
+   * as well as:
+   *   --format=table|csv|json
+   *   --out=<file>           write results to a file instead of stdout
+   *
+   * Returns 0 on success and 1 on a bad argument.
+   */
+  int run_main(int argc, char** argv);
+}
@@ -0,0 +1,254 @@
+/*
+ * Binary structured logging for our Logger.
+ *
+ * Formatting a log message as text usually costs far more than the logging
+ * itself, and most of the resulting bytes (the format string) are identical
+ * from one message to the next. In binary mode:
+ *
+ * 1. Every call site registers its format string ONCE (the first time it
+ *    runs) and gets back a small integer id.
+ * 2. Each log call only writes a compact record into a buffer: the format id, a
+ *    timestamp and the raw bytes of each (numeric) argument.
+ * 3. Turning the records back into text happens offline, in the
+ *    binary_log_decode tool (tools/binary_log_decode.cpp).
+ *
+ *   std::ofstream file("app.binlog", std::ios::binary);
+ *   BinaryLogWriter writer(file);
+ *   Logger logger(Logger::INFO);
+ *   logger.set_binary_writer(&writer);
+ *   LOG_BINARY(logger, Logger::INFO, "loaded {} cities in {} ms", n, ms);
+ *
+ * Without a binary writer, LOG_BINARY formats the message and falls back to the
+ * Logger's regular text output.
+ *
+ * File layout (all numbers are in the writer's native byte order):
+ *   header:  "CHLOG" + a version byte
+ *   format:  'F', u32 id, u8 level, u32 length, the format string
+ *   message: 'M', u32 id, u64 timestamp (ns since the epoch), u8 argument
+ *            count, then for each argument a u8 type tag and its raw bytes
+ */
+#pragma once
+
+#include "log.h"
+
+#include <chrono>
+// Include to get 'size_t'
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Log a message in binary mode. 'format' must be a string literal (or
+ * otherwise live forever) and uses "{}" as the placeholder for each argument.
+ * Arguments must be integers or floating point numbers.
+ */
+#define LOG_BINARY(logger, level, format, ...)                                 \
+  do {                                                                         \
+    if constexpr ((level) <= Logger::kCompiledLevel) {                         \
+      if ((logger).is_enabled(level)) {                                        \
+        static const uint32_t binary_log_format_id =                           \
+          BinaryLogFormats::register_format((level), (format));                \
+        write_binary((logger), binary_log_format_id, ##__VA_ARGS__);           \
+      }                                                                        \
+    }                                                                          \
+  } while (0)
+
+namespace binary_log
+{
+  constexpr char kMagic[] = { 'C', 'H', 'L', 'O', 'G' };
+  constexpr uint8_t kVersion = 1;
+
+  enum RecordType : uint8_t
+  {
+    FORMAT = 'F',
+    MESSAGE = 'M'
+  };
+
+  // An argument's type tag holds its kind in the high nibble and its size in
+  // bytes in the low nibble, so the decoder can read arguments of any size.
+  enum ArgKind : uint8_t
+  {
+    SIGNED = 1,
+    UNSIGNED = 2,
+    FLOATING = 3
+  };
+
+  template<typename T>
+  constexpr uint8_t arg_tag() {
+    static_assert(std::is_arithmetic_v<T>,
+      "binary log arguments must be integers or floating point numbers.");
+    static_assert(sizeof(T) <= 8, "binary log arguments are at most 8 bytes.");
+    uint8_t kind = std::is_floating_point_v<T> ? FLOATING :
+      std::is_signed_v<T> ? SIGNED : UNSIGNED;
+    return static_cast<uint8_t>(kind << 4 | sizeof(T));
+  }
+
+  // The number of bytes 'args' take up in a message record.
+  template<typename... Args>
+  constexpr size_t encoded_size() {
+    return (0 + ... + (1 + sizeof(Args)));
+  }
+
+  template<typename... Args>
+  char* encode_args(char* out, const Args&... args) {
+    ((*out++ = static_cast<char>(arg_tag<Args>()),
+      std::memcpy(out, &args, sizeof(Args)), out += sizeof(Args)), ...);
+    return out;
+  }
+
+  /**
+   * @brief Replace each "{}" in 'format' with the next of the 'n_args' encoded
+   * arguments starting at 'args', and append the result to 'out'. Returns a
+   * pointer just past the arguments that were read.
+   */
+  const char* format_args(const std::string& format, size_t n_args,
+    const char* args, std::string& out);
+}
+
+/**
+ * @brief The process-wide table of registered format strings. Registration
+ * takes a lock, but only happens once per call site.
+ */
+class BinaryLogFormats
+{
+  public:
+    struct Format
+    {
+      Logger::LogLevel level;
+      std::string text;
+    };
+
+    static uint32_t register_format(Logger::LogLevel level, const char* text);
+
+    // The returned reference stays valid forever, formats are never removed.
+    static const Format& get(uint32_t id);
+
+  private:
+    static std::mutex& _mutex();
+    // A deque, so that adding a format never moves the existing ones.
+    static std::deque<Format>& _formats();
+};
+
+/**
+ * @brief Writes binary log records into a buffer, and the buffer into 'out'
+ * whenever it fills up (and on flush() or destruction).
+ *
+ * NOTE: A writer is NOT thread-safe, give each thread its own writer (and its
+ * own file) or wrap it in a lock.
+ */
+class BinaryLogWriter
+{
+  public:
+    explicit BinaryLogWriter(std::ostream& out, size_t buffer_size = 64 * 1024);
+    ~BinaryLogWriter();
+
+    BinaryLogWriter(const BinaryLogWriter& other) = delete;
+    BinaryLogWriter& operator=(const BinaryLogWriter& other) = delete;
+
+    template<typename... Args>
+    void write(uint32_t format_id, const Args&... args) {
+      static_assert(sizeof...(Args) < 256, "too many binary log arguments.");
+      if (format_id >= defined_.size() || !defined_[format_id]) {
+        _define_format(format_id);
+      }
+
+      constexpr size_t kHeaderSize = 1 + 4 + 8 + 1;
+      constexpr size_t kRecordSize =
+        kHeaderSize + binary_log::encoded_size<Args...>();
+      char* out = _reserve(kRecordSize);
+
+      uint64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+      uint8_t n_args = sizeof...(Args);
+      *out++ = binary_log::MESSAGE;
+      std::memcpy(out, &format_id, 4);
+      std::memcpy(out + 4, &timestamp, 8);
+      std::memcpy(out + 12, &n_args, 1);
+      binary_log::encode_args(out + 13, args...);
+    }
+
+    // Write everything that's buffered to the output stream.
+    void flush();
+
+  private:
+    // Returns space for 'n_bytes' at the end of the buffer.
+    char* _reserve(size_t n_bytes) {
+      if (size_ + n_bytes > buffer_.size()) {
+        flush();
+        if (n_bytes > buffer_.size()) {
+          buffer_.resize(n_bytes);
+        }
+      }
+      char* out = buffer_.data() + size_;
+      size_ += n_bytes;
+      return out;
+    }
+
+    void _define_format(uint32_t format_id);
+
+    std::ostream& out_;
+    std::vector<char> buffer_;
+    size_t size_{0};
+    // Which formats have already been written to THIS output.
+    std::vector<bool> defined_;
+};
+
+/**
+ * @brief Reads the output of a BinaryLogWriter back in, one message at a time.
+ */
+class BinaryLogReader
+{
+  public:
+    struct Message
+    {
+      Logger::LogLevel level;
+      uint64_t timestamp;
+      std::string text;
+    };
+
+    // Throws std::runtime_error if 'in' doesn't start with a binary log header.
+    explicit BinaryLogReader(std::istream& in);
+
+    /**
+     * @brief Read the next message into 'message'. Returns false at the end of
+     * the input. Throws std::runtime_error if the input is corrupt.
+     */
+    bool next(Message& message);
+
+  private:
+    std::istream& in_;
+    std::unordered_map<uint32_t, BinaryLogFormats::Format> formats_;
+    std::vector<char> args_;
+};
+
+/**
+ * @brief Write a message to the logger's binary writer, or format it as text
+ * if it doesn't have one. Used by LOG_BINARY, which checks the log level.
+ */
+template<typename... Args>
+void write_binary(Logger& logger, uint32_t format_id, const Args&... args) {
+  if (BinaryLogWriter* writer = logger.binary_writer()) {
+    writer->write(format_id, args...);
+    return;
+  }
+
+  // Encode the arguments exactly as the writer would, so that the text comes
+  // out the same as it would from the decoder.
+  char encoded[binary_log::encoded_size<Args...>() + 1];
+  binary_log::encode_args(encoded, args...);
+  const BinaryLogFormats::Format& format = BinaryLogFormats::get(format_id);
+  std::string text;
+  binary_log::format_args(format.text, sizeof...(Args), encoded, text);
+  switch (format.level) {
+    case Logger::ERROR: logger.error(text.c_str()); break;
+    case Logger::WARNING: logger.warn(text.c_str()); break;
+    case Logger::INFO: logger.info(text.c_str()); break;
+  }
+}
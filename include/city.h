@@ -0,0 +1,51 @@
+/*
+ * The CityRecord from Video #100 (Maps), shared by the apps and benchmarks
+ * that store, load and search cities.
+ */
+#pragma once
+
+// Include to get 'size_t'
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+struct CityRecord
+{
+  std::string name;
+  uint64_t population;
+  double latitude;
+  double longitude;
+
+  // To use a CityRecord as the key in a std::map (an ordered map), we need to
+  // implement the less than operator so that two elements of the map can be
+  // compared. Note that both the lhs and rhs of the comparison need to be
+  // marked as const.
+  // The less than operator not only plays the role of comparison for an ordered
+  // map, it also defines a unique key within the map. So in this case, if two
+  // cities have the same population, then this can cause problems.
+  // What problems?
+  bool operator<(const CityRecord& other) const {
+    return population < other.population;
+  }
+};
+
+// Define a "template specialization" for std::hash within the std namespace
+// that is "specialized" by the type (CityRecord) that we'll use as the map's
+// key.
+namespace std
+{
+  // A template "specialization" uses an empty template argument
+  template<>
+  struct hash<CityRecord>
+  {
+    // Overload the call operator and return a 64 bit uint (size_t). Note that
+    // the standard containers call the hash through a const reference, so the
+    // call operator must be const.
+    size_t operator()(const CityRecord& key) const
+    {
+      // Define the hash function here.
+      return hash<std::string>()(key.name);
+    }
+  };
+}
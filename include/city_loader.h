@@ -0,0 +1,111 @@
+/*
+ * Bulk loading CityRecords (see city.h) from CSV files with rows of
+ *
+ *   name,population,latitude,longitude
+ *
+ * e.g. "Berlin,5000000,52.52,13.405". An optional first line that starts with
+ * "name," is a header and skipped. Names may be double-quoted (to contain
+ * commas), with "" for a literal quote. Both "\n" and "\r\n" line endings work.
+ */
+#pragma once
+
+#include "city.h"
+#include "flat_hash_map.h"
+#include "thread_pool.h"
+
+// Include to get 'size_t'
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief A read-only view of a whole file, memory-mapped where possible (so
+ * the kernel pages it in on demand, with no copy into a buffer of our own).
+ * Throws std::runtime_error if the file can't be opened.
+ */
+class MappedFile
+{
+  public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile& operator=(const MappedFile& other) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    std::string_view view() const { return std::string_view(data_, size_); }
+
+  private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    // Where memory-mapping isn't available, we read the file into this.
+    std::vector<char> buffer_;
+    bool mapped_ = false;
+};
+
+namespace city_csv
+{
+  /**
+   * @brief Parse every row of 'text' (the contents of a CSV file) into
+   * CityRecords, appending them to 'cities'. Numbers are parsed in place with
+   * std::from_chars, so the only allocations are for the names (and none at
+   * all for names short enough for std::string's small-string buffer).
+   *
+   * Throws std::runtime_error on a malformed row, naming its byte offset
+   * within 'text' plus 'offset'.
+   */
+  void parse(std::string_view text, std::vector<CityRecord>& cities,
+    size_t offset = 0);
+
+  /**
+   * @brief Same, but writes the rows to 'cities', which must have room for
+   * max_rows(text) records. Returns the number of rows written.
+   */
+  size_t parse(std::string_view text, CityRecord* cities, size_t offset = 0);
+
+  // The most rows 'text' can hold, i.e. its number of lines.
+  size_t max_rows(std::string_view text);
+
+  /**
+   * @brief Split 'text' into about 'n_chunks' pieces that each end at the end
+   * of a line. Returns the n + 1 boundaries (offsets into 'text').
+   */
+  std::vector<size_t> split_lines(std::string_view text, size_t n_chunks);
+
+  /**
+   * @brief Write 'n_rows' random cities, with a header line, e.g. for
+   * benchmarks. The same 'seed' gives the same cities (with the same standard
+   * library).
+   */
+  void write_synthetic(std::ostream& out, size_t n_rows, uint32_t seed = 42);
+}
+
+/**
+ * @brief Load every CityRecord in the CSV file at 'path'. The file is memory
+ * mapped and split into chunks at line boundaries. Counting the lines of each
+ * chunk tells us where its rows go, so that the chunks can be parsed in
+ * parallel on 'pool' (the calling thread helps) straight into one vector
+ * that's allocated once.
+ *
+ *   ThreadPool pool;
+ *   std::vector<CityRecord> cities = load_cities_csv("data/cities.csv", pool);
+ *
+ * Throws std::runtime_error if the file can't be read or has a malformed row.
+ */
+std::vector<CityRecord> load_cities_csv(const std::string& path,
+  ThreadPool& pool);
+
+// Same, parsing on the calling thread only.
+std::vector<CityRecord> load_cities_csv(const std::string& path);
+
+/**
+ * @brief Build a map from city name to CityRecord, sized for all of 'cities'
+ * up front so that it never grows (and never moves its elements) while being
+ * built. If a name appears more than once, the first record wins.
+ */
+FlatHashMap<std::string, CityRecord> build_city_map(
+  std::vector<CityRecord>&& cities);
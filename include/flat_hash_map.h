@@ -0,0 +1,690 @@
+/*
+ * An open-addressing ("flat") hash map in the style of Google's Swiss tables.
+ */
+#pragma once
+
+// Include to get 'size_t'
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+  #include <emmintrin.h>
+  #define FLAT_HASH_MAP_HAS_SSE2 1
+#else
+  #define FLAT_HASH_MAP_HAS_SSE2 0
+#endif
+
+namespace flat_hash_detail
+{
+  // Every slot has a one byte "control byte" that's either one of these, or
+  // (if the slot is full) the low 7 bits of the key's hash, "H2". The high bit
+  // is only set for the empty and deleted markers.
+  constexpr int8_t kEmpty = -128;  // 0b10000000
+  constexpr int8_t kDeleted = -2;  // 0b11111110
+
+  // The control bytes are probed 16 at a time, i.e. one SSE2 register.
+  constexpr size_t kGroupSize = 16;
+
+  /**
+   * @brief The control bytes of one group of slots. Each match returns a
+   * bitmask with bit 'i' set if slot 'i' of the group matches.
+   */
+  class Group
+  {
+    public:
+      explicit Group(const int8_t* ctrl) {
+#if FLAT_HASH_MAP_HAS_SSE2
+        ctrl_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+        std::memcpy(ctrl_, ctrl, kGroupSize);
+#endif
+      }
+
+      // Full slots whose H2 equals 'h2'.
+      uint32_t match(int8_t h2) const {
+#if FLAT_HASH_MAP_HAS_SSE2
+        return static_cast<uint32_t>(
+          _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_)));
+#else
+        return _match_scalar([h2](int8_t ctrl) { return ctrl == h2; });
+#endif
+      }
+
+      uint32_t match_empty() const { return match(kEmpty); }
+
+      // Empty or deleted, i.e. the high bit is set.
+      uint32_t match_free() const {
+#if FLAT_HASH_MAP_HAS_SSE2
+        return static_cast<uint32_t>(_mm_movemask_epi8(ctrl_));
+#else
+        return _match_scalar([](int8_t ctrl) { return ctrl < 0; });
+#endif
+      }
+
+    private:
+#if FLAT_HASH_MAP_HAS_SSE2
+      __m128i ctrl_;
+#else
+      template<typename Predicate>
+      uint32_t _match_scalar(Predicate predicate) const {
+        uint32_t mask = 0;
+        for (size_t idx = 0; idx < kGroupSize; idx++) {
+          mask |= static_cast<uint32_t>(predicate(ctrl_[idx])) << idx;
+        }
+        return mask;
+      }
+
+      int8_t ctrl_[kGroupSize];
+#endif
+  };
+
+  // The index of the lowest set bit. 'mask' must not be zero.
+  inline size_t lowest_bit(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_ctz(mask));
+#else
+    size_t idx = 0;
+    while ((mask & 1) == 0) {
+      mask >>= 1;
+      idx++;
+    }
+    return idx;
+#endif
+  }
+
+  /**
+   * @brief Many std::hash implementations return integers unchanged, which
+   * would leave H2 (the low 7 bits) nearly constant for keys like 0, 128,
+   * 256, ... so spread every bit of the hash over every other bit first. (The
+   * finalizer of MurmurHash3.)
+   */
+  inline uint64_t mix(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+  }
+
+  /**
+   * @brief Hashes std::strings, string_views and C strings the same way, so
+   * that a FlatHashMap<std::string, ...> can be searched without building a
+   * std::string for the key.
+   */
+  struct StringHash
+  {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view key) const {
+      return std::hash<std::string_view>()(key);
+    }
+  };
+
+  template<typename Key>
+  struct DefaultHash : std::hash<Key> {};
+
+  template<>
+  struct DefaultHash<std::string> : StringHash {};
+
+  template<typename T, typename = void>
+  struct IsTransparent : std::false_type {};
+
+  template<typename T>
+  struct IsTransparent<T, std::void_t<typename T::is_transparent>>
+    : std::true_type {};
+}
+
+/**
+ * @brief A hash map that stores its elements directly in one flat array
+ * instead of one heap-allocated node per element (like std::unordered_map).
+ *
+ *   FlatHashMap<std::string, CityRecord> cities;
+ *   cities["Berlin"] = {"Berlin", 5'000'000, 2.4, 9.4};
+ *   std::string_view name = "Berlin";
+ *   auto it = cities.find(name);  // No std::string is built for the lookup.
+ *
+ * Alongside the slots is an array of one byte "control bytes", one per slot,
+ * that hold 7 bits of each key's hash (or mark the slot empty/deleted). A
+ * lookup hashes the key once, picks a group of 16 slots, and compares all 16
+ * control bytes against the key's 7 hash bits with a couple of SSE2
+ * instructions. Only the (usually zero or one) slots whose bits match need a
+ * real key comparison, and if the group has an empty slot, the key isn't in
+ * the map. Otherwise, we move on to another group (quadratic probing).
+ *
+ * The API mirrors std::unordered_map: find, contains, count, at, operator[],
+ * insert, emplace, try_emplace, insert_or_assign, erase, reserve, and
+ * iteration. Lookup and erase also take any key type that 'Hash' and 'Equal'
+ * accept if both are "transparent" (have an 'is_transparent' member type),
+ * like the default ones for std::string keys.
+ *
+ * NOTE: Unlike std::unordered_map:
+ * - Inserting may move elements, which invalidates every iterator, pointer and
+ *   reference into the map (erasing only invalidates the erased element's).
+ * - The elements are std::pair<Key, Value>, not std::pair<const Key, Value>,
+ *   so that they can be moved when the table grows. Don't modify a key through
+ *   an iterator.
+ *
+ * @tparam Key
+ * @tparam Value
+ * @tparam Hash
+ * @tparam Equal
+ */
+template<typename Key, typename Value,
+  typename Hash = flat_hash_detail::DefaultHash<Key>,
+  typename Equal = std::equal_to<>>
+class FlatHashMap
+{
+  private:
+    // Heterogeneous lookup needs both the hash and the equality to accept
+    // other key types.
+    template<typename K>
+    static constexpr bool kTransparent =
+      flat_hash_detail::IsTransparent<Hash>::value &&
+      flat_hash_detail::IsTransparent<Equal>::value;
+
+    static constexpr size_t kNotFound = static_cast<size_t>(-1);
+
+  public:
+    using KeyType = Key;
+    using MappedType = Value;
+    using ValueType = std::pair<Key, Value>;
+
+    template<bool IsConst>
+    class IteratorBase
+    {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ValueType;
+        using difference_type = std::ptrdiff_t;
+        using pointer =
+          std::conditional_t<IsConst, const ValueType*, ValueType*>;
+        using reference =
+          std::conditional_t<IsConst, const ValueType&, ValueType&>;
+
+        IteratorBase() = default;
+
+        // Allow converting an Iterator to a ConstIterator (not vice versa).
+        template<bool OtherIsConst,
+          typename = std::enable_if_t<IsConst && !OtherIsConst>>
+        IteratorBase(const IteratorBase<OtherIsConst>& other)
+          : ctrl_(other.ctrl_), slot_(other.slot_), end_(other.end_) {}
+
+        reference operator*() const { return *slot_; }
+        pointer operator->() const { return slot_; }
+
+        IteratorBase& operator++() {
+          ctrl_++;
+          slot_++;
+          _skip_free();
+          return *this;
+        }
+
+        IteratorBase operator++(int) {
+          IteratorBase iterator = *this;
+          ++(*this);
+          return iterator;
+        }
+
+        bool operator==(const IteratorBase& other) const {
+          return slot_ == other.slot_;
+        }
+        bool operator!=(const IteratorBase& other) const {
+          return !(*this == other);
+        }
+
+      private:
+        friend class FlatHashMap;
+        friend class IteratorBase<!IsConst>;
+
+        IteratorBase(const int8_t* ctrl, pointer slot, const int8_t* end)
+          : ctrl_(ctrl), slot_(slot), end_(end) {}
+
+        // Move forward to the next full slot (or the end).
+        void _skip_free() {
+          while (ctrl_ != end_ && *ctrl_ < 0) {
+            ctrl_++;
+            slot_++;
+          }
+        }
+
+        const int8_t* ctrl_ = nullptr;
+        pointer slot_ = nullptr;
+        const int8_t* end_ = nullptr;
+    };
+
+    using Iterator = IteratorBase<false>;
+    using ConstIterator = IteratorBase<true>;
+
+    FlatHashMap() = default;
+
+    FlatHashMap(const FlatHashMap& other)
+      : hash_(other.hash_), equal_(other.equal_) {
+      reserve(other.size_);
+      for (const ValueType& element : other) {
+        _insert_unique(element);
+      }
+    }
+
+    FlatHashMap(FlatHashMap&& other) noexcept
+      : hash_(std::move(other.hash_)), equal_(std::move(other.equal_)) {
+      _steal(other);
+    }
+
+    FlatHashMap& operator=(const FlatHashMap& other) {
+      if (this != &other) {
+        FlatHashMap copy(other);
+        *this = std::move(copy);
+      }
+      return *this;
+    }
+
+    FlatHashMap& operator=(FlatHashMap&& other) noexcept {
+      if (this != &other) {
+        _destroy();
+        hash_ = std::move(other.hash_);
+        equal_ = std::move(other.equal_);
+        _steal(other);
+      }
+      return *this;
+    }
+
+    ~FlatHashMap() { _destroy(); }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    // The number of slots (full or not).
+    size_t capacity() const { return capacity_; }
+    float load_factor() const {
+      return capacity_ == 0 ? 0.0f : static_cast<float>(size_) / capacity_;
+    }
+
+    Iterator begin() {
+      Iterator iterator(ctrl_, slots_, ctrl_ + capacity_);
+      iterator._skip_free();
+      return iterator;
+    }
+    Iterator end() {
+      return Iterator(ctrl_ + capacity_, slots_ + capacity_, ctrl_ + capacity_);
+    }
+    ConstIterator begin() const {
+      return const_cast<FlatHashMap*>(this)->begin();
+    }
+    ConstIterator end() const { return const_cast<FlatHashMap*>(this)->end(); }
+
+    // Destroys every element, but keeps the memory.
+    void clear() {
+      for (size_t idx = 0; idx < capacity_; idx++) {
+        if (ctrl_[idx] >= 0) {
+          slots_[idx].~ValueType();
+        }
+      }
+      if (capacity_ > 0) {
+        std::memset(ctrl_, flat_hash_detail::kEmpty, capacity_);
+      }
+      size_ = 0;
+      growth_left_ = _max_load(capacity_);
+    }
+
+    // Make room for at least 'n' elements without growing again.
+    void reserve(size_t n) {
+      size_t capacity = flat_hash_detail::kGroupSize;
+      while (_max_load(capacity) < n) {
+        capacity *= 2;
+      }
+      if (capacity > capacity_) {
+        _rehash(capacity);
+      }
+    }
+
+    Iterator find(const Key& key) { return _iterator_at(_find(key)); }
+    ConstIterator find(const Key& key) const {
+      return const_cast<FlatHashMap*>(this)->find(key);
+    }
+
+    // Heterogeneous lookup, e.g. a std::string_view in a map of std::strings.
+    template<typename K, typename = std::enable_if_t<kTransparent<K>>>
+    Iterator find(const K& key) { return _iterator_at(_find(key)); }
+    template<typename K, typename = std::enable_if_t<kTransparent<K>>>
+    ConstIterator find(const K& key) const {
+      return const_cast<FlatHashMap*>(this)->find(key);
+    }
+
+    bool contains(const Key& key) const { return _find(key) != kNotFound; }
+    template<typename K, typename = std::enable_if_t<kTransparent<K>>>
+    bool contains(const K& key) const { return _find(key) != kNotFound; }
+
+    size_t count(const Key& key) const { return contains(key) ? 1 : 0; }
+    template<typename K, typename = std::enable_if_t<kTransparent<K>>>
+    size_t count(const K& key) const { return contains(key) ? 1 : 0; }
+
+    // Throws std::out_of_range if the key isn't in the map.
+    Value& at(const Key& key) { return _at(key); }
+    const Value& at(const Key& key) const {
+      return const_cast<FlatHashMap*>(this)->_at(key);
+    }
+    template<typename K, typename = std::enable_if_t<kTransparent<K>>>
+    Value& at(const K& key) { return _at(key); }
+    template<typename K, typename = std::enable_if_t<kTransparent<K>>>
+    const Value& at(const K& key) const {
+      return const_cast<FlatHashMap*>(this)->_at(key);
+    }
+
+    // Default-constructs the value if the key isn't in the map yet.
+    Value& operator[](const Key& key) { return try_emplace(key).first->second; }
+    Value& operator[](Key&& key) {
+      return try_emplace(std::move(key)).first->second;
+    }
+
+    /**
+     * @brief Insert an element unless its key is already in the map.
+     *
+     * @return An iterator to the element with that key, and true if it was
+     * inserted (false if the key was already there).
+     */
+    std::pair<Iterator, bool> insert(const ValueType& element) {
+      return try_emplace(element.first, element.second);
+    }
+    std::pair<Iterator, bool> insert(ValueType&& element) {
+      return try_emplace(std::move(element.first), std::move(element.second));
+    }
+
+    template<typename... Args>
+    std::pair<Iterator, bool> emplace(Args&&... args) {
+      ValueType element(std::forward<Args>(args)...);
+      return insert(std::move(element));
+    }
+
+    // Unlike emplace(), only constructs the value if the key is new.
+    template<typename K, typename... Args>
+    std::pair<Iterator, bool> try_emplace(K&& key, Args&&... args) {
+      const size_t hash = _hash(key);
+      auto [idx, inserted] = _find_or_prepare_insert(key, hash);
+      if (inserted) {
+        new(&slots_[idx]) ValueType(std::piecewise_construct,
+          std::forward_as_tuple(std::forward<K>(key)),
+          std::forward_as_tuple(std::forward<Args>(args)...));
+        _occupy(idx, hash);
+      }
+      return {_iterator_at(idx), inserted};
+    }
+
+    template<typename K, typename V>
+    std::pair<Iterator, bool> insert_or_assign(K&& key, V&& value) {
+      auto result = try_emplace(std::forward<K>(key), std::forward<V>(value));
+      if (!result.second) {
+        result.first->second = std::forward<V>(value);
+      }
+      return result;
+    }
+
+    // Returns the number of elements erased (0 or 1).
+    size_t erase(const Key& key) { return _erase_key(key); }
+    template<typename K, typename = std::enable_if_t<kTransparent<K>>>
+    size_t erase(const K& key) { return _erase_key(key); }
+
+    // Returns an iterator to the element after the erased one.
+    Iterator erase(ConstIterator position) {
+      size_t idx = static_cast<size_t>(position.slot_ - slots_);
+      _erase_at(idx);
+      Iterator next(ctrl_ + idx, slots_ + idx, ctrl_ + capacity_);
+      next._skip_free();
+      return next;
+    }
+    Iterator erase(Iterator position) {
+      return erase(ConstIterator(position));
+    }
+
+  private:
+    // Grow once the table is 7/8 full (counting deleted slots). Probing stays
+    // cheap at that load because whole groups are checked at once.
+    static size_t _max_load(size_t capacity) {
+      return capacity - capacity / 8;
+    }
+
+    template<typename K>
+    size_t _hash(const K& key) const {
+      return static_cast<size_t>(flat_hash_detail::mix(hash_(key)));
+    }
+
+    // The low 7 bits go in the control byte, the rest pick the first group.
+    static int8_t _h2(size_t hash) { return static_cast<int8_t>(hash & 0x7f); }
+    size_t _first_group(size_t hash) const {
+      return (hash >> 7) & (capacity_ / flat_hash_detail::kGroupSize - 1);
+    }
+
+    /**
+     * @brief Calls visit(group_start) for each group in 'hash's probe
+     * sequence, until it returns true. Probes groups 0, 1, 3, 6, 10, ... past
+     * the first one ("triangular" numbers), which visits every group exactly
+     * once when the number of groups is a power of 2.
+     */
+    template<typename Visit>
+    void _probe(size_t hash, Visit visit) const {
+      const size_t mask = capacity_ / flat_hash_detail::kGroupSize - 1;
+      size_t group = _first_group(hash);
+      for (size_t step = 1; ; step++) {
+        if (visit(group * flat_hash_detail::kGroupSize)) {
+          return;
+        }
+        group = (group + step) & mask;
+      }
+    }
+
+    template<typename K>
+    size_t _find(const K& key) const {
+      return size_ == 0 ? kNotFound : _find(key, _hash(key));
+    }
+
+    template<typename K>
+    size_t _find(const K& key, size_t hash) const {
+      if (size_ == 0) {
+        return kNotFound;
+      }
+      const int8_t h2 = _h2(hash);
+      size_t result = kNotFound;
+      _probe(hash, [&](size_t start) {
+        flat_hash_detail::Group group(ctrl_ + start);
+        for (uint32_t match = group.match(h2); match != 0;
+             match &= match - 1) {
+          size_t idx = start + flat_hash_detail::lowest_bit(match);
+          if (equal_(slots_[idx].first, key)) {
+            result = idx;
+            return true;
+          }
+        }
+        // An empty slot ends the search: an insert would have used it.
+        return group.match_empty() != 0;
+      });
+      return result;
+    }
+
+    // The first empty or deleted slot in 'hash's probe sequence.
+    size_t _find_free(size_t hash) const {
+      size_t result = kNotFound;
+      _probe(hash, [&](size_t start) {
+        uint32_t free = flat_hash_detail::Group(ctrl_ + start).match_free();
+        if (free != 0) {
+          result = start + flat_hash_detail::lowest_bit(free);
+          return true;
+        }
+        return false;
+      });
+      return result;
+    }
+
+    /**
+     * @brief Find 'key', or the slot to construct it in if it isn't in the map
+     * (growing the table if need be). The caller must then construct the
+     * element and call _occupy().
+     */
+    template<typename K>
+    std::pair<size_t, bool> _find_or_prepare_insert(const K& key,
+      size_t hash) {
+      size_t found = _find(key, hash);
+      if (found != kNotFound) {
+        return {found, false};
+      }
+      // Reusing a deleted slot doesn't use up any of our growth, so only grow
+      // if we'd take an empty one.
+      if (capacity_ == 0) {
+        _grow();
+      }
+      size_t idx = _find_free(hash);
+      if (growth_left_ == 0 && ctrl_[idx] == flat_hash_detail::kEmpty) {
+        _grow();
+        idx = _find_free(hash);
+      }
+      return {idx, true};
+    }
+
+    void _occupy(size_t idx, size_t hash) {
+      if (ctrl_[idx] == flat_hash_detail::kEmpty) {
+        growth_left_--;
+      }
+      ctrl_[idx] = _h2(hash);
+      size_++;
+    }
+
+    // Only for keys that are known not to be in the map (e.g. when copying).
+    void _insert_unique(const ValueType& element) {
+      size_t hash = _hash(element.first);
+      size_t idx = _find_free(hash);
+      new(&slots_[idx]) ValueType(element);
+      _occupy(idx, hash);
+    }
+
+    template<typename K>
+    Value& _at(const K& key) {
+      size_t idx = _find(key);
+      if (idx == kNotFound) {
+        throw std::out_of_range("FlatHashMap::at(): key not found");
+      }
+      return slots_[idx].second;
+    }
+
+    template<typename K>
+    size_t _erase_key(const K& key) {
+      size_t idx = _find(key);
+      if (idx == kNotFound) {
+        return 0;
+      }
+      _erase_at(idx);
+      return 1;
+    }
+
+    void _erase_at(size_t idx) {
+      slots_[idx].~ValueType();
+      size_--;
+      // A search only moves past a group if the group has no empty slots. If
+      // this group already has one, no search can have moved past it, so the
+      // slot can go straight back to empty. Otherwise, leave a "tombstone" so
+      // that searches still probe past it.
+      size_t start = idx & ~(flat_hash_detail::kGroupSize - 1);
+      if (flat_hash_detail::Group(ctrl_ + start).match_empty() != 0) {
+        ctrl_[idx] = flat_hash_detail::kEmpty;
+        growth_left_++;
+      }
+      else {
+        ctrl_[idx] = flat_hash_detail::kDeleted;
+      }
+    }
+
+    Iterator _iterator_at(size_t idx) {
+      if (idx == kNotFound) {
+        return end();
+      }
+      return Iterator(ctrl_ + idx, slots_ + idx, ctrl_ + capacity_);
+    }
+
+    // Called when there's no room left. If most of the used up room is
+    // tombstones, rebuilding the table at the same size is enough.
+    void _grow() {
+      if (capacity_ == 0) {
+        _rehash(flat_hash_detail::kGroupSize);
+      }
+      else if (size_ <= _max_load(capacity_) / 2) {
+        _rehash(capacity_);
+      }
+      else {
+        _rehash(capacity_ * 2);
+      }
+    }
+
+    // Move every element into a new table of 'new_capacity' slots (a power of
+    // 2, and at least one group).
+    void _rehash(size_t new_capacity) {
+      int8_t* old_ctrl = ctrl_;
+      ValueType* old_slots = slots_;
+      size_t old_capacity = capacity_;
+
+      ctrl_ = new int8_t[new_capacity];
+      std::memset(ctrl_, flat_hash_detail::kEmpty, new_capacity);
+      slots_ = std::allocator<ValueType>().allocate(new_capacity);
+      capacity_ = new_capacity;
+      growth_left_ = _max_load(new_capacity) - size_;
+
+      for (size_t idx = 0; idx < old_capacity; idx++) {
+        if (old_ctrl[idx] < 0) {
+          continue;
+        }
+        size_t hash = _hash(old_slots[idx].first);
+        size_t new_idx = _find_free(hash);
+        new(&slots_[new_idx]) ValueType(std::move(old_slots[idx]));
+        ctrl_[new_idx] = _h2(hash);
+        old_slots[idx].~ValueType();
+      }
+
+      if (old_capacity > 0) {
+        std::allocator<ValueType>().deallocate(old_slots, old_capacity);
+        delete[] old_ctrl;
+      }
+    }
+
+    void _destroy() {
+      if (capacity_ == 0) {
+        return;
+      }
+      clear();
+      std::allocator<ValueType>().deallocate(slots_, capacity_);
+      delete[] ctrl_;
+      ctrl_ = nullptr;
+      slots_ = nullptr;
+      capacity_ = 0;
+      growth_left_ = 0;
+    }
+
+    // Take 'other's table, leaving it empty. We must not own a table.
+    void _steal(FlatHashMap& other) {
+      ctrl_ = other.ctrl_;
+      slots_ = other.slots_;
+      capacity_ = other.capacity_;
+      size_ = other.size_;
+      growth_left_ = other.growth_left_;
+      other.ctrl_ = nullptr;
+      other.slots_ = nullptr;
+      other.capacity_ = 0;
+      other.size_ = 0;
+      other.growth_left_ = 0;
+    }
+
+    int8_t* ctrl_ = nullptr;
+    ValueType* slots_ = nullptr;
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+    // How many more elements fit before we have to grow (or clean up
+    // tombstones).
+    size_t growth_left_ = 0;
+    Hash hash_;
+    Equal equal_;
+};
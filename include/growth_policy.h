@@ -0,0 +1,118 @@
+/*
+ * Growth policies for our custom Vector container.
+ *
+ * When a Vector runs out of room it asks its growth policy for a new capacity.
+ * A policy is any type with a static function:
+ *
+ *   static size_t grow(size_t capacity, size_t min_capacity,
+ *     size_t element_size);
+ *
+ * that returns a capacity (in elements) of at least 'min_capacity'. Growing by
+ * a larger factor means fewer reallocations but more wasted memory.
+ */
+#pragma once
+
+#include <algorithm>
+// Include to get 'size_t'
+#include <cstddef>
+
+namespace growth
+{
+  // The very first allocation reserves at least a cache line worth of
+  // elements, rather than starting at 1 or 2 and reallocating over and over.
+  constexpr size_t kCacheLineSize = 64;
+
+  constexpr size_t kPageSize = 4096;
+
+  inline size_t first_capacity(size_t min_capacity, size_t element_size) {
+    return std::max(min_capacity,
+      std::max<size_t>(1, kCacheLineSize / element_size));
+  }
+
+  // Rounds 'value' up to the next multiple of 'multiple'.
+  inline size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+  }
+}
+
+/**
+ * @brief Grow by half the current capacity (1.5x). This is what Vector has
+ * always done, and it's also what MSVC's std::vector does.
+ */
+struct GrowHalf
+{
+  static size_t grow(size_t capacity, size_t min_capacity,
+    size_t element_size) {
+    if (capacity == 0) {
+      return growth::first_capacity(min_capacity, element_size);
+    }
+    return std::max(capacity + capacity / 2, min_capacity);
+  }
+};
+
+/**
+ * @brief Double the current capacity (2x), like libstdc++ and libc++.
+ */
+struct GrowDouble
+{
+  static size_t grow(size_t capacity, size_t min_capacity,
+    size_t element_size) {
+    if (capacity == 0) {
+      return growth::first_capacity(min_capacity, element_size);
+    }
+    return std::max(capacity * 2, min_capacity);
+  }
+};
+
+/**
+ * @brief Grow by 1.5x, then round the allocation up to a whole number of
+ * pages once it's bigger than a page. Large blocks are served a page at a
+ * time anyway, so the rounding hands us capacity that would otherwise be
+ * wasted.
+ */
+struct GrowPageRounded
+{
+  static size_t grow(size_t capacity, size_t min_capacity,
+    size_t element_size) {
+    size_t elements = GrowHalf::grow(capacity, min_capacity, element_size);
+    size_t bytes = elements * element_size;
+    if (bytes <= growth::kPageSize) {
+      return elements;
+    }
+    return growth::round_up(bytes, growth::kPageSize) / element_size;
+  }
+};
+
+/**
+ * @brief Grow by 1.5x, then round the allocation up to the next jemalloc (and
+ * tcmalloc-like) "size class". Requests that fall between two size classes are
+ * rounded up by the allocator anyway, so we might as well use the slack.
+ *
+ * The size classes are spaced 16 bytes apart up to 128 bytes, then there are
+ * four classes per doubling: 160, 192, 224, 256, 320, 384, 448, 512, ...
+ */
+struct GrowSizeClass
+{
+  static size_t size_class(size_t bytes) {
+    if (bytes <= 16) {
+      return growth::round_up(std::max<size_t>(bytes, 1), 8);
+    }
+    if (bytes <= 128) {
+      return growth::round_up(bytes, 16);
+    }
+
+    // Find the power of two just below 'bytes' and round up to a quarter of
+    // it.
+    size_t power = 128;
+    while (power * 2 < bytes) {
+      power *= 2;
+    }
+    return growth::round_up(bytes, power / 4);
+  }
+
+  static size_t grow(size_t capacity, size_t min_capacity,
+    size_t element_size) {
+    size_t elements = GrowHalf::grow(capacity, min_capacity, element_size);
+    return size_class(elements * element_size) / element_size;
+  }
+};
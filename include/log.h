@@ -5,6 +5,34 @@
 // #define _LOG_H
 
 #include <iostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// The most verbose log level that is compiled into the program at all (0 =
+// ERROR, 1 = WARNING, 2 = INFO). Logging calls above this level compile to
+// nothing, including building their message, so e.g. INFO logging costs
+// NOTHING in a build configured with -DLOG_COMPILE_LEVEL=WARNING. Set via the
+// LOG_COMPILE_LEVEL option in CMakeLists.txt, and defaults to keeping
+// everything.
+#ifndef LOG_COMPILE_LEVEL
+  #define LOG_COMPILE_LEVEL 2
+#endif
+
+// Log a message that is expensive to build, e.g.
+//
+//   LOG_INFO(logger, "loaded " + std::to_string(n) + " cities");
+//
+// The message expression is only evaluated if the level is both compiled in
+// and enabled at runtime.
+#define LOG_ERROR(logger, message) (logger).error([&]() { return (message); })
+#define LOG_WARN(logger, message) (logger).warn([&]() { return (message); })
+#define LOG_INFO(logger, message) (logger).info([&]() { return (message); })
+
+// Defined in async_log.h
+class AsyncLogBackend;
+// Defined in binary_log.h
+class BinaryLogWriter;
 
 void log(const char*);
 
@@ -39,15 +67,68 @@ class Logger
 
     void set_level(LogLevel log_level);
 
+    // Hand messages off to an asynchronous backend instead of writing them to
+    // std::cout on the calling thread. Pass nullptr to go back to std::cout.
+    void set_async_backend(AsyncLogBackend* backend);
+
+    // Messages logged with LOG_BINARY (see binary_log.h) go to 'writer' as
+    // binary records. Pass nullptr to format them as text instead.
+    void set_binary_writer(BinaryLogWriter* writer) { binary_writer_ = writer; }
+    BinaryLogWriter* binary_writer() const { return binary_writer_; }
+
+    // The level set by LOG_COMPILE_LEVEL.
+    static constexpr LogLevel kCompiledLevel =
+      static_cast<LogLevel>(LOG_COMPILE_LEVEL);
+
+    // True if a message at 'log_level' would actually be written.
+    bool is_enabled(LogLevel log_level) const {
+      return log_level <= kCompiledLevel && log_level_ >= log_level;
+    }
+
     // Using const char* in place of strings for now.
-    void error(const char* message);
-    void warn(const char* message);
-    void info(const char* message);
+    void error(const char* message) { _log<ERROR>(message); }
+    void warn(const char* message) { _log<WARNING>(message); }
+    void info(const char* message) { _log<INFO>(message); }
+
+    // Lazy versions: 'make_message' returns a const char* or a std::string and
+    // is only called if the message is going to be written.
+    template<typename MessageFn,
+      typename = std::enable_if_t<std::is_invocable_v<MessageFn&>>>
+    void error(MessageFn&& make_message) { _log<ERROR>(make_message); }
+    template<typename MessageFn,
+      typename = std::enable_if_t<std::is_invocable_v<MessageFn&>>>
+    void warn(MessageFn&& make_message) { _log<WARNING>(make_message); }
+    template<typename MessageFn,
+      typename = std::enable_if_t<std::is_invocable_v<MessageFn&>>>
+    void info(MessageFn&& make_message) { _log<INFO>(make_message); }
 
   private:
+    // The compile-time check discards the whole call (and the runtime check)
+    // for levels that aren't compiled in.
+    template<LogLevel Level, typename Message>
+    void _log(Message& message) {
+      if constexpr (Level <= kCompiledLevel) {
+        if (log_level_ >= Level) {
+          if constexpr (std::is_invocable_v<Message&>) {
+            _write(Level, message());
+          }
+          else {
+            _write(Level, message);
+          }
+        }
+      }
+    }
+
+    void _write(LogLevel log_level, const char* message);
+    void _write(LogLevel log_level, const std::string& message) {
+      _write(log_level, message.c_str());
+    }
+
     // static methods (and also variables?) cannot access non-static variables
     // static LogLevel log_level_{log_level_info};
     LogLevel log_level_{ERROR};
+    AsyncLogBackend* async_backend_{nullptr};
+    BinaryLogWriter* binary_writer_{nullptr};
 };
 
 // #endif
\ No newline at end of file
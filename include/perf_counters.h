@@ -0,0 +1,111 @@
+/*
+ * Hardware performance counters, for when wall-clock time tells us THAT
+ * something is slow but not WHY. On Linux, we ask the kernel (through
+ * perf_event_open) to count, for the calling thread only:
+ *
+ * - CPU cycles and retired instructions: instructions per cycle (IPC) well
+ *   below 1 usually means the CPU is stalled waiting on memory.
+ * - Last-level cache misses: trips all the way out to RAM.
+ * - Branch mispredictions: each one throws away ~15-20 cycles of work.
+ *
+ * Counters are often unavailable: inside containers and VMs, when
+ * /proc/sys/kernel/perf_event_paranoid forbids it, or on other platforms. In
+ * that case every count comes back invalid and callers should fall back to
+ * reporting time only. PerfCounters::error() says why.
+ */
+#pragma once
+
+#include <chrono>
+// Include to get 'size_t'
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+class PerfCounters
+{
+  public:
+    enum Event
+    {
+      CYCLES = 0,
+      INSTRUCTIONS = 1,
+      CACHE_MISSES = 2,
+      BRANCH_MISSES = 3,
+      N_EVENTS = 4
+    };
+
+    // The counts between start() and stop(). Each event may be unavailable
+    // on its own (e.g. some VMs expose cycles but not cache misses).
+    struct Sample
+    {
+      double counts[N_EVENTS] = {};
+      bool valid[N_EVENTS] = {};
+
+      bool has(Event event) const { return valid[event]; }
+      double operator[](Event event) const { return counts[event]; }
+
+      // Instructions per cycle, or 0 if either count is missing.
+      double ipc() const {
+        return has(CYCLES) && has(INSTRUCTIONS) && counts[CYCLES] > 0.0 ?
+          counts[INSTRUCTIONS] / counts[CYCLES] : 0.0;
+      }
+
+      // Add up samples, e.g. from several repetitions.
+      Sample& operator+=(const Sample& other);
+      // Scale every count, e.g. to get counts per iteration.
+      Sample& operator/=(double divisor);
+    };
+
+    static const char* name(Event event);
+
+    // Opens the counters, but doesn't start them.
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters& other) = delete;
+    PerfCounters& operator=(const PerfCounters& other) = delete;
+
+    // True if at least one counter could be opened.
+    bool available() const;
+    // Why counters are unavailable (empty if they all opened).
+    const std::string& error() const { return error_; }
+
+    // Reset every counter to zero and start counting.
+    void start();
+    void stop();
+    // Read the counts. Call after stop().
+    Sample read() const;
+
+  private:
+    int fds_[N_EVENTS];
+    std::string error_;
+};
+
+/**
+ * @brief The scope-based Timer from utils.h, plus hardware counters. Prints
+ * the elapsed time and (if available) the counters when it goes out of scope:
+ *
+ *   {
+ *     PerfTimer timer(n);  // 'n' iterations, to also print counts per iteration
+ *     for (size_t i = 0; i < n; i++) { ... }
+ *   }
+ */
+class PerfTimer
+{
+  public:
+    explicit PerfTimer(size_t iterations = 1, std::ostream& out = std::cout);
+    ~PerfTimer();
+
+    PerfTimer(const PerfTimer& other) = delete;
+    PerfTimer& operator=(const PerfTimer& other) = delete;
+
+  private:
+    size_t iterations_;
+    std::ostream& out_;
+    PerfCounters counters_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Print a sample, e.g. "cycles: 1200, instructions: 3100 (IPC 2.58), ...".
+std::ostream& operator<<(std::ostream& stream,
+  const PerfCounters::Sample& sample);
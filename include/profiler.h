@@ -0,0 +1,226 @@
+/*
+ * A hierarchical, scope-based profiler. Think of ProfileScope as the Timer from
+ * utils.h, except that instead of printing, it records a named event that we
+ * can aggregate or export later:
+ *
+ *   void load_cities() {
+ *     PROFILE_FUNCTION();
+ *     ...
+ *     {
+ *       PROFILE_SCOPE("parse");
+ *       ...
+ *     }
+ *   }
+ *
+ *   Profiler::get().print_summary(std::cout);
+ *   std::ofstream trace("trace.json");
+ *   Profiler::get().write_chrome_trace(trace);
+ *
+ * The trace can be opened in chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Each thread records into its own fixed-size ring buffer of events, so
+ * recording a scope never takes a lock or allocates: it costs two reads of the
+ * CPU's timestamp counter (the steady clock on non-x86 CPUs) and a store. Once
+ * a thread has recorded kMaxEvents events, each new one overwrites the oldest,
+ * so a profiler left enabled in production uses a bounded amount of memory;
+ * the summary and the trace then cover each thread's latest kMaxEvents scopes.
+ * Build with the PROFILING option (see CMakeLists.txt) turned OFF, and
+ * PROFILE_SCOPE and PROFILE_FUNCTION compile to nothing.
+ */
+#pragma once
+
+#include <chrono>
+// Include to get 'size_t'
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  #include <intrin.h>
+  #define PROFILER_HAS_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+  #define PROFILER_HAS_RDTSC 1
+#else
+  #define PROFILER_HAS_RDTSC 0
+#endif
+
+#ifndef PROFILING_ENABLED
+  #define PROFILING_ENABLED 1
+#endif
+
+// Two levels of macros so that __LINE__ is expanded before it's pasted.
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#if PROFILING_ENABLED
+  // 'name' must be a string literal (or otherwise outlive the Profiler).
+  #define PROFILE_SCOPE(name) \
+    ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+  #define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#else
+  #define PROFILE_SCOPE(name)
+  #define PROFILE_FUNCTION()
+#endif
+
+class Profiler
+{
+  public:
+    // How many events each thread keeps. A power of two, so that the ring
+    // buffer index is a mask rather than a division.
+    static constexpr size_t kMaxEvents = size_t(1) << 15;
+
+    // One completed scope. Times are in ticks of Profiler::now().
+    struct Event
+    {
+      const char* name;
+      // The scope that this one was nested in, or nullptr at the top level.
+      const char* parent;
+      uint64_t start;
+      uint64_t end;
+      // How many scopes were already open on this thread.
+      uint32_t depth;
+    };
+
+    // Everything one thread has recorded.
+    struct ThreadProfile
+    {
+      uint32_t thread_id;
+      // The names of the scopes that are open on this thread, outermost
+      // first.
+      std::vector<const char*> stack;
+      // A ring buffer of the latest completed scopes, allocated up front.
+      std::vector<Event> events;
+      // Every event recorded since the last reset(), including those that
+      // have since been overwritten.
+      uint64_t n_recorded{0};
+
+      void record(const Event& event) {
+        events[n_recorded & (kMaxEvents - 1)] = event;
+        n_recorded++;
+      }
+
+      // Calls 'function' on each event that's still in the buffer, oldest
+      // first.
+      template<typename Function>
+      void for_each_event(Function function) const {
+        uint64_t first = n_recorded > kMaxEvents ? n_recorded - kMaxEvents : 0;
+        for (uint64_t idx = first; idx < n_recorded; idx++) {
+          function(events[idx & (kMaxEvents - 1)]);
+        }
+      }
+    };
+
+    // Aggregated statistics for every scope with the same name. Times are in
+    // nanoseconds.
+    struct ScopeStats
+    {
+      std::string name;
+      size_t count;
+      uint64_t total;
+      uint64_t min;
+      uint64_t max;
+      uint64_t p50;
+      uint64_t p99;
+    };
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    static Profiler& get() {
+      static Profiler instance;
+      return instance;
+    }
+
+    /**
+     * @brief The current time in "ticks". Reading the steady clock can take
+     * 20-40 ns (more in a VM), so on x86 we read the timestamp counter instead
+     * and only convert ticks to nanoseconds when reporting.
+     */
+    static uint64_t now() {
+#if PROFILER_HAS_RDTSC
+      return __rdtsc();
+#else
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    // The calling thread's profile, created the first time a thread asks.
+    ThreadProfile& this_thread() {
+      thread_local ThreadProfile* profile = nullptr;
+      if (!profile) {
+        profile = _register_thread();
+      }
+      return *profile;
+    }
+
+    /**
+     * NOTE: The functions below read every thread's events, so only call them
+     * once the profiled threads have finished (or are otherwise paused).
+     */
+
+    // Per-name statistics, sorted by total time (largest first).
+    std::vector<ScopeStats> summary() const;
+    void print_summary(std::ostream& out) const;
+
+    // Export every event in Chrome's trace-event JSON format.
+    void write_chrome_trace(std::ostream& out) const;
+
+    // How many events were overwritten before they could be reported.
+    uint64_t n_dropped() const;
+
+    // Throw away every recorded event.
+    void reset();
+
+  private:
+    Profiler();
+
+    ThreadProfile* _register_thread();
+
+    // Calibrates ticks against the steady clock since the Profiler was created.
+    double _ns_per_tick() const;
+
+    uint64_t origin_ticks_;
+    std::chrono::steady_clock::time_point origin_time_;
+
+    // Profiles are owned here (rather than by the thread_local) so that the
+    // events of threads that have exited are kept.
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadProfile>> threads_;
+};
+
+/**
+ * @brief Records the time between its construction and destruction as a
+ * Profiler event. Use through PROFILE_SCOPE, so that it can be compiled out.
+ */
+class ProfileScope
+{
+  public:
+    explicit ProfileScope(const char* name)
+      : name_(name), thread_(Profiler::get().this_thread()) {
+      thread_.stack.push_back(name_);
+      start_ = Profiler::now();
+    }
+
+    ~ProfileScope() {
+      uint64_t end = Profiler::now();
+      thread_.stack.pop_back();
+      const char* parent = thread_.stack.empty() ? nullptr :
+        thread_.stack.back();
+      thread_.record({ name_, parent, start_, end,
+        static_cast<uint32_t>(thread_.stack.size()) });
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+  private:
+    const char* name_;
+    Profiler::ThreadProfile& thread_;
+    uint64_t start_;
+};
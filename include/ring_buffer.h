@@ -0,0 +1,144 @@
+/*
+ * A bounded, lock-free ring buffer (queue) for passing items between threads.
+ */
+#pragma once
+
+#include <atomic>
+// Include to get 'size_t'
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/**
+ * @brief A fixed-capacity, lock-free FIFO queue based on Dmitry Vyukov's
+ * "bounded MPMC queue".
+ *
+ * Each slot carries a sequence number that tells producers and consumers
+ * whether the slot is ready to be written or read, so threads only ever
+ * contend on a single atomic counter (one for each end of the queue) and never
+ * take a lock. Any number of threads may push and any number of threads may
+ * pop, although the common use-case is many producers and a single consumer.
+ *
+ * Instead of copying items in and out, push and pop take a callable that fills
+ * in (or reads out of) the slot in-place.
+ *
+ * @tparam T Must be default constructible. Ideally a small, trivially copyable
+ * type, because every slot is constructed up front.
+ */
+template<typename T>
+class RingBuffer
+{
+  public:
+    // The capacity is rounded up to a power of two so that we can use a mask
+    // instead of a (slow) modulo to find a slot.
+    explicit RingBuffer(size_t capacity) {
+      size_t rounded = 2;
+      while (rounded < capacity) {
+        rounded *= 2;
+      }
+      mask_ = rounded - 1;
+      slots_ = std::make_unique<Slot[]>(rounded);
+      for (size_t idx = 0; idx < rounded; idx++) {
+        slots_[idx].sequence.store(idx, std::memory_order_relaxed);
+      }
+    }
+
+    RingBuffer(const RingBuffer& other) = delete;
+    RingBuffer& operator=(const RingBuffer& other) = delete;
+
+    /**
+     * @brief Claims a free slot and calls fill(T&) to write the item into it.
+     * Returns false (without calling 'fill') if the queue is full.
+     */
+    template<typename Fill>
+    bool try_push(Fill fill) {
+      size_t pos = head_.load(std::memory_order_relaxed);
+      Slot* slot;
+      while (true) {
+        slot = &slots_[pos & mask_];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) -
+          static_cast<intptr_t>(pos);
+        if (diff == 0) {
+          // The slot is free. Try to claim it by bumping the head.
+          if (head_.compare_exchange_weak(pos, pos + 1,
+              std::memory_order_relaxed)) {
+            break;
+          }
+        }
+        else if (diff < 0) {
+          // The slot still holds an item from one "lap" ago, i.e. we're full.
+          return false;
+        }
+        else {
+          // Another producer got here first.
+          pos = head_.load(std::memory_order_relaxed);
+        }
+      }
+
+      fill(slot->value);
+      // Publish the item to consumers.
+      slot->sequence.store(pos + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * @brief Claims the oldest item and calls consume(T&) on it. Returns false
+     * (without calling 'consume') if the queue is empty.
+     */
+    template<typename Consume>
+    bool try_pop(Consume consume) {
+      size_t pos = tail_.load(std::memory_order_relaxed);
+      Slot* slot;
+      while (true) {
+        slot = &slots_[pos & mask_];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) -
+          static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+          if (tail_.compare_exchange_weak(pos, pos + 1,
+              std::memory_order_relaxed)) {
+            break;
+          }
+        }
+        else if (diff < 0) {
+          // Nothing has been published to this slot yet, i.e. we're empty.
+          return false;
+        }
+        else {
+          pos = tail_.load(std::memory_order_relaxed);
+        }
+      }
+
+      consume(slot->value);
+      // Hand the slot back to producers for the next lap.
+      slot->sequence.store(pos + mask_ + 1, std::memory_order_release);
+      return true;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+    // Only a snapshot, other threads may be pushing and popping concurrently.
+    bool empty() const {
+      return head_.load(std::memory_order_acquire) ==
+        tail_.load(std::memory_order_acquire);
+    }
+
+  private:
+    // Keep each slot (and each counter below) on its own cache line so that
+    // threads working on neighbouring slots don't invalidate each other's
+    // caches ("false sharing").
+    struct alignas(64) Slot
+    {
+      std::atomic<size_t> sequence;
+      T value;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+
+    // Producers advance the head, consumers advance the tail.
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+};
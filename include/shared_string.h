@@ -0,0 +1,173 @@
+/*
+ * A reference-counted, copy-on-write string.
+ */
+#pragma once
+
+#include "traits.h"
+
+#include <atomic>
+// Include to get 'size_t'
+#include <cstddef>
+#include <iostream>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * @brief A string whose copies share one heap buffer instead of each getting a
+ * deep copy of it (compare String's copy constructor in types.h). Copying a
+ * SharedString just bumps an atomic reference count, whatever its length, and
+ * the buffer is freed when the last copy goes away.
+ *
+ * substr() is O(1) too: the substring is a view into its parent's buffer, and
+ * keeps that buffer alive for as long as it needs it.
+ *
+ * Reading never copies anything. Writing through the non-const operator[]
+ * first makes a private copy of the characters if anybody else can see them
+ * ("copy-on-write"), so a copy can never be changed behind your back:
+ *
+ *   SharedString a = "Cherno";
+ *   SharedString b = a;   // No allocation: a and b share "Cherno".
+ *   b[2] = 'a';           // b gets its own "Charno", a is still "Cherno".
+ *
+ * NOTE: Like std::string_view, a SharedString isn't null-terminated (a substring
+ * ends wherever its parent's next character is), so there's no c_str().
+ *
+ * NOTE: Calling the non-const operator[] just to *read* a character still
+ * unshares the string. Read through a const SharedString (or view()) instead.
+ * And don't hold on to the returned reference across a copy: writing through
+ * it afterwards would change the copy too.
+ *
+ * Copies may be created and destroyed on different threads at the same time;
+ * as with any other type, a single SharedString must not be written while
+ * another thread uses it.
+ */
+class SharedString
+{
+  public:
+    SharedString() = default;
+    SharedString(const char* string) : SharedString(std::string_view(string)) {}
+    explicit SharedString(std::string_view string);
+
+    // O(1): share the other string's buffer.
+    SharedString(const SharedString& other) :
+      buffer_(other.buffer_), data_(other.data_), size_(other.size_) {
+      _acquire();
+    }
+
+    SharedString(SharedString&& other) noexcept :
+      buffer_(other.buffer_), data_(other.data_), size_(other.size_) {
+      other._reset();
+    }
+
+    SharedString& operator=(const SharedString& other) {
+      // Acquire first, so that assigning a string to itself (or to another
+      // view of the same buffer) can't free the buffer out from under us.
+      other._acquire();
+      _release();
+      buffer_ = other.buffer_;
+      data_ = other.data_;
+      size_ = other.size_;
+      return *this;
+    }
+
+    SharedString& operator=(SharedString&& other) noexcept {
+      if (this != &other) {
+        _release();
+        buffer_ = other.buffer_;
+        data_ = other.data_;
+        size_ = other.size_;
+        other._reset();
+      }
+      return *this;
+    }
+
+    ~SharedString() { _release(); }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const char* data() const { return data_; }
+    std::string_view view() const { return {data_, size_}; }
+    operator std::string_view() const { return view(); }
+
+    // Reading a character never copies.
+    const char& operator[](size_t index) const { return data_[index]; }
+
+    // Writing a character makes the characters private first (see above).
+    char& operator[](size_t index) {
+      if (is_shared()) {
+        _make_unique();
+      }
+      return const_cast<char*>(data_)[index];
+    }
+
+    /**
+     * @brief The (up to) 'count' characters starting at 'pos', sharing this
+     * string's buffer. 'pos' is clamped to size().
+     */
+    SharedString substr(size_t pos, size_t count = std::string_view::npos)
+      const;
+
+    // The number of SharedStrings (copies and substrings) using our buffer.
+    size_t use_count() const {
+      return buffer_ ? buffer_->refs.load(std::memory_order_acquire) : 0;
+    }
+    bool is_shared() const { return use_count() > 1; }
+
+  private:
+    // The reference count, followed by the characters themselves (in the same
+    // allocation).
+    struct Buffer
+    {
+      std::atomic<size_t> refs;
+
+      char* chars() { return reinterpret_cast<char*>(this + 1); }
+    };
+
+    // Increments don't need to synchronize with anything: whoever copies us
+    // already holds a reference.
+    void _acquire() const {
+      if (buffer_) {
+        buffer_->refs.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    // The last reference frees the buffer. acq_rel makes every other copy's
+    // reads of the characters "happen before" the free.
+    void _release() {
+      if (buffer_ && buffer_->refs.fetch_sub(1, std::memory_order_acq_rel) ==
+          1) {
+        _free(buffer_);
+      }
+    }
+    void _reset() {
+      buffer_ = nullptr;
+      data_ = "";
+      size_ = 0;
+    }
+
+    static Buffer* _allocate(std::string_view string);
+    static void _free(Buffer* buffer);
+    // Replace our (shared) characters with a private copy of them.
+    void _make_unique();
+
+    Buffer* buffer_{nullptr};
+    const char* data_{""};
+    size_t size_{0};
+};
+
+inline bool operator==(const SharedString& lhs, const SharedString& rhs) {
+  // Copies of each other can skip comparing the characters.
+  return (lhs.data() == rhs.data() && lhs.size() == rhs.size()) ||
+    lhs.view() == rhs.view();
+}
+inline bool operator!=(const SharedString& lhs, const SharedString& rhs) {
+  return !(lhs == rhs);
+}
+inline bool operator<(const SharedString& lhs, const SharedString& rhs) {
+  return lhs.view() < rhs.view();
+}
+
+std::ostream& operator<<(std::ostream& stream, const SharedString& string);
+
+// A SharedString only points to its buffer, never into itself.
+template<>
+struct is_trivially_relocatable<SharedString> : std::true_type {};
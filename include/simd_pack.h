@@ -0,0 +1,243 @@
+/*
+ * Thin wrappers around SIMD registers ("packs"), shared by the batch kernels in
+ * src/vec_math.cpp and src/vec3_soa.cpp.
+ *
+ * SimdPack is the widest pack the code is being compiled for: AvxPack with
+ * AVX2 (see ENABLE_AVX2 in CMakeLists.txt), SsePack on any other x86-64 build
+ * and ScalarPack everywhere else.
+ */
+#pragma once
+
+// Include to get 'size_t'
+#include <cstddef>
+#include <cmath>
+
+#include "vec_math.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace simd
+{
+  /*
+   * Each "pack" type wraps one register's worth of floats (1 for the scalar
+   * pack) and the handful of operations that the batch kernels need. The
+   * kernels are written once, against that interface, so the scalar and SIMD
+   * versions can't drift apart.
+   *
+   * load2/load3 read 'kWidth' consecutive Vec2s/Vec3s and split them into one
+   * pack of x's, one of y's (and one of z's), store2/store3 do the opposite.
+   */
+  struct ScalarPack
+  {
+    using V = float;
+    static constexpr size_t kWidth = 1;
+
+    static V load(const float* src) { return *src; }
+    static void store(float* dest, V value) { *dest = value; }
+    static V set1(float value) { return value; }
+
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V mul(V a, V b) { return a * b; }
+    static V div(V a, V b) { return a / b; }
+    static V min(V a, V b) { return math::min(a, b); }
+    static V max(V a, V b) { return math::max(a, b); }
+    static V sqrt(V a) { return std::sqrt(a); }
+    // 'value' where 'a' > 0, otherwise 0.
+    static V if_positive(V a, V value) { return a > 0.0f ? value : 0.0f; }
+
+    static void load2(const float* src, V& x, V& y) {
+      x = src[0];
+      y = src[1];
+    }
+    static void store2(float* dest, V x, V y) {
+      dest[0] = x;
+      dest[1] = y;
+    }
+    static void load3(const float* src, V& x, V& y, V& z) {
+      x = src[0];
+      y = src[1];
+      z = src[2];
+    }
+    static void store3(float* dest, V x, V y, V z) {
+      dest[0] = x;
+      dest[1] = y;
+      dest[2] = z;
+    }
+  };
+
+#if defined(__SSE2__)
+  struct SsePack
+  {
+    using V = __m128;
+    static constexpr size_t kWidth = 4;
+
+    static V load(const float* src) { return _mm_loadu_ps(src); }
+    static void store(float* dest, V value) { _mm_storeu_ps(dest, value); }
+    static V set1(float value) { return _mm_set1_ps(value); }
+
+    static V add(V a, V b) { return _mm_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm_div_ps(a, b); }
+    static V min(V a, V b) { return _mm_min_ps(a, b); }
+    static V max(V a, V b) { return _mm_max_ps(a, b); }
+    static V sqrt(V a) { return _mm_sqrt_ps(a); }
+    static V if_positive(V a, V value) {
+      return _mm_and_ps(_mm_cmpgt_ps(a, _mm_setzero_ps()), value);
+    }
+
+    // r0 = x0 y0 x1 y1, r1 = x2 y2 x3 y3
+    static void load2(const float* src, V& x, V& y) {
+      V r0 = _mm_loadu_ps(src);
+      V r1 = _mm_loadu_ps(src + 4);
+      x = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(2, 0, 2, 0));
+      y = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+    static void store2(float* dest, V x, V y) {
+      _mm_storeu_ps(dest, _mm_unpacklo_ps(x, y));
+      _mm_storeu_ps(dest + 4, _mm_unpackhi_ps(x, y));
+    }
+
+    // r0 = x0 y0 z0 x1, r1 = y1 z1 x2 y2, r2 = z2 x3 y3 z3
+    static void load3(const float* src, V& x, V& y, V& z) {
+      V r0 = _mm_loadu_ps(src);
+      V r1 = _mm_loadu_ps(src + 4);
+      V r2 = _mm_loadu_ps(src + 8);
+      x = _mm_shuffle_ps(r0, _mm_shuffle_ps(r1, r2, _MM_SHUFFLE(1, 1, 2, 2)),
+        _MM_SHUFFLE(2, 0, 3, 0));
+      y = _mm_shuffle_ps(_mm_shuffle_ps(r0, r1, _MM_SHUFFLE(0, 0, 1, 1)),
+        _mm_shuffle_ps(r1, r2, _MM_SHUFFLE(2, 2, 3, 3)),
+        _MM_SHUFFLE(2, 0, 2, 0));
+      z = _mm_shuffle_ps(_mm_shuffle_ps(r0, r1, _MM_SHUFFLE(1, 1, 2, 2)), r2,
+        _MM_SHUFFLE(3, 0, 2, 0));
+    }
+    static void store3(float* dest, V x, V y, V z) {
+      _mm_storeu_ps(dest, _mm_shuffle_ps(
+        _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)),
+        _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)),
+        _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm_storeu_ps(dest + 4, _mm_shuffle_ps(
+        _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)),
+        _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)),
+        _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm_storeu_ps(dest + 8, _mm_shuffle_ps(
+        _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)),
+        _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)),
+        _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+  };
+#endif
+
+#if defined(__AVX2__)
+  /*
+   * The same as SsePack, 8 floats at a time. The shuffles only work within
+   * each 128-bit half of a register, so load2/load3 first arrange the input
+   * so that each half holds exactly what SsePack would see, e.g. for Vec3s:
+   *
+   *   r0 = | x0 y0 z0 x1 | x4 y4 z4 x5 |
+   *   r1 = | y1 z1 x2 y2 | y5 z5 x6 y6 |
+   *   r2 = | z2 x3 y3 z3 | z6 x7 y7 z7 |
+   *
+   * and store2/store3 undo that.
+   */
+  struct AvxPack
+  {
+    using V = __m256;
+    static constexpr size_t kWidth = 8;
+
+    static V load(const float* src) { return _mm256_loadu_ps(src); }
+    static void store(float* dest, V value) { _mm256_storeu_ps(dest, value); }
+    static V set1(float value) { return _mm256_set1_ps(value); }
+
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm256_div_ps(a, b); }
+    static V min(V a, V b) { return _mm256_min_ps(a, b); }
+    static V max(V a, V b) { return _mm256_max_ps(a, b); }
+    static V sqrt(V a) { return _mm256_sqrt_ps(a); }
+    static V if_positive(V a, V value) {
+      return _mm256_and_ps(
+        _mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_GT_OQ), value);
+    }
+
+    static void load2(const float* src, V& x, V& y) {
+      V l0 = _mm256_loadu_ps(src);
+      V l1 = _mm256_loadu_ps(src + 8);
+      V r0 = _mm256_permute2f128_ps(l0, l1, 0x20);
+      V r1 = _mm256_permute2f128_ps(l0, l1, 0x31);
+      x = _mm256_shuffle_ps(r0, r1, _MM_SHUFFLE(2, 0, 2, 0));
+      y = _mm256_shuffle_ps(r0, r1, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+    static void store2(float* dest, V x, V y) {
+      V lo = _mm256_unpacklo_ps(x, y);
+      V hi = _mm256_unpackhi_ps(x, y);
+      _mm256_storeu_ps(dest, _mm256_permute2f128_ps(lo, hi, 0x20));
+      _mm256_storeu_ps(dest + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+
+    static void load3(const float* src, V& x, V& y, V& z) {
+      V l0 = _mm256_loadu_ps(src);
+      V l1 = _mm256_loadu_ps(src + 8);
+      V l2 = _mm256_loadu_ps(src + 16);
+      V r0 = _mm256_permute2f128_ps(l0, l1, 0x30);
+      V r1 = _mm256_permute2f128_ps(l0, l2, 0x21);
+      V r2 = _mm256_permute2f128_ps(l1, l2, 0x30);
+      x = _mm256_shuffle_ps(r0,
+        _mm256_shuffle_ps(r1, r2, _MM_SHUFFLE(1, 1, 2, 2)),
+        _MM_SHUFFLE(2, 0, 3, 0));
+      y = _mm256_shuffle_ps(_mm256_shuffle_ps(r0, r1, _MM_SHUFFLE(0, 0, 1, 1)),
+        _mm256_shuffle_ps(r1, r2, _MM_SHUFFLE(2, 2, 3, 3)),
+        _MM_SHUFFLE(2, 0, 2, 0));
+      z = _mm256_shuffle_ps(_mm256_shuffle_ps(r0, r1, _MM_SHUFFLE(1, 1, 2, 2)),
+        r2, _MM_SHUFFLE(3, 0, 2, 0));
+    }
+    static void store3(float* dest, V x, V y, V z) {
+      V r0 = _mm256_shuffle_ps(
+        _mm256_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)),
+        _mm256_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)),
+        _MM_SHUFFLE(2, 0, 2, 0));
+      V r1 = _mm256_shuffle_ps(
+        _mm256_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)),
+        _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)),
+        _MM_SHUFFLE(2, 0, 2, 0));
+      V r2 = _mm256_shuffle_ps(
+        _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)),
+        _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)),
+        _MM_SHUFFLE(2, 0, 2, 0));
+      _mm256_storeu_ps(dest, _mm256_permute2f128_ps(r0, r1, 0x20));
+      _mm256_storeu_ps(dest + 8, _mm256_permute2f128_ps(r2, r0, 0x30));
+      _mm256_storeu_ps(dest + 16, _mm256_permute2f128_ps(r1, r2, 0x31));
+    }
+  };
+#endif
+
+#if defined(__AVX2__)
+  using SimdPack = AvxPack;
+  constexpr const char* kInstructionSet = "AVX2";
+#elif defined(__SSE2__)
+  using SimdPack = SsePack;
+  constexpr const char* kInstructionSet = "SSE";
+#else
+  using SimdPack = ScalarPack;
+  constexpr const char* kInstructionSet = "scalar";
+#endif
+
+  // Calls body(Pack(), idx) for each full pack of elements starting at idx,
+  // then body(ScalarPack(), idx) for the leftovers.
+  template<typename Pack, typename Body>
+  void for_each_pack(size_t n, Body body) {
+    size_t idx = 0;
+    if constexpr (Pack::kWidth > 1) {
+      for (; idx + Pack::kWidth <= n; idx += Pack::kWidth) {
+        body(Pack(), idx);
+      }
+    }
+    for (; idx < n; idx++) {
+      body(ScalarPack(), idx);
+    }
+  }
+}
@@ -0,0 +1,242 @@
+/*
+ * A string class with the "small string optimization" (SSO).
+ */
+#pragma once
+
+#include "traits.h"
+
+// Include to get 'size_t'
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * @brief A string that stores up to 23 characters "inline", i.e. inside the
+ * 24-byte SmallString object itself, and only allocates on the heap for longer
+ * strings. Most of the strings we deal with (names, keys, short messages) are
+ * that short, so creating, copying and destroying them never touches the heap.
+ *
+ * The two layouts share the same 24 bytes:
+ *
+ *   inline: | 23 chars (null-terminated)                   | 23 - size |
+ *   heap:   | char* data     | size_t size    | size_t capacity (+ flag) |
+ *
+ * The last byte tells them apart. Inline, it holds the number of unused
+ * characters, so a full 23-character string ends with a 0 byte there - which
+ * doubles as the null terminator. On the heap, its highest bit is set (and the
+ * capacity is stored in the remaining bits).
+ *
+ * Unlike String (see types.h), a SmallString is always null-terminated, so
+ * c_str() can be handed straight to C APIs.
+ */
+class SmallString
+{
+  public:
+    // The most characters (not counting the null terminator) stored inline.
+    static constexpr size_t kInlineCapacity = 23;
+
+    SmallString() { _set_inline_size(0); }
+    SmallString(const char* string) : SmallString(std::string_view(string)) {}
+    SmallString(const char* string, size_t size) :
+      SmallString(std::string_view(string, size)) {}
+    explicit SmallString(std::string_view string) { _assign(string); }
+
+    // Copying an inline string is just copying its 24 bytes.
+    SmallString(const SmallString& other) {
+      if (other.is_inline()) {
+        std::memcpy(bytes_, other.bytes_, sizeof(bytes_));
+      }
+      else {
+        _assign(other);
+      }
+    }
+
+    // Whichever layout 'other' uses, we can take its bytes as they are. That
+    // leaves 'other' as an empty (inline) string.
+    SmallString(SmallString&& other) noexcept {
+      std::memcpy(bytes_, other.bytes_, sizeof(bytes_));
+      other._set_inline_size(0);
+    }
+
+    SmallString& operator=(const SmallString& other) {
+      if (this != &other) {
+        if (other.is_inline()) {
+          _release();
+          std::memcpy(bytes_, other.bytes_, sizeof(bytes_));
+        }
+        else {
+          // Reuse our heap buffer if it's big enough.
+          clear();
+          append(other);
+        }
+      }
+      return *this;
+    }
+
+    SmallString& operator=(SmallString&& other) noexcept {
+      if (this != &other) {
+        _release();
+        std::memcpy(bytes_, other.bytes_, sizeof(bytes_));
+        other._set_inline_size(0);
+      }
+      return *this;
+    }
+
+    // (Via a temporary, in case 'string' points into this string.)
+    SmallString& operator=(std::string_view string) {
+      return *this = SmallString(string);
+    }
+    // Without this, 's = "abc"' would be ambiguous between the overloads above.
+    SmallString& operator=(const char* string) {
+      return *this = std::string_view(string);
+    }
+
+    ~SmallString() { _release(); }
+
+    // True if the characters are stored inside the object (no heap buffer).
+    bool is_inline() const { return (_tag() & kHeapFlag) == 0; }
+
+    size_t size() const {
+      return is_inline() ? kInlineCapacity - _tag() : heap_.size;
+    }
+    size_t capacity() const {
+      return is_inline() ? kInlineCapacity : _heap_capacity();
+    }
+    bool empty() const { return size() == 0; }
+
+    const char* data() const { return is_inline() ? bytes_ : heap_.data; }
+    char* data() { return is_inline() ? bytes_ : heap_.data; }
+    const char* c_str() const { return data(); }
+
+    // (Checks the layout once, rather than once in data() and again in size().)
+    operator std::string_view() const {
+      if (is_inline()) {
+        return {bytes_, kInlineCapacity - _tag()};
+      }
+      return {heap_.data, heap_.size};
+    }
+
+    // No bounds checking, just like std::string.
+    char& operator[](size_t index) { return data()[index]; }
+    const char& operator[](size_t index) const { return data()[index]; }
+
+    // Make room for at least 'new_capacity' characters.
+    void reserve(size_t new_capacity);
+
+    // Keeps any heap buffer, so that the string can be refilled for free.
+    void clear() { _set_size(0); }
+
+    /**
+     * @brief Add characters to the end of the string. Once the string outgrows
+     * its storage, the capacity (at least) doubles, so n appends only cost
+     * O(log n) allocations.
+     */
+    SmallString& append(std::string_view string);
+    SmallString& append(char character) {
+      size_t old_size = size();
+      if (old_size == capacity()) {
+        _grow(old_size + 1);
+      }
+      data()[old_size] = character;
+      _set_size(old_size + 1);
+      return *this;
+    }
+
+    void push_back(char character) { append(character); }
+    SmallString& operator+=(std::string_view string) { return append(string); }
+    SmallString& operator+=(char character) { return append(character); }
+
+    int compare(std::string_view other) const {
+      return std::string_view(*this).compare(other);
+    }
+
+  private:
+    // The highest bit of the last byte is set for heap strings.
+    static constexpr uint8_t kHeapFlag = 0x80;
+
+    struct Heap
+    {
+      char* data;
+      size_t size;
+      // The capacity, with the tag byte (the last of the 24) in it. See
+      // _heap_capacity().
+      size_t capacity_and_tag;
+    };
+
+    uint8_t _tag() const {
+      return static_cast<uint8_t>(bytes_[kInlineCapacity]);
+    }
+
+    // The tag byte is the most significant byte of 'capacity_and_tag' on a
+    // little-endian machine, and the least significant on a big-endian one.
+    size_t _heap_capacity() const {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      return heap_.capacity_and_tag >> 8;
+#else
+      return heap_.capacity_and_tag & (~size_t(0) >> 8);
+#endif
+    }
+    void _set_heap_capacity(size_t capacity) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      heap_.capacity_and_tag = (capacity << 8) | kHeapFlag;
+#else
+      heap_.capacity_and_tag =
+        capacity | (size_t(kHeapFlag) << (8 * (sizeof(size_t) - 1)));
+#endif
+    }
+
+    void _set_inline_size(size_t size) {
+      bytes_[size] = '\0';
+      bytes_[kInlineCapacity] = static_cast<char>(kInlineCapacity - size);
+    }
+
+    // Also writes the null terminator.
+    void _set_size(size_t size) {
+      if (is_inline()) {
+        _set_inline_size(size);
+      }
+      else {
+        heap_.size = size;
+        heap_.data[size] = '\0';
+      }
+    }
+
+    // Only called on a freshly constructed (uninitialized) SmallString.
+    void _assign(std::string_view string);
+    // Move the characters to a heap buffer of at least 'min_capacity', then
+    // append 'suffix' (which may point into the old buffer).
+    void _grow(size_t min_capacity, std::string_view suffix = {});
+    void _release() {
+      if (!is_inline()) {
+        delete[] heap_.data;
+      }
+    }
+
+    union
+    {
+      char bytes_[kInlineCapacity + 1];
+      Heap heap_;
+    };
+};
+
+static_assert(sizeof(SmallString) == 24, "SmallString should be 24 bytes.");
+
+inline bool operator==(const SmallString& lhs, const SmallString& rhs) {
+  return std::string_view(lhs) == std::string_view(rhs);
+}
+inline bool operator!=(const SmallString& lhs, const SmallString& rhs) {
+  return !(lhs == rhs);
+}
+inline bool operator<(const SmallString& lhs, const SmallString& rhs) {
+  return std::string_view(lhs) < std::string_view(rhs);
+}
+
+std::ostream& operator<<(std::ostream& stream, const SmallString& string);
+
+// SmallString never points into itself (data() is recomputed every time), so
+// it's safe to relocate it with memcpy.
+template<>
+struct is_trivially_relocatable<SmallString> : std::true_type {};
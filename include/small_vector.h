@@ -0,0 +1,214 @@
+#pragma once
+
+#include "traits.h"
+#include "vector.h"
+
+// Include to get 'size_t'
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+/**
+ * @brief A Vector that stores its first N elements "inline", i.e. inside the
+ * SmallVector object itself, and only spills to the heap once it grows past N
+ * elements. If most of your containers are small, this eliminates the bulk of
+ * the heap allocations.
+ *
+ * Supports the same push_back/emplace_back/pop_back/iterator API as Vector.
+ *
+ * NOTE: Unlike a heap-backed container, moving a SmallVector that hasn't
+ * spilled yet has to move each element, because the elements live inside the
+ * object being moved from.
+ *
+ * @tparam T
+ * @tparam N The number of elements stored inline.
+ * @tparam Allocator Used for the heap storage once we've spilled.
+ */
+template<typename T, size_t N, typename Allocator = std::allocator<T>>
+class SmallVector : private Allocator
+{
+  static_assert(N > 0, "SmallVector needs room for at least one element.");
+
+  public:
+    using ValueType = T;
+    using Iterator = VectorIterator<SmallVector<T, N, Allocator>>;
+    using ConstIterator = VectorIterator<const SmallVector<T, N, Allocator>>;
+
+  private:
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using PropagateOnMove =
+      typename AllocTraits::propagate_on_container_move_assignment;
+
+  public:
+    SmallVector() = default;
+    explicit SmallVector(const Allocator& allocator) : Allocator(allocator) {}
+
+    SmallVector(const SmallVector& other) : Allocator(other) {
+      _reserve(other.size_);
+      for (size_t idx = 0; idx < other.size_; idx++) {
+        new(&data_[idx]) T(other.data_[idx]);
+      }
+      size_ = other.size_;
+    }
+
+    SmallVector(SmallVector&& other) noexcept : Allocator(std::move(other)) {
+      _steal(other);
+    }
+
+    SmallVector& operator=(const SmallVector& other) {
+      if (this != &other) {
+        clear();
+        _reserve(other.size_);
+        for (size_t idx = 0; idx < other.size_; idx++) {
+          new(&data_[idx]) T(other.data_[idx]);
+        }
+        size_ = other.size_;
+      }
+      return *this;
+    }
+
+    // Only takes over 'other's heap block if our allocator can free it, i.e.
+    // if the allocator moves along with it or the two compare equal. Otherwise
+    // (e.g. PoolAllocators of two different Pools) the elements are relocated
+    // one by one into storage from our own allocator, which may throw.
+    SmallVector& operator=(SmallVector&& other) noexcept(
+      PropagateOnMove::value || AllocTraits::is_always_equal::value) {
+      if (this == &other) {
+        return *this;
+      }
+      clear();
+      if constexpr (PropagateOnMove::value) {
+        _release();
+        _allocator() = std::move(other._allocator());
+        _steal(other);
+      }
+      else if (_allocator() == other._allocator()) {
+        _release();
+        _steal(other);
+      }
+      else {
+        _reserve(other.size_);
+        relocate(other.data_, other.size_, data_);
+        size_ = other.size_;
+        other.size_ = 0;
+        other._release();
+      }
+      return *this;
+    }
+
+    ~SmallVector() {
+      clear();
+      _release();
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+
+    // Returns true if the elements are still stored inline.
+    bool is_inline() const { return data_ == _inline_data(); }
+
+    void push_back(const T& item) { emplace_back(item); }
+    void push_back(T&& item) { emplace_back(std::move(item)); }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+      if (size_ >= capacity_) {
+        return _grow_and_emplace_back(std::forward<Args>(args)...);
+      }
+      new(&data_[size_]) T(std::forward<Args>(args)...);
+      return data_[size_++];
+    }
+
+    void pop_back() {
+      if (size_ > 0) {
+        size_--;
+        data_[size_].~T();
+      }
+    }
+
+    void clear() {
+      for (size_t idx = 0; idx < size_; idx++) {
+        data_[idx].~T();
+      }
+      size_ = 0;
+    }
+
+    Iterator begin() { return Iterator(data_); }
+    Iterator end() { return Iterator(data_ + size_); }
+    ConstIterator begin() const { return ConstIterator(data_); }
+    ConstIterator end() const { return ConstIterator(data_ + size_); }
+
+    const T& operator[](size_t index) const { return data_[index]; }
+    T& operator[](size_t index) { return data_[index]; }
+
+  private:
+    Allocator& _allocator() { return *this; }
+
+    T* _inline_data() { return reinterpret_cast<T*>(inline_); }
+    const T* _inline_data() const {
+      return reinterpret_cast<const T*>(inline_);
+    }
+
+    // Grow the storage to hold at least 'new_capacity' elements. This is the
+    // only place that allocates, and it's only reached once we spill.
+    void _reserve(size_t new_capacity) {
+      if (new_capacity <= capacity_) {
+        return;
+      }
+      T* new_block = AllocTraits::allocate(*this, new_capacity);
+      relocate(data_, size_, new_block);
+      _release();
+      data_ = new_block;
+      capacity_ = new_capacity;
+    }
+
+    // Construct the new element in the new block BEFORE relocating the old
+    // elements, because 'args' may refer to one of them, e.g.
+    // vec.push_back(vec[0]).
+    template<typename... Args>
+    T& _grow_and_emplace_back(Args&&... args) {
+      size_t new_capacity = capacity_ * 2;
+      T* new_block = AllocTraits::allocate(*this, new_capacity);
+      new(&new_block[size_]) T(std::forward<Args>(args)...);
+      relocate(data_, size_, new_block);
+      _release();
+      data_ = new_block;
+      capacity_ = new_capacity;
+      return data_[size_++];
+    }
+
+    // Free the heap storage (if any) and go back to the inline buffer. The
+    // elements must already have been destroyed or relocated.
+    void _release() {
+      if (!is_inline()) {
+        AllocTraits::deallocate(*this, data_, capacity_);
+      }
+      data_ = _inline_data();
+      capacity_ = N;
+    }
+
+    // Take ownership of the elements of 'other' (which must be empty and
+    // inline on our side), leaving 'other' empty.
+    void _steal(SmallVector& other) {
+      if (other.is_inline()) {
+        relocate(other.data_, other.size_, data_);
+      }
+      else {
+        data_ = other.data_;
+        capacity_ = other.capacity_;
+        other.data_ = other._inline_data();
+        other.capacity_ = N;
+      }
+      size_ = other.size_;
+      other.size_ = 0;
+    }
+
+    // Raw, suitably aligned storage for the first N elements. Note that we
+    // can't use 'T inline_[N]' because that would construct N T's up front.
+    alignas(T) unsigned char inline_[N * sizeof(T)];
+
+    T* data_{_inline_data()};
+    size_t size_{0};
+    size_t capacity_{N};
+};
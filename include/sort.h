@@ -0,0 +1,316 @@
+/*
+ * Sorting algorithms for large batches of data. Everything here works on any
+ * random access range, e.g. our Vector, std::vector or a raw array.
+ *
+ * - radix_sort / radix_sort_by_key: an LSD radix sort for integer and floating
+ *   point keys. O(n) rather than O(n log n), but needs a buffer as big as the
+ *   input.
+ * - parallel_sort: sorts chunks of the input on a ThreadPool and then merges
+ *   them in parallel. Works with any comparator.
+ * - sort_by_key / parallel_sort_by_key: sort records by a member (or any other
+ *   "key" computed from a record), e.g.
+ *
+ *     sort_by_key(cities.begin(), cities.end(),
+ *       [](const CityRecord& city) { return city.population; });
+ */
+#pragma once
+
+#include "thread_pool.h"
+
+#include <algorithm>
+// Include to get 'size_t'
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace sort_detail
+{
+  /**
+   * @brief Maps an arithmetic key onto an unsigned integer with the same
+   * ordering, so that the radix sort can treat every key as plain bits.
+   *
+   * - Unsigned integers are already fine.
+   * - Signed integers: flip the sign bit so that negatives come first.
+   * - Floats: flip the sign bit of positives and ALL bits of negatives (larger
+   *   magnitude negatives must come first). NaNs with the sign bit set sort
+   *   first, all other NaNs sort last.
+   */
+  template<typename Key>
+  auto radix_bits(Key key) {
+    static_assert(std::is_arithmetic_v<Key>,
+      "radix sort keys must be integers or floating point numbers.");
+
+    if constexpr (std::is_floating_point_v<Key>) {
+      static_assert(sizeof(Key) == 4 || sizeof(Key) == 8,
+        "only float and double keys are supported.");
+      using Bits = std::conditional_t<sizeof(Key) == 4, uint32_t, uint64_t>;
+      Bits bits;
+      std::memcpy(&bits, &key, sizeof(Key));
+      const Bits sign = Bits(1) << (sizeof(Key) * 8 - 1);
+      return static_cast<Bits>((bits & sign) ? ~bits : (bits | sign));
+    }
+    else if constexpr (std::is_signed_v<Key>) {
+      using Bits = std::make_unsigned_t<Key>;
+      const Bits sign = Bits(1) << (sizeof(Key) * 8 - 1);
+      return static_cast<Bits>(static_cast<Bits>(key) ^ sign);
+    }
+    else {
+      return key;
+    }
+  }
+
+  // Below this many elements per chunk it's not worth waking up other threads.
+  constexpr size_t kMinParallelChunk = 16 * 1024;
+
+  /**
+   * @brief Merge the sorted runs [src_a, src_a + len_a) and [src_b, src_b +
+   * len_b) into 'dest', splitting the work into 'n_pieces' independent merges
+   * that are submitted to 'pool'. The futures are appended to 'pending'.
+   *
+   * Each piece starts at an evenly spaced element of run A and at the first
+   * element of run B that isn't less than it, so the pieces never overlap.
+   */
+  template<typename T, typename Compare>
+  void merge_in_pieces(ThreadPool& pool, T* src_a, size_t len_a, T* src_b,
+    size_t len_b, T* dest, size_t n_pieces, Compare comp,
+    std::vector<std::future<void>>& pending) {
+    size_t prev_a = 0;
+    size_t prev_b = 0;
+    for (size_t piece = 1; piece <= n_pieces; piece++) {
+      size_t next_a = piece == n_pieces ? len_a : len_a * piece / n_pieces;
+      size_t next_b = piece == n_pieces ? len_b :
+        std::lower_bound(src_b, src_b + len_b, src_a[next_a], comp) - src_b;
+      // lower_bound can only move forwards as next_a moves forwards, but be
+      // defensive about duplicate split points.
+      next_b = std::max(next_b, prev_b);
+
+      T* a_begin = src_a + prev_a;
+      T* a_end = src_a + next_a;
+      T* b_begin = src_b + prev_b;
+      T* b_end = src_b + next_b;
+      T* out = dest + prev_a + prev_b;
+      pending.push_back(pool.submit([=]() {
+        std::merge(std::make_move_iterator(a_begin),
+          std::make_move_iterator(a_end), std::make_move_iterator(b_begin),
+          std::make_move_iterator(b_end), out, comp);
+      }));
+
+      prev_a = next_a;
+      prev_b = next_b;
+    }
+  }
+}
+
+/**
+ * @brief Sorts [first, last) in ascending order of key(element) with a
+ * least-significant-digit radix sort (one pass per byte of the key). Passes
+ * where every key has the same byte are skipped, so e.g. sorting small
+ * integers stored in an int64_t only costs a couple of passes.
+ *
+ * The sort is stable. It needs a temporary buffer the size of the input, and
+ * the elements must be move-assignable.
+ *
+ * @tparam RandomIt A random access iterator.
+ * @tparam KeyFunction A callable returning an integer or floating point key.
+ */
+template<typename RandomIt, typename KeyFunction>
+void radix_sort_by_key(RandomIt first, RandomIt last, KeyFunction key) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  using Bits = decltype(sort_detail::radix_bits(key(*first)));
+  constexpr size_t kPasses = sizeof(Bits);
+  constexpr size_t kBuckets = 256;
+
+  const size_t n = last - first;
+  if (n < 2) {
+    return;
+  }
+
+  // Build the histogram for EVERY pass in a single read of the input.
+  std::vector<size_t> counts(kPasses * kBuckets, 0);
+  for (size_t idx = 0; idx < n; idx++) {
+    Bits bits = sort_detail::radix_bits(key(first[idx]));
+    for (size_t pass = 0; pass < kPasses; pass++) {
+      counts[pass * kBuckets + ((bits >> (8 * pass)) & 0xFF)]++;
+    }
+  }
+
+  // Ping-pong between the input and a buffer. Moving the input into the
+  // buffer first means T doesn't need a default constructor.
+  std::vector<T> buffer(std::make_move_iterator(first),
+    std::make_move_iterator(last));
+  bool in_buffer = true;
+
+  for (size_t pass = 0; pass < kPasses; pass++) {
+    size_t* count = &counts[pass * kBuckets];
+
+    // If every key has the same byte in this position, the pass would leave
+    // the order unchanged.
+    if (std::find(count, count + kBuckets, n) != count + kBuckets) {
+      continue;
+    }
+
+    // Turn the counts into the starting offset of each bucket.
+    size_t offset = 0;
+    for (size_t bucket = 0; bucket < kBuckets; bucket++) {
+      size_t bucket_count = count[bucket];
+      count[bucket] = offset;
+      offset += bucket_count;
+    }
+
+    // Scatter every element into its bucket.
+    const unsigned shift = 8 * pass;
+    if (in_buffer) {
+      for (size_t idx = 0; idx < n; idx++) {
+        Bits bits = sort_detail::radix_bits(key(buffer[idx]));
+        first[count[(bits >> shift) & 0xFF]++] = std::move(buffer[idx]);
+      }
+    }
+    else {
+      for (size_t idx = 0; idx < n; idx++) {
+        Bits bits = sort_detail::radix_bits(key(first[idx]));
+        buffer[count[(bits >> shift) & 0xFF]++] = std::move(first[idx]);
+      }
+    }
+    in_buffer = !in_buffer;
+  }
+
+  if (in_buffer) {
+    std::move(buffer.begin(), buffer.end(), first);
+  }
+}
+
+/**
+ * @brief Radix sort a range of integers or floating point numbers.
+ */
+template<typename RandomIt>
+void radix_sort(RandomIt first, RandomIt last) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  radix_sort_by_key(first, last, [](const T& value) { return value; });
+}
+
+/**
+ * @brief Sorts [first, last) with 'comp' using every worker of 'pool'.
+ *
+ * 1. Split the input into one chunk per worker and std::sort each chunk.
+ * 2. Merge pairs of sorted runs until one run is left. Once there are fewer
+ *    pairs than workers, each merge is itself split into several pieces so
+ *    that the final merges keep every worker busy.
+ *
+ * Needs a temporary buffer the size of the input. NOTE: This must not be
+ * called from a task running on the same pool.
+ *
+ * @tparam RandomIt A random access iterator over contiguous storage.
+ * @tparam Compare
+ */
+template<typename RandomIt, typename Compare>
+void parallel_sort(ThreadPool& pool, RandomIt first, RandomIt last,
+  Compare comp) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  const size_t n = last - first;
+  const size_t n_threads = pool.size();
+  size_t n_chunks = std::min(n_threads, n / sort_detail::kMinParallelChunk);
+  if (n_chunks <= 1) {
+    std::sort(first, last, comp);
+    return;
+  }
+
+  // 1. Sort each chunk in parallel. 'runs' holds the boundaries of the sorted
+  // runs, so run i is [runs[i], runs[i + 1]).
+  std::vector<size_t> runs(n_chunks + 1);
+  for (size_t chunk = 0; chunk <= n_chunks; chunk++) {
+    runs[chunk] = n * chunk / n_chunks;
+  }
+  std::vector<std::future<void>> pending;
+  for (size_t chunk = 0; chunk < n_chunks; chunk++) {
+    RandomIt chunk_first = first + runs[chunk];
+    RandomIt chunk_last = first + runs[chunk + 1];
+    pending.push_back(pool.submit([=]() {
+      std::sort(chunk_first, chunk_last, comp);
+    }));
+  }
+  for (std::future<void>& future : pending) {
+    future.get();
+  }
+
+  // 2. Merge pairs of runs, ping-ponging between the input and a buffer.
+  std::vector<T> buffer(std::make_move_iterator(first),
+    std::make_move_iterator(last));
+  T* src = buffer.data();
+  T* dest = &*first;
+  while (runs.size() > 2) {
+    size_t n_runs = runs.size() - 1;
+    size_t n_pairs = n_runs / 2;
+    size_t n_pieces = std::max<size_t>(1, n_threads / n_pairs);
+
+    pending.clear();
+    std::vector<size_t> merged_runs;
+    for (size_t pair = 0; pair < n_pairs; pair++) {
+      size_t begin = runs[2 * pair];
+      size_t middle = runs[2 * pair + 1];
+      size_t end = runs[2 * pair + 2];
+      sort_detail::merge_in_pieces(pool, src + begin, middle - begin,
+        src + middle, end - middle, dest + begin, n_pieces, comp, pending);
+      merged_runs.push_back(begin);
+    }
+    // An odd run out just moves across to the other side.
+    if (n_runs % 2 == 1) {
+      size_t begin = runs[n_runs - 1];
+      std::move(src + begin, src + n, dest + begin);
+      merged_runs.push_back(begin);
+    }
+    merged_runs.push_back(n);
+    for (std::future<void>& future : pending) {
+      future.get();
+    }
+
+    runs = std::move(merged_runs);
+    std::swap(src, dest);
+  }
+
+  // After the final swap, 'src' holds the sorted data.
+  if (src == buffer.data()) {
+    std::move(buffer.begin(), buffer.end(), first);
+  }
+}
+
+// Sort in ascending order with operator<.
+template<typename RandomIt>
+void parallel_sort(ThreadPool& pool, RandomIt first, RandomIt last) {
+  parallel_sort(pool, first, last, std::less<>());
+}
+
+/**
+ * @brief Sort records in ascending order of key(record). Integer and floating
+ * point keys use the radix sort, anything else (e.g. std::string) falls back to
+ * std::sort comparing keys with operator<.
+ *
+ * @tparam KeyFunction A callable taking a record and returning its key.
+ */
+template<typename RandomIt, typename KeyFunction>
+void sort_by_key(RandomIt first, RandomIt last, KeyFunction key) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  using Key = std::decay_t<std::invoke_result_t<KeyFunction, const T&>>;
+  if constexpr (std::is_arithmetic_v<Key>) {
+    radix_sort_by_key(first, last, key);
+  }
+  else {
+    std::sort(first, last, [&key](const T& lhs, const T& rhs) {
+      return key(lhs) < key(rhs);
+    });
+  }
+}
+
+// The parallel version of sort_by_key, for any type of key.
+template<typename RandomIt, typename KeyFunction>
+void parallel_sort_by_key(ThreadPool& pool, RandomIt first, RandomIt last,
+  KeyFunction key) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  parallel_sort(pool, first, last, [key](const T& lhs, const T& rhs) {
+    return key(lhs) < key(rhs);
+  });
+}
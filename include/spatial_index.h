@@ -0,0 +1,133 @@
+/*
+ * Nearest-neighbor and radius queries over CityRecords (see city.h) by
+ * latitude/longitude.
+ */
+#pragma once
+
+#include "city.h"
+#include "thread_pool.h"
+
+// Include to get 'size_t'
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// A position on the Earth, in degrees.
+struct GeoPoint
+{
+  double latitude;
+  double longitude;
+};
+
+namespace geo
+{
+  // The mean radius of the Earth.
+  constexpr double kEarthRadiusKm = 6371.0088;
+
+  // A point on the unit sphere.
+  struct UnitVector
+  {
+    double x;
+    double y;
+    double z;
+  };
+
+  UnitVector to_unit_vector(double latitude, double longitude);
+
+  // The squared straight-line ("chord") distance through the unit sphere.
+  // It grows with the great-circle distance, so it ranks points the same way,
+  // but needs no trigonometry.
+  inline double chord2(const UnitVector& a, const UnitVector& b) {
+    double dx = a.x - b.x;
+    double dy = a.y - b.y;
+    double dz = a.z - b.z;
+    return dx * dx + dy * dy + dz * dz;
+  }
+
+  // Convert between squared chords and great-circle distances in km.
+  double chord2_to_km(double chord2);
+  double km_to_chord2(double km);
+
+  // The great-circle distance between two points (the haversine formula).
+  double distance_km(const GeoPoint& a, const GeoPoint& b);
+}
+
+/**
+ * @brief A k-d tree over the positions of a collection of cities, answering
+ * "which k cities are closest to here?" and "which cities are within r km of
+ * here?" in roughly O(log n) instead of the O(n) of checking every city.
+ *
+ *   SpatialIndex index(cities);
+ *   for (auto [idx, km] : index.within({52.52, 13.405}, 50.0)) {
+ *     std::cout << cities[idx].name << ": " << km << " km" << std::endl;
+ *   }
+ *
+ * Each city is stored as a point on the unit sphere (x, y, z), so that
+ * distances are plain 3D Euclidean distances (there is no special case at the
+ * poles or the date line) and results are exact great-circle orderings.
+ *
+ * The tree is "implicit": the points are stored in one flat array, reordered so
+ * that every subtree is a contiguous range whose middle element is the node
+ * that splits it. Apart from that array, the only other storage is one byte
+ * per node for the split axis: no node objects, no child pointers.
+ *
+ * Results refer to cities by their index in the collection the index was built
+ * from, and are sorted by distance (closest first). The index is immutable, so
+ * any number of threads may query it at once.
+ */
+class SpatialIndex
+{
+  public:
+    struct Neighbor
+    {
+      uint32_t index;      // Into the collection the index was built from.
+      double distance_km;  // The great-circle distance from the query.
+    };
+
+    explicit SpatialIndex(const std::vector<CityRecord>& cities);
+    explicit SpatialIndex(const std::vector<GeoPoint>& points);
+
+    size_t size() const { return points_.size(); }
+
+    // The (up to) 'k' closest cities to 'query'.
+    std::vector<Neighbor> nearest(const GeoPoint& query, size_t k) const;
+
+    // Every city within 'radius_km' of 'query'.
+    std::vector<Neighbor> within(const GeoPoint& query,
+      double radius_km) const;
+
+    /**
+     * @brief Answer many queries at once, split over 'pool' (and the calling
+     * thread). result[i] is the answer to queries[i].
+     */
+    std::vector<std::vector<Neighbor>> nearest(
+      const std::vector<GeoPoint>& queries, size_t k, ThreadPool& pool) const;
+    std::vector<std::vector<Neighbor>> within(
+      const std::vector<GeoPoint>& queries, double radius_km,
+      ThreadPool& pool) const;
+
+  private:
+    struct Point
+    {
+      geo::UnitVector position;
+      uint32_t index;
+    };
+
+    // Ranges this small are scanned instead of split further.
+    static constexpr size_t kLeafSize = 8;
+
+    void _build(size_t begin, size_t end);
+    void _nearest(size_t begin, size_t end, const geo::UnitVector& query,
+      size_t k, std::vector<std::pair<double, uint32_t>>& heap) const;
+    void _within(size_t begin, size_t end, const geo::UnitVector& query,
+      double max_chord2, std::vector<std::pair<double, uint32_t>>& found) const;
+
+    static std::vector<Neighbor> _to_neighbors(
+      std::vector<std::pair<double, uint32_t>>& found);
+
+    // In tree order, see above.
+    std::vector<Point> points_;
+    // The split axis (0 = x, 1 = y, 2 = z) of the node at each position.
+    std::vector<uint8_t> axes_;
+};
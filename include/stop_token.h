@@ -0,0 +1,172 @@
+/*
+ * Cooperative cancellation: asking a thread to stop, and waking it up right
+ * away if it's asleep.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace stop_detail
+{
+  // Shared by a StopSource and all of its tokens.
+  struct StopState
+  {
+    std::atomic<bool> stopped{false};
+    // Sleeping tokens wait on 'condition'. Events waiting with a token
+    // register their own mutex and condition variable in 'waiters', so that
+    // request_stop() can wake them too.
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<std::pair<std::mutex*, std::condition_variable*>> waiters;
+  };
+}
+
+class StopSource;
+
+/**
+ * @brief The worker's side of a StopSource: a cheap, copyable handle that
+ * says whether a stop was requested, and sleeps that end early when it is.
+ *
+ * Checking stop_requested() is a single atomic load, so workers can check it
+ * as often as they like. Instead of polling with std::this_thread::sleep_for()
+ * (which keeps a worker asleep for the whole duration, however long it was),
+ * sleep with sleep_for(), which returns within microseconds of a stop.
+ *
+ * A default-constructed token has no source and never stops.
+ */
+class StopToken
+{
+  public:
+    StopToken() = default;
+
+    bool stop_requested() const {
+      return state_ && state_->stopped.load(std::memory_order_acquire);
+    }
+
+    // False if no stop can ever be requested.
+    bool stop_possible() const { return state_ != nullptr; }
+
+    /**
+     * @brief Sleep until 'deadline', or until a stop is requested.
+     *
+     * @return true if we slept until the deadline, false if a stop was
+     * requested (before or during the sleep).
+     */
+    bool sleep_until(std::chrono::steady_clock::time_point deadline) const;
+
+    template<typename Rep, typename Period>
+    bool sleep_for(const std::chrono::duration<Rep, Period>& duration) const {
+      return sleep_until(std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          duration));
+    }
+
+    // Block until a stop is requested (forever, if none can be).
+    void wait() const;
+
+  private:
+    friend class StopSource;
+    friend class Event;
+
+    explicit StopToken(std::shared_ptr<stop_detail::StopState> state)
+      : state_(std::move(state)) {}
+
+    std::shared_ptr<stop_detail::StopState> state_;
+};
+
+/**
+ * @brief The controlling side: hands out StopTokens and requests the stop.
+ * A C++17 stand-in for C++20's std::stop_source (minus the callbacks).
+ *
+ *   StopSource source;
+ *   std::thread worker([token = source.get_token()]() {
+ *     while (token.sleep_for(1s)) { ... }
+ *   });
+ *   source.request_stop();  // The worker wakes up and exits right away.
+ *   worker.join();
+ */
+class StopSource
+{
+  public:
+    StopSource() : state_(std::make_shared<stop_detail::StopState>()) {}
+
+    StopToken get_token() const { return StopToken(state_); }
+
+    bool stop_requested() const {
+      return state_->stopped.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Ask every token's owner to stop, and wake up any of them that are
+     * sleeping (or waiting on an Event) with the token.
+     *
+     * @return true if this call made the request, false if a stop had already
+     * been requested.
+     */
+    bool request_stop();
+
+  private:
+    std::shared_ptr<stop_detail::StopState> state_;
+};
+
+/**
+ * @brief A manual-reset event: a flag that threads can wait on. set() wakes up
+ * every waiter, and the event stays set until reset().
+ *
+ * Waiting with a StopToken also returns as soon as a stop is requested, so a
+ * worker waiting for work never has to wake up periodically just to check
+ * whether it should exit:
+ *
+ *   while (work_ready.wait(token)) {
+ *     work_ready.reset();
+ *     ...
+ *   }
+ */
+class Event
+{
+  public:
+    Event() = default;
+
+    Event(const Event& other) = delete;
+    Event& operator=(const Event& other) = delete;
+
+    void set();
+    void reset();
+    bool is_set() const;
+
+    /**
+     * @brief Block until the event is set or a stop is requested on 'token'.
+     *
+     * @return true if the event is set, false if we stopped waiting because of
+     * the token.
+     */
+    bool wait(const StopToken& token = StopToken());
+
+    /**
+     * @brief Like wait(), but also gives up after 'duration'.
+     *
+     * @return true if the event is set, false on a timeout or a stop.
+     */
+    template<typename Rep, typename Period>
+    bool wait_for(const std::chrono::duration<Rep, Period>& duration,
+      const StopToken& token = StopToken()) {
+      return _wait(true, std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          duration), token);
+    }
+
+  private:
+    bool _wait(bool has_deadline,
+      std::chrono::steady_clock::time_point deadline, const StopToken& token);
+
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+    bool set_ = false;
+};
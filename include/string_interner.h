@@ -0,0 +1,175 @@
+/*
+ * String interning: storing each distinct string once, and referring to it by a
+ * small integer handle.
+ */
+#pragma once
+
+#include "allocators.h"
+
+#include <atomic>
+// Include to get 'size_t'
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief A 4-byte handle to a string stored in a StringInterner. Two handles
+ * from the same interner are equal if and only if their strings are, so
+ * comparing (and hashing) them is comparing (and hashing) a single integer.
+ *
+ * A default-constructed InternedString is the empty string. Handles from
+ * different interners must not be mixed.
+ *
+ * NOTE: operator< orders handles by the order in which their strings were
+ * first interned, not alphabetically. That's all an ordered container needs,
+ * but use StringInterner::view() to sort by the characters.
+ */
+class InternedString
+{
+  public:
+    InternedString() = default;
+
+    // The position of the string in its interner (0, 1, 2, ...).
+    uint32_t id() const { return id_; }
+
+    bool operator==(InternedString other) const { return id_ == other.id_; }
+    bool operator!=(InternedString other) const { return id_ != other.id_; }
+    bool operator<(InternedString other) const { return id_ < other.id_; }
+
+  private:
+    friend class StringInterner;
+    explicit InternedString(uint32_t id) : id_(id) {}
+
+    uint32_t id_{0};
+};
+
+namespace std
+{
+  // The id is already unique, so it's a perfect hash (FlatHashMap mixes its
+  // bits before using it).
+  template<>
+  struct hash<InternedString>
+  {
+    size_t operator()(InternedString string) const { return string.id(); }
+  };
+}
+
+/**
+ * @brief Deduplicates strings: intern() copies each distinct string into an
+ * Arena exactly once and hands out the same InternedString for every copy of
+ * it after that.
+ *
+ *   StringInterner names;
+ *   InternedString a = names.intern("Berlin");
+ *   InternedString b = names.intern(std::string("Ber") + "lin");
+ *   a == b;            // true, without looking at a single character
+ *   names.view(a);     // "Berlin"
+ *
+ * Lookups go through an open-addressing table of ids that also keeps (part of)
+ * each string's hash, so most probes never touch the characters, and growing
+ * the table never hashes a string again: every string is hashed exactly once,
+ * when it's interned.
+ *
+ * Thread-safe: any number of threads may intern() and find() at once. A string
+ * that's already interned only needs a shared (reader) lock, so the common case
+ * with heavy duplication doesn't serialize the threads. view(), c_str() and
+ * hash() take no lock at all: strings never move once they're interned.
+ */
+class StringInterner
+{
+  public:
+    StringInterner();
+    ~StringInterner();
+
+    // An interner owns its strings, so it cannot be copied.
+    StringInterner(const StringInterner& other) = delete;
+    StringInterner& operator=(const StringInterner& other) = delete;
+
+    // The handle of 'string', adding it to the interner if it's new.
+    InternedString intern(std::string_view string);
+
+    // The handle of 'string', if it has been interned already.
+    std::optional<InternedString> find(std::string_view string) const;
+
+    std::string_view view(InternedString string) const {
+      const Entry& entry = _entry(string.id_);
+      return {entry.data, entry.size};
+    }
+
+    // Every interned string is null-terminated.
+    const char* c_str(InternedString string) const {
+      return _entry(string.id_).data;
+    }
+
+    // The hash of the characters, std::hash<std::string_view>, computed once.
+    size_t hash(InternedString string) const {
+      return _entry(string.id_).hash;
+    }
+
+    // The number of distinct strings (including the empty string).
+    size_t size() const;
+
+    // The bytes held by the interner: characters, entries and the table.
+    size_t memory_usage() const;
+
+  private:
+    struct Entry
+    {
+      const char* data;
+      size_t hash;
+      uint32_t size;
+    };
+
+    /*
+     * Entries live in blocks of 2^10, 2^11, 2^12, ... entries, so they never
+     * move (view() can't race with intern() growing a std::vector), and the
+     * number of blocks is fixed: 23 of them cover every 32-bit id.
+     */
+    static constexpr size_t kFirstBlockBits = 10;
+    static constexpr size_t kNumBlocks = 32 - kFirstBlockBits + 1;
+
+    // The block that holds entry 'id', and the entry's position in it.
+    static size_t _block(uint32_t id) {
+      uint64_t position = uint64_t(id) + (uint64_t(1) << kFirstBlockBits);
+      return 63 - __builtin_clzll(position) - kFirstBlockBits;
+    }
+    static size_t _offset(uint32_t id, size_t block) {
+      return uint64_t(id) + (uint64_t(1) << kFirstBlockBits) -
+        (uint64_t(1) << (block + kFirstBlockBits));
+    }
+
+    const Entry& _entry(uint32_t id) const {
+      size_t block = _block(id);
+      return blocks_[block].load(std::memory_order_acquire)[
+        _offset(id, block)];
+    }
+
+    /*
+     * A slot of the table is 0 when it's empty, and otherwise holds the high
+     * 32 bits of the string's hash above (id + 1). Probing compares the hash
+     * bits first, and only looks at the characters when they match.
+     */
+    static uint64_t _hash_bits(size_t hash) {
+      return (uint64_t(hash) >> 32) << 32;
+    }
+    static uint64_t _slot(size_t hash, uint32_t id) {
+      return _hash_bits(hash) | (uint64_t(id) + 1);
+    }
+
+    // Must hold at least a shared lock.
+    std::optional<InternedString> _find(std::string_view string,
+      size_t hash) const;
+    // Must hold the unique lock.
+    InternedString _insert(std::string_view string, size_t hash);
+    void _grow_table();
+
+    mutable std::shared_mutex mutex_;
+    Arena characters_;
+    std::atomic<Entry*> blocks_[kNumBlocks] = {};
+    uint32_t size_{0};
+    std::vector<uint64_t> table_;
+};
@@ -0,0 +1,260 @@
+/*
+ * A reusable, work-stealing thread pool.
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+// Include to get 'size_t'
+#include <cstddef>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A fixed number of worker threads that run submitted tasks. Spawning a
+ * std::thread per task costs tens of microseconds; handing a task to a thread
+ * that already exists costs a lock and (maybe) a wake-up.
+ *
+ *   ThreadPool pool(4);
+ *   std::future<int> result = pool.submit([]() { return 42; });
+ *   result.get();
+ *
+ *   pool.parallel_for(0, n, [&](size_t idx) { out[idx] = f(in[idx]); });
+ *   double sum = pool.parallel_reduce(0, n, 0.0,
+ *     [&](size_t idx) { return in[idx]; }, std::plus<>());
+ *
+ * Every worker owns a deque of tasks instead of sharing one queue (and one
+ * lock) between them all. A worker pushes and pops tasks it submits itself at
+ * the back of its own deque (newest first, while the data is still in cache),
+ * and when it runs out, "steals" the oldest task from the front of another
+ * worker's deque. Tasks submitted from outside the pool are dealt out to the
+ * workers round-robin.
+ *
+ * NOTE: A task that waits on another task of the same pool must wait with
+ * wait() rather than future::get(), otherwise every worker may end up waiting
+ * and the pool deadlocks. parallel_for and parallel_reduce already do this, so
+ * they may be nested.
+ */
+class ThreadPool
+{
+  public:
+    // Defaults to one worker per hardware thread.
+    explicit ThreadPool(size_t n_threads = std::thread::hardware_concurrency());
+
+    // Finishes any queued tasks, then joins the workers.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool& other) = delete;
+    ThreadPool& operator=(const ThreadPool& other) = delete;
+
+    /**
+     * @brief Queue a callable to run on one of the workers and return a future
+     * for its result.
+     *
+     * @tparam Function Any callable that takes no arguments.
+     */
+    template<typename Function>
+    auto submit(Function&& function)
+      -> std::future<std::invoke_result_t<std::decay_t<Function>>> {
+      using Result = std::invoke_result_t<std::decay_t<Function>>;
+
+      // A packaged_task is move-only, but std::function requires a copyable
+      // callable, so share ownership of the task instead.
+      auto task = std::make_shared<std::packaged_task<Result()>>(
+        std::forward<Function>(function));
+      std::future<Result> result = task->get_future();
+      _enqueue([task]() { (*task)(); });
+      return result;
+    }
+
+    /**
+     * @brief Wait for 'future', running other queued tasks in the meantime
+     * instead of blocking. Safe to call from inside a task.
+     */
+    template<typename T>
+    T wait(std::future<T>& future) {
+      while (future.wait_for(std::chrono::seconds(0)) !=
+             std::future_status::ready) {
+        if (!run_pending_task()) {
+          std::this_thread::yield();
+        }
+      }
+      return future.get();
+    }
+
+    /**
+     * @brief Calls function(idx) for every idx in [begin, end), split into
+     * chunks of 'grain' indices that run in parallel. The calling thread runs
+     * chunks too, and the call returns once every chunk is done. If any call
+     * throws, the first exception is rethrown here (after every chunk has
+     * finished).
+     *
+     * @param grain The number of indices per task. 0 (the default) picks one
+     * that makes several chunks per worker, so that workers that finish early
+     * can steal from the rest.
+     */
+    template<typename Function>
+    void parallel_for(size_t begin, size_t end, Function&& function,
+      size_t grain = 0) {
+      if (begin >= end) {
+        return;
+      }
+      grain = _grain_size(end - begin, grain);
+      _for_each_chunk(begin, end, grain, [&function](size_t first,
+        size_t last) {
+        for (size_t idx = first; idx < last; idx++) {
+          function(idx);
+        }
+      });
+    }
+
+    /**
+     * @brief Combines map(idx) for every idx in [begin, end) with 'reduce',
+     * starting from 'identity'. Chunks are reduced in parallel and the chunk
+     * results are then combined in order, so the result is deterministic
+     * (even for floating point) for a given grain size.
+     *
+     * @tparam Map A callable taking an index and returning a T.
+     * @tparam Reduce A callable combining two Ts, e.g. std::plus<>().
+     */
+    template<typename T, typename Map, typename Reduce>
+    T parallel_reduce(size_t begin, size_t end, T identity, Map&& map,
+      Reduce&& reduce, size_t grain = 0) {
+      if (begin >= end) {
+        return identity;
+      }
+      grain = _grain_size(end - begin, grain);
+      std::vector<T> partials((end - begin + grain - 1) / grain, identity);
+      _for_each_chunk(begin, end, grain, [&](size_t first, size_t last) {
+        T partial = identity;
+        for (size_t idx = first; idx < last; idx++) {
+          partial = reduce(std::move(partial), map(idx));
+        }
+        partials[(first - begin) / grain] = std::move(partial);
+      });
+
+      T result = std::move(identity);
+      for (T& partial : partials) {
+        result = reduce(std::move(result), std::move(partial));
+      }
+      return result;
+    }
+
+    /**
+     * @brief Run one queued task on the calling thread, if there is one.
+     * Returns false if every queue was empty.
+     */
+    bool run_pending_task();
+
+    // The number of worker threads.
+    size_t size() const { return workers_.size(); }
+
+  private:
+    using Task = std::function<void()>;
+
+    // One per worker. Aligned so that two workers' locks never share a cache
+    // line.
+    struct alignas(64) WorkQueue
+    {
+      std::mutex mutex;
+      std::deque<Task> tasks;
+    };
+
+    void _enqueue(Task task);
+    void _worker_loop(size_t index);
+
+    // Pop from the back of our own queue, or steal from the front of another.
+    bool _try_pop(size_t index, Task& task);
+    bool _try_steal(size_t start, Task& task);
+
+    size_t _grain_size(size_t n, size_t grain) const {
+      if (grain > 0) {
+        return grain;
+      }
+      // About 8 chunks per thread (including the caller) balances the load
+      // without making the chunks so small that scheduling dominates.
+      return std::max<size_t>(1, n / ((size() + 1) * 8));
+    }
+
+    /**
+     * @brief Run chunk(first, last) for every 'grain' sized chunk of [begin,
+     * end) on the pool and the calling thread. Returns once all are done.
+     */
+    template<typename Chunk>
+    void _for_each_chunk(size_t begin, size_t end, size_t grain,
+      const Chunk& chunk) {
+      const size_t n_chunks = (end - begin + grain - 1) / grain;
+
+      // Chunks are claimed from a shared counter rather than each being its
+      // own task, so it doesn't matter how many of the tasks below actually
+      // get to run: whoever is free claims the next chunk.
+      struct Shared
+      {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+      };
+      auto shared = std::make_shared<Shared>();
+
+      auto run_chunks = [shared, &chunk, begin, end, grain, n_chunks]() {
+        size_t idx;
+        while ((idx = shared->next.fetch_add(1)) < n_chunks) {
+          size_t first = begin + idx * grain;
+          size_t last = std::min(end, first + grain);
+          try {
+            chunk(first, last);
+          }
+          catch (...) {
+            std::lock_guard<std::mutex> lock(shared->error_mutex);
+            if (!shared->error) {
+              shared->error = std::current_exception();
+            }
+          }
+          shared->done.fetch_add(1, std::memory_order_release);
+        }
+      };
+
+      // One helper per worker at most, and none if the caller can do it all.
+      size_t n_helpers = std::min(size(), n_chunks - 1);
+      for (size_t helper = 0; helper < n_helpers; helper++) {
+        _enqueue(run_chunks);
+      }
+      run_chunks();
+
+      // Some chunks may still be running on the workers. Help out with other
+      // tasks while we wait. ('chunk' lives on our stack, so helpers that
+      // start after this point find no chunks left and never touch it.)
+      while (shared->done.load(std::memory_order_acquire) < n_chunks) {
+        if (!run_pending_task()) {
+          std::this_thread::yield();
+        }
+      }
+      if (shared->error) {
+        std::rethrow_exception(shared->error);
+      }
+    }
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> workers_;
+    // Where the next task from outside the pool goes.
+    std::atomic<size_t> next_queue_{0};
+
+    // Idle workers sleep on 'wake_up_'. 'pending_' counts queued tasks and
+    // 'n_sleeping_' lets _enqueue skip the lock when every worker is busy.
+    std::atomic<size_t> pending_{0};
+    std::atomic<size_t> n_sleeping_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_up_;
+    std::atomic<bool> stopping_{false};
+};
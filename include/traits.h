@@ -0,0 +1,92 @@
+/*
+ * Type traits (and helpers built on them) used by our custom containers.
+ */
+#pragma once
+
+// Include to get 'size_t'
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief A type is "trivially relocatable" if moving an object to a new
+ * address and then destroying the original is equivalent to copying its bytes
+ * (with memcpy) and "forgetting" about the original.
+ *
+ * Every trivially copyable type (int, float, plain structs) is trivially
+ * relocatable. Plenty of other types are too - for example our String class
+ * owns a heap buffer, but relocating one is nothing more than copying its
+ * pointer and size. Because the compiler cannot figure that out on its own,
+ * user types can "opt in" by specializing this trait:
+ *
+ *   template<>
+ *   struct is_trivially_relocatable<String> : std::true_type {};
+ *
+ * Only do this for types that do NOT store pointers into themselves!
+ *
+ * @tparam T
+ */
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+// Follow the STL convention and provide a "_v" helper variable template.
+template<typename T>
+inline constexpr bool is_trivially_relocatable_v =
+  is_trivially_relocatable<T>::value;
+
+/**
+ * @brief Moves 'n' objects from 'src' into the uninitialized memory at 'dest'
+ * and destroys the originals. Trivially relocatable types are moved with a
+ * single memcpy. 'src' and 'dest' must not overlap.
+ *
+ * @tparam T
+ */
+template<typename T>
+void relocate(T* src, size_t n, T* dest) {
+  if constexpr (is_trivially_relocatable_v<T>) {
+    if (n > 0) {
+      std::memcpy(static_cast<void*>(dest), src, n * sizeof(T));
+    }
+  }
+  else {
+    for (size_t idx = 0; idx < n; idx++) {
+      new(&dest[idx]) T(std::move(src[idx]));
+      src[idx].~T();
+    }
+  }
+}
+
+/**
+ * @brief Same as relocate(), except that 'src' and 'dest' MAY overlap, e.g.
+ * when shifting the tail of a container left or right to open (or close) a
+ * gap. Trivially relocatable types are moved with a single memmove.
+ *
+ * @tparam T
+ */
+template<typename T>
+void relocate_overlapping(T* src, size_t n, T* dest) {
+  if (n == 0 || src == dest) {
+    return;
+  }
+
+  if constexpr (is_trivially_relocatable_v<T>) {
+    std::memmove(static_cast<void*>(dest), src, n * sizeof(T));
+  }
+  else if (dest < src) {
+    // Shifting left: walk forwards so that we never construct on top of an
+    // element that hasn't been moved yet.
+    for (size_t idx = 0; idx < n; idx++) {
+      new(&dest[idx]) T(std::move(src[idx]));
+      src[idx].~T();
+    }
+  }
+  else {
+    // Shifting right: walk backwards for the same reason.
+    for (size_t idx = n; idx > 0; idx--) {
+      new(&dest[idx - 1]) T(std::move(src[idx - 1]));
+      src[idx - 1].~T();
+    }
+  }
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "traits.h"
+
 #include <iostream>
 #include <cstring>
 
@@ -35,7 +37,7 @@ struct Vec2
 
   // Use operator overloading to overload the == and != operators
   bool operator==(const Vec2 other) const {
-    return x == other.y && y == other.y;
+    return x == other.x && y == other.y;
   }
 
   bool operator!=(const Vec2 other) const { return !(*this == other); }
@@ -49,6 +51,12 @@ struct Vec2
 // implementation gets included in multiple translation units.
 std::ostream& operator<<(std::ostream& stream, const Vec2& vec);
 
+// Vec2's copy constructor is user-defined (so that we can see when copies
+// happen), which means that Vec2 is not trivially copyable. It's still just two
+// floats though, so it's perfectly safe to relocate it with memcpy.
+template<>
+struct is_trivially_relocatable<Vec2> : std::true_type {};
+
 struct Vec3
 {
   /* Writing a vector-3 class to support development of our custom Vector 
@@ -226,8 +234,9 @@ struct Vec3
 
 class String
 {
-  // A bare-bones (non-modern) C++ string class. Note that this String class
-  // does not include or account for a null-termination character.
+  // A bare-bones (non-modern) C++ string class that logs every construction,
+  // copy, move and destruction. See SmallString (small_string.h) for one that's
+  // meant to be used.
   public:
     // Provide a default constructor.
     String() = default;
@@ -236,9 +245,10 @@ class String
       // Determine the size of the string
       size_ = std::strlen(string);
 
-      // Create a buffer the same size as the string (+1 to account for null 
-      // termination character, but doesn't seem to be necessary?)
-      buffer_ = new char[size_];
+      // Create a buffer the same size as the string, +1 for the null
+      // termination character. (Writing buffer_[size_] into a buffer of only
+      // size_ chars "seems" to work, but it's a heap buffer overflow.)
+      buffer_ = new char[size_ + 1];
 
       // Copy the value pointed to by 'string' into our buffer
       std::memcpy(buffer_, string, size_);
@@ -265,10 +275,12 @@ class String
     // the size (because it's just an int) and a deep copy of the buffer pointer
     String(const String& other) : size_(other.size_) {
         std::cout << "String Copy Constructor invoked." << std::endl;
-        // Create the buffer as a 'new' char pointer
-        buffer_ = new char[size_];
+        // Create the buffer as a 'new' char pointer (+1 for the null
+        // termination character)
+        buffer_ = new char[size_ + 1];
         // Copy the contents of the other string into the new buffer
         std::memcpy(buffer_, other.buffer_, size_);
+        buffer_[size_] = 0;
     }
 
     /**
@@ -339,13 +351,23 @@ class String
     // by index. Ignore safety concerns that would check if the index is valid.
     char& operator[](const unsigned int index) { return buffer_[index]; }
 
+    unsigned int size() const { return size_; }
+    // nullptr for a default-constructed or "hollow" (moved-from) String.
+    const char* c_str() const { return buffer_; }
+
   private:
-    char* buffer_;
-    unsigned int size_;
+    // Initialized so that a default-constructed String is "hollow" too, rather
+    // than deleting a garbage pointer in its destructor.
+    char* buffer_ = nullptr;
+    unsigned int size_ = 0;
 };
 
 std::ostream& operator<<(std::ostream& stream, const String& string);
 
+// Relocating a String only requires copying its buffer pointer and size, so we
+// opt-in to the trivially relocatable fast path of our Vector container.
+template<>
+struct is_trivially_relocatable<String> : std::true_type {};
 
 // Rather than use 'typename', we use int because we expect N to be an int.
 template<typename T, int N>
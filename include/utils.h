@@ -27,7 +27,8 @@ void print(T value) { std::cout << value << std::endl; }
 
 /**
  * @brief Timer is a scope-based timer utility that will capture the total time
- * that this struct is in scope.
+ * that this struct is in scope. See PerfTimer (perf_counters.h) for a version
+ * that also reports hardware counters, e.g. cycles and cache misses.
  */
 struct Timer
 {
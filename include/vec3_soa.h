@@ -0,0 +1,294 @@
+/*
+ * A "structure of arrays" container of 3D vectors.
+ *
+ * Vector<Vec3> stores whole Vec3 objects one after another ("array of
+ * structs"): x, y, z, some padding and a pointer to a heap block, 32 bytes per
+ * element (plus the heap block itself) of which only 12 are coordinates. A
+ * loop that only needs the coordinates still drags all 32 bytes through the
+ * cache, and the x's of neighbouring elements are 32 bytes apart, so the
+ * compiler can't load 4 or 8 of them into one SIMD register.
+ *
+ * Vec3SoA keeps all the x's in one array, all the y's in another and all the
+ * z's in a third. Each array starts on a cache line, so the bulk operations
+ * (transform, sum, bounding_box, distances_to) can stream through them a whole
+ * SIMD register at a time (see simd_pack.h).
+ */
+#pragma once
+
+#include "types.h"
+#include "vec_math.h"
+#include "vector.h"
+
+// Include to get 'size_t'
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+/**
+ * @brief A random access iterator over a Vec3SoA. There's no Vec3 object to
+ * point to, so dereferencing returns a "proxy" (Vec3SoA::Reference or
+ * Vec3SoA::ConstReference) by value, much like std::vector<bool>'s iterator.
+ *
+ * @tparam SoA Vec3SoA, or const Vec3SoA for a "const iterator".
+ */
+template<typename SoA>
+class Vec3SoAIterator
+{
+  public:
+    using ValueType = typename std::remove_const_t<SoA>::ValueType;
+    using ReferenceType = std::conditional_t<std::is_const_v<SoA>,
+      typename std::remove_const_t<SoA>::ConstReference,
+      typename std::remove_const_t<SoA>::Reference>;
+
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = ValueType;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = ReferenceType;
+
+  public:
+    Vec3SoAIterator() : soa_(nullptr), index_(0) {}
+    Vec3SoAIterator(SoA* soa, size_t index) : soa_(soa), index_(index) {}
+
+    // Allow an iterator to be converted into a const iterator.
+    template<typename Other,
+      typename = std::enable_if_t<std::is_same_v<const Other, SoA>>>
+    Vec3SoAIterator(const Vec3SoAIterator<Other>& other) :
+      soa_(other.soa()), index_(other.index()) {}
+
+    ReferenceType operator*() const { return (*soa_)[index_]; }
+    ReferenceType operator[](difference_type n) const {
+      return (*soa_)[index_ + n];
+    }
+
+    Vec3SoAIterator& operator++() {
+      index_++;
+      return *this;
+    }
+    Vec3SoAIterator operator++(int) {
+      Vec3SoAIterator it = *this;
+      ++(*this);
+      return it;
+    }
+    Vec3SoAIterator& operator--() {
+      index_--;
+      return *this;
+    }
+    Vec3SoAIterator operator--(int) {
+      Vec3SoAIterator it = *this;
+      --(*this);
+      return it;
+    }
+
+    Vec3SoAIterator& operator+=(difference_type n) {
+      index_ += n;
+      return *this;
+    }
+    Vec3SoAIterator& operator-=(difference_type n) {
+      index_ -= n;
+      return *this;
+    }
+    Vec3SoAIterator operator+(difference_type n) const {
+      return Vec3SoAIterator(soa_, index_ + n);
+    }
+    Vec3SoAIterator operator-(difference_type n) const {
+      return Vec3SoAIterator(soa_, index_ - n);
+    }
+    friend Vec3SoAIterator operator+(difference_type n,
+      const Vec3SoAIterator& it) {
+      return it + n;
+    }
+
+    template<typename Other>
+    difference_type operator-(const Vec3SoAIterator<Other>& other) const {
+      return static_cast<difference_type>(index_) -
+        static_cast<difference_type>(other.index());
+    }
+
+    SoA* soa() const { return soa_; }
+    size_t index() const { return index_; }
+
+    template<typename Other>
+    bool operator==(const Vec3SoAIterator<Other>& other) const {
+      return index_ == other.index();
+    }
+    template<typename Other>
+    bool operator!=(const Vec3SoAIterator<Other>& other) const {
+      return !(*this == other);
+    }
+    template<typename Other>
+    bool operator<(const Vec3SoAIterator<Other>& other) const {
+      return index_ < other.index();
+    }
+    template<typename Other>
+    bool operator>(const Vec3SoAIterator<Other>& other) const {
+      return other < *this;
+    }
+    template<typename Other>
+    bool operator<=(const Vec3SoAIterator<Other>& other) const {
+      return !(other < *this);
+    }
+    template<typename Other>
+    bool operator>=(const Vec3SoAIterator<Other>& other) const {
+      return !(*this < other);
+    }
+
+  private:
+    SoA* soa_;
+    size_t index_;
+};
+
+/**
+ * @brief 3D vectors stored as three separate, 64-byte aligned arrays of x's,
+ * y's and z's.
+ *
+ * Elements are read and written as math::Vec3 values. soa[i] returns a
+ * Reference whose x, y and z members refer straight into the arrays, so
+ * soa[i].y = 2.0f and soa[i] = math::Vec3{1, 2, 3} both work. Like any
+ * pointer into a container, a Reference (or an iterator) is invalidated when
+ * the container reallocates.
+ */
+class Vec3SoA
+{
+  public:
+    // The type that an element reads as.
+    using ValueType = math::Vec3;
+
+    struct Reference
+    {
+      float& x;
+      float& y;
+      float& z;
+
+      operator math::Vec3() const { return {x, y, z}; }
+
+      // Assigning to a Reference writes to the element that it refers to
+      // (rather than making the reference refer to something else).
+      const Reference& operator=(math::Vec3 value) const {
+        x = value.x;
+        y = value.y;
+        z = value.z;
+        return *this;
+      }
+      const Reference& operator=(const Reference& other) const {
+        return *this = static_cast<math::Vec3>(other);
+      }
+    };
+
+    struct ConstReference
+    {
+      const float& x;
+      const float& y;
+      const float& z;
+
+      operator math::Vec3() const { return {x, y, z}; }
+    };
+
+    using Iterator = Vec3SoAIterator<Vec3SoA>;
+    using ConstIterator = Vec3SoAIterator<const Vec3SoA>;
+
+    // The names that generic (STL-style) code expects.
+    using value_type = ValueType;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = Reference;
+    using const_reference = ConstReference;
+    using iterator = Iterator;
+    using const_iterator = ConstIterator;
+
+    // Every array starts on a cache line.
+    static constexpr size_t kAlignment = 64;
+
+  public:
+    Vec3SoA() = default;
+
+    // 'size' zero vectors.
+    explicit Vec3SoA(size_t size);
+
+    // Converts from an "array of structs". Only the coordinates are copied, no
+    // Vec3 gets copied (or logs anything).
+    explicit Vec3SoA(const Vector<Vec3>& vecs);
+
+    Vec3SoA(const Vec3SoA& other);
+    Vec3SoA(Vec3SoA&& other) noexcept;
+    Vec3SoA& operator=(const Vec3SoA& other);
+    Vec3SoA& operator=(Vec3SoA&& other) noexcept;
+    ~Vec3SoA();
+
+    /**
+     * @brief Converts back to an "array of structs": replaces the contents of
+     * 'vecs' with a Vec3 for each element. This fills a Vector that the caller
+     * owns rather than returning one, because Vector has no copy or move
+     * constructor of its own to return it by value safely.
+     *
+     * @param vecs
+     */
+    void to_vector(Vector<Vec3>& vecs) const;
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return capacity_; }
+
+    void reserve(size_t new_capacity);
+    // New elements are zero vectors.
+    void resize(size_t new_size);
+    void clear() { size_ = 0; }
+
+    void push_back(math::Vec3 value);
+    void push_back(const Vec3& value) {
+      push_back(math::Vec3{value.x, value.y, value.z});
+    }
+
+    Reference operator[](size_t index) {
+      return {x()[index], y()[index], z()[index]};
+    }
+    ConstReference operator[](size_t index) const {
+      return {x()[index], y()[index], z()[index]};
+    }
+
+    // The arrays themselves, each with size() elements.
+    float* x() { return block_; }
+    float* y() { return block_ + capacity_; }
+    float* z() { return block_ + 2 * capacity_; }
+    const float* x() const { return block_; }
+    const float* y() const { return block_ + capacity_; }
+    const float* z() const { return block_ + 2 * capacity_; }
+
+    Iterator begin() { return Iterator(this, 0); }
+    Iterator end() { return Iterator(this, size_); }
+    ConstIterator begin() const { return ConstIterator(this, 0); }
+    ConstIterator end() const { return ConstIterator(this, size_); }
+    ConstIterator cbegin() const { return begin(); }
+    ConstIterator cend() const { return end(); }
+
+    /*
+     * Bulk operations, a whole SIMD register of elements at a time.
+     */
+
+    // Replaces every element p with matrix * p + translation.
+    void transform(const math::Mat3& matrix, math::Vec3 translation);
+
+    // The sum of all the elements. The additions happen in a different order
+    // than in a plain loop, so the result may differ in the last few bits.
+    math::Vec3 sum() const;
+
+    // The smallest box containing every element (an empty math::Box3 if there
+    // are none). NaN coordinates are ignored.
+    math::Box3 bounding_box() const;
+
+    // Writes the distance from each element to 'point' to out[i]. 'out' must
+    // have room for size() floats.
+    void distances_to(math::Vec3 point, float* out) const;
+
+  private:
+    void _reallocate(size_t new_capacity);
+
+  private:
+    // All three arrays share one allocation: the x's at block_, the y's at
+    // block_ + capacity_ and the z's at block_ + 2 * capacity_. capacity_ is
+    // always a multiple of a cache line's worth of floats, so every array is
+    // aligned.
+    float* block_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
@@ -0,0 +1,196 @@
+/*
+ * Small-vector math (2D and 3D), one vector at a time and in batches over
+ * arrays, with SIMD batch implementations.
+ *
+ * The batch functions use AVX2 (8 floats at a time) when the code is compiled
+ * with AVX2 enabled (see ENABLE_AVX2 in CMakeLists.txt), SSE (4 at a time) on
+ * any other x86-64 build, and plain scalar code everywhere else. The
+ * math::scalar namespace always has the scalar versions, and the SIMD ones give
+ * exactly the same results, bit for bit: every lane does the same IEEE
+ * operations in the same order as the scalar code (no reciprocal
+ * approximations, no reordered sums, and src/vec_math.cpp is compiled with
+ * -ffp-contract=off so that no a*b+c gets fused into an FMA in one version but
+ * not the other).
+ */
+#pragma once
+
+// Include to get 'size_t'
+#include <cstddef>
+#include <cmath>
+#include <type_traits>
+
+namespace math
+{
+  /*
+   * Plain old data: no user-defined copy constructors (compare ::Vec2 and
+   * ::Vec3 in types.h), so arrays of them can be processed as arrays of floats.
+   */
+  struct Vec2
+  {
+    float x;
+    float y;
+  };
+
+  struct Vec3
+  {
+    float x;
+    float y;
+    float z;
+  };
+
+  static_assert(sizeof(Vec2) == 2 * sizeof(float) &&
+    std::is_trivially_copyable_v<Vec2>, "Vec2 must be two packed floats.");
+  static_assert(sizeof(Vec3) == 3 * sizeof(float) &&
+    std::is_trivially_copyable_v<Vec3>, "Vec3 must be three packed floats.");
+
+  /*
+   * min and max follow the SSE instructions rather than std::min/std::max: if
+   * the two values compare equal (e.g. 0.0f and -0.0f) or either is a NaN,
+   * the second one is returned.
+   */
+  inline float min(float a, float b) { return a < b ? a : b; }
+  inline float max(float a, float b) { return a > b ? a : b; }
+
+  /*
+   * Vec2
+   */
+  inline Vec2 operator+(Vec2 a, Vec2 b) { return {a.x + b.x, a.y + b.y}; }
+  inline Vec2 operator-(Vec2 a, Vec2 b) { return {a.x - b.x, a.y - b.y}; }
+  inline Vec2 operator*(Vec2 a, float s) { return {a.x * s, a.y * s}; }
+  inline Vec2 operator*(float s, Vec2 a) { return a * s; }
+  inline Vec2 operator/(Vec2 a, float s) { return {a.x / s, a.y / s}; }
+  inline bool operator==(Vec2 a, Vec2 b) { return a.x == b.x && a.y == b.y; }
+  inline bool operator!=(Vec2 a, Vec2 b) { return !(a == b); }
+
+  inline float dot(Vec2 a, Vec2 b) { return a.x * b.x + a.y * b.y; }
+  // The z component of the 3D cross product of (a, 0) and (b, 0).
+  inline float cross(Vec2 a, Vec2 b) { return a.x * b.y - a.y * b.x; }
+  inline float length(Vec2 a) { return std::sqrt(dot(a, a)); }
+  // A zero-length vector (or one with a NaN) normalizes to (0, 0).
+  inline Vec2 normalize(Vec2 a) {
+    float len = length(a);
+    return len > 0.0f ? a / len : Vec2{0.0f, 0.0f};
+  }
+  inline Vec2 lerp(Vec2 a, Vec2 b, float t) { return a + (b - a) * t; }
+  inline Vec2 min(Vec2 a, Vec2 b) { return {min(a.x, b.x), min(a.y, b.y)}; }
+  inline Vec2 max(Vec2 a, Vec2 b) { return {max(a.x, b.x), max(a.y, b.y)}; }
+
+  /*
+   * Vec3
+   */
+  inline Vec3 operator+(Vec3 a, Vec3 b) {
+    return {a.x + b.x, a.y + b.y, a.z + b.z};
+  }
+  inline Vec3 operator-(Vec3 a, Vec3 b) {
+    return {a.x - b.x, a.y - b.y, a.z - b.z};
+  }
+  inline Vec3 operator*(Vec3 a, float s) { return {a.x * s, a.y * s, a.z * s}; }
+  inline Vec3 operator*(float s, Vec3 a) { return a * s; }
+  inline Vec3 operator/(Vec3 a, float s) { return {a.x / s, a.y / s, a.z / s}; }
+  inline bool operator==(Vec3 a, Vec3 b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+  }
+  inline bool operator!=(Vec3 a, Vec3 b) { return !(a == b); }
+
+  inline float dot(Vec3 a, Vec3 b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+  }
+  inline Vec3 cross(Vec3 a, Vec3 b) {
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z,
+      a.x * b.y - a.y * b.x};
+  }
+  inline float length(Vec3 a) { return std::sqrt(dot(a, a)); }
+  // A zero-length vector (or one with a NaN) normalizes to (0, 0, 0).
+  inline Vec3 normalize(Vec3 a) {
+    float len = length(a);
+    return len > 0.0f ? a / len : Vec3{0.0f, 0.0f, 0.0f};
+  }
+  inline Vec3 lerp(Vec3 a, Vec3 b, float t) { return a + (b - a) * t; }
+  inline Vec3 min(Vec3 a, Vec3 b) {
+    return {min(a.x, b.x), min(a.y, b.y), min(a.z, b.z)};
+  }
+  inline Vec3 max(Vec3 a, Vec3 b) {
+    return {max(a.x, b.x), max(a.y, b.y), max(a.z, b.z)};
+  }
+
+  /*
+   * A 3x3 matrix, stored row by row, e.g. a rotation or a scale.
+   */
+  struct Mat3
+  {
+    Vec3 rows[3];
+  };
+
+  inline Vec3 operator*(const Mat3& m, Vec3 v) {
+    return {dot(m.rows[0], v), dot(m.rows[1], v), dot(m.rows[2], v)};
+  }
+
+  /*
+   * An axis-aligned box. The default one is "empty" (min > max), so that
+   * growing it by any point gives the box around just that point.
+   */
+  struct Box3
+  {
+    Vec3 min{INFINITY, INFINITY, INFINITY};
+    Vec3 max{-INFINITY, -INFINITY, -INFINITY};
+  };
+
+  inline Box3 grow(Box3 box, Vec3 point) {
+    return {min(point, box.min), max(point, box.max)};
+  }
+
+  /*
+   * Batches: out[i] = op(a[i], b[i]) for i in [0, n). 'out' may be the same
+   * array as 'a' or 'b' (but must not partially overlap them).
+   */
+  void add(const Vec2* a, const Vec2* b, Vec2* out, size_t n);
+  void sub(const Vec2* a, const Vec2* b, Vec2* out, size_t n);
+  void scale(const Vec2* a, float s, Vec2* out, size_t n);
+  void dot(const Vec2* a, const Vec2* b, float* out, size_t n);
+  void cross(const Vec2* a, const Vec2* b, float* out, size_t n);
+  void length(const Vec2* a, float* out, size_t n);
+  void normalize(const Vec2* a, Vec2* out, size_t n);
+  void lerp(const Vec2* a, const Vec2* b, float t, Vec2* out, size_t n);
+  void min(const Vec2* a, const Vec2* b, Vec2* out, size_t n);
+  void max(const Vec2* a, const Vec2* b, Vec2* out, size_t n);
+
+  void add(const Vec3* a, const Vec3* b, Vec3* out, size_t n);
+  void sub(const Vec3* a, const Vec3* b, Vec3* out, size_t n);
+  void scale(const Vec3* a, float s, Vec3* out, size_t n);
+  void dot(const Vec3* a, const Vec3* b, float* out, size_t n);
+  void cross(const Vec3* a, const Vec3* b, Vec3* out, size_t n);
+  void length(const Vec3* a, float* out, size_t n);
+  void normalize(const Vec3* a, Vec3* out, size_t n);
+  void lerp(const Vec3* a, const Vec3* b, float t, Vec3* out, size_t n);
+  void min(const Vec3* a, const Vec3* b, Vec3* out, size_t n);
+  void max(const Vec3* a, const Vec3* b, Vec3* out, size_t n);
+
+  // "AVX2", "SSE" or "scalar": what the batch functions above were built with.
+  const char* simd_instruction_set();
+
+  // The same batch functions, always one vector at a time.
+  namespace scalar
+  {
+    void add(const Vec2* a, const Vec2* b, Vec2* out, size_t n);
+    void sub(const Vec2* a, const Vec2* b, Vec2* out, size_t n);
+    void scale(const Vec2* a, float s, Vec2* out, size_t n);
+    void dot(const Vec2* a, const Vec2* b, float* out, size_t n);
+    void cross(const Vec2* a, const Vec2* b, float* out, size_t n);
+    void length(const Vec2* a, float* out, size_t n);
+    void normalize(const Vec2* a, Vec2* out, size_t n);
+    void lerp(const Vec2* a, const Vec2* b, float t, Vec2* out, size_t n);
+    void min(const Vec2* a, const Vec2* b, Vec2* out, size_t n);
+    void max(const Vec2* a, const Vec2* b, Vec2* out, size_t n);
+
+    void add(const Vec3* a, const Vec3* b, Vec3* out, size_t n);
+    void sub(const Vec3* a, const Vec3* b, Vec3* out, size_t n);
+    void scale(const Vec3* a, float s, Vec3* out, size_t n);
+    void dot(const Vec3* a, const Vec3* b, float* out, size_t n);
+    void cross(const Vec3* a, const Vec3* b, Vec3* out, size_t n);
+    void length(const Vec3* a, float* out, size_t n);
+    void normalize(const Vec3* a, Vec3* out, size_t n);
+    void lerp(const Vec3* a, const Vec3* b, float t, Vec3* out, size_t n);
+    void min(const Vec3* a, const Vec3* b, Vec3* out, size_t n);
+    void max(const Vec3* a, const Vec3* b, Vec3* out, size_t n);
+  }
+}
@@ -1,11 +1,25 @@
 #pragma once
 
+#include "growth_policy.h"
+#include "traits.h"
+#include "vector_instrumentation.h"
+
 // Include to get 'size_t'
 #include <cstddef>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <type_traits>
 
 /**
  * @brief Video #94: Implementing an iterator for our custom Vector class.
+ *
+ * This is a "random access" iterator, i.e. it supports everything a raw
+ * pointer does (jumping by n, subtracting two iterators, comparing with <),
+ * which is what std::sort, std::lower_bound and the parallel algorithms need.
+ * Instantiating it with a const container, e.g. VectorIterator<const
+ * Vector<int>>, gives a read-only "const iterator".
  * 
  * @tparam Vector 
  */
@@ -14,13 +28,34 @@ class VectorIterator
 {
   public:
     // Follow the STL naming convention and use "ValueType".
-    using ValueType = typename Vector::ValueType;
+    using ValueType = std::conditional_t<std::is_const_v<Vector>,
+      const typename Vector::ValueType, typename Vector::ValueType>;
     using PointerType = ValueType*;
     using ReferenceType = ValueType&;
 
+    // The STL algorithms don't know about our naming convention, so we also
+    // have to provide the names that std::iterator_traits looks for.
+    using iterator_category = std::random_access_iterator_tag;
+#if __cplusplus >= 202002L
+    // Our elements are stored contiguously in memory.
+    using iterator_concept = std::contiguous_iterator_tag;
+#endif
+    using value_type = std::remove_const_t<ValueType>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = PointerType;
+    using reference = ReferenceType;
+
   public:
+    VectorIterator() : ptr_(nullptr) {}
     VectorIterator(PointerType ptr) : ptr_(ptr) {}
 
+    // Allow an iterator to be converted into a const iterator (but not the
+    // other way around, because the const -> non-const pointer conversion will
+    // fail to compile).
+    template<typename Other,
+      typename = std::enable_if_t<std::is_same_v<const Other, Vector>>>
+    VectorIterator(const VectorIterator<Other>& other) : ptr_(other.get()) {}
+
     /**
      * @brief Define the "pre-fix" increment operator. The pointer is already of
      * the correct type, so this increment will increment the correct number of
@@ -82,19 +117,53 @@ class VectorIterator
      * @param index 
      * @return ReferenceType 
      */
-    ReferenceType operator[](int index) {
+    ReferenceType operator[](difference_type index) const {
       // These two lines are equivalent.
       // return *(ptr_[index]);
       return *(ptr_ + index);
     }
 
+    // Jumping forwards (or backwards) by n elements is just pointer math.
+    VectorIterator& operator+=(difference_type n) {
+      ptr_ += n;
+      return *this;
+    }
+
+    VectorIterator& operator-=(difference_type n) {
+      ptr_ -= n;
+      return *this;
+    }
+
+    VectorIterator operator+(difference_type n) const {
+      return VectorIterator(ptr_ + n);
+    }
+
+    VectorIterator operator-(difference_type n) const {
+      return VectorIterator(ptr_ - n);
+    }
+
+    // Support 'n + it' as well as 'it + n'.
+    friend VectorIterator operator+(difference_type n,
+      const VectorIterator& it) {
+      return it + n;
+    }
+
+    // The distance (in elements) between two iterators.
+    template<typename Other>
+    difference_type operator-(const VectorIterator<Other>& other) const {
+      return ptr_ - other.get();
+    }
+
     /**
      * @brief Define the arrow operator. This will return the current position
      * of the iterator (not the necessarily the beginning).
      * 
      * @return PointerType 
      */
-    PointerType operator->() { return ptr_; }
+    PointerType operator->() const { return ptr_; }
+
+    // Returns the raw pointer that the iterator currently points to.
+    PointerType get() const { return ptr_; }
 
     /**
      * @brief Define the dereference operator. This will return a reference to a
@@ -102,18 +171,41 @@ class VectorIterator
      * 
      * @return ReferenceType 
      */
-    ReferenceType operator*() { return *ptr_; }
+    ReferenceType operator*() const { return *ptr_; }
 
-    // Define the comparison operators.
-    bool operator==(const VectorIterator& other) const {
-      return ptr_ == other.ptr_;
+    // Define the comparison operators. These are templates so that an iterator
+    // can be compared with a const iterator.
+    template<typename Other>
+    bool operator==(const VectorIterator<Other>& other) const {
+      return ptr_ == other.get();
     }
 
     // The NEQ operator just returns the opposite of operator==
-    bool operator!=(const VectorIterator& other) const {
+    template<typename Other>
+    bool operator!=(const VectorIterator<Other>& other) const {
       return !(*this == other);
     }
 
+    template<typename Other>
+    bool operator<(const VectorIterator<Other>& other) const {
+      return ptr_ < other.get();
+    }
+
+    template<typename Other>
+    bool operator>(const VectorIterator<Other>& other) const {
+      return other < *this;
+    }
+
+    template<typename Other>
+    bool operator<=(const VectorIterator<Other>& other) const {
+      return !(other < *this);
+    }
+
+    template<typename Other>
+    bool operator>=(const VectorIterator<Other>& other) const {
+      return !(*this < other);
+    }
+
   private:
     // ptr_ represents the current position of the iterator. There is no need to
     // initialize with 'nullptr' because it's initialized in the VectorIterator
@@ -126,20 +218,74 @@ class VectorIterator
  * std::array.
  * 
  * @tparam T 
+ * @tparam Allocator Any std-compatible allocator (see allocators.h for an
+ * arena, a pool and a thread-local free-list allocator).
+ * @tparam GrowthPolicy Decides the new capacity whenever the Vector runs out
+ * of room (see growth_policy.h).
+ * @tparam Instrumentation A policy that receives "hooks" from the container
+ * (see vector_instrumentation.h). By default this compiles to nothing unless
+ * the DEBUG_INFO option is set.
  */
-template<typename T>
-class Vector
+template<
+  typename T,
+  typename Allocator = std::allocator<T>,
+  typename GrowthPolicy = GrowHalf,
+  typename Instrumentation = DefaultVectorInstrumentation>
+class Vector : private Allocator, private Instrumentation
 {
   public:
     // (video #94) Follow the STL naming convention and use "ValueType".
     using ValueType = T;
-    using Iterator = VectorIterator<Vector<T>>;
+    using AllocatorType = Allocator;
+    using Iterator =
+      VectorIterator<Vector<T, Allocator, GrowthPolicy, Instrumentation>>;
+    using ConstIterator = VectorIterator<
+      const Vector<T, Allocator, GrowthPolicy, Instrumentation>>;
+    using ReverseIterator = std::reverse_iterator<Iterator>;
+    using ConstReverseIterator = std::reverse_iterator<ConstIterator>;
+
+    // The names that generic (STL-style) code expects.
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = Iterator;
+    using const_iterator = ConstIterator;
+
+  private:
+    // Always go through allocator_traits rather than calling the allocator
+    // directly. It fills in the defaults for anything the allocator doesn't
+    // provide itself.
+    using AllocTraits = std::allocator_traits<Allocator>;
 
   public:
-    Vector() {
+    Vector() : Vector(Allocator()) {}
+
+    // Use the given allocator instance for all of our storage. Stateful
+    // allocators (e.g. an ArenaAllocator) are copied into the Vector, so they
+    // should be cheap "handles" to the actual memory resource.
+    explicit Vector(const Allocator& allocator) : Allocator(allocator) {
       // std::cout << "Vector Constructor." << std::endl;
       // To start, allocate enough memory for 2 elements.
-      _reallocate(2);
+      // _reallocate(2);
+
+      // Don't allocate anything until the first element is added. An empty
+      // Vector is now free, and the first allocation is sized by the growth
+      // policy rather than always being 2 elements.
+    }
+
+    /**
+     * @brief Construct an EMPTY Vector with room for at least 'capacity'
+     * elements. NOTE that unlike std::vector(n), this does not create any
+     * elements, it's the same as calling reserve(capacity).
+     *
+     * @param capacity
+     * @param allocator
+     */
+    explicit Vector(size_t capacity, const Allocator& allocator = Allocator())
+      : Allocator(allocator) {
+      reserve(capacity);
     }
 
     // TODO: Support construction via an initializer list.
@@ -158,27 +304,88 @@ class Vector
 
       // 2. Use the version of delete, "operator delete", which will not call
       // the element's destructor.
-      ::operator delete(data_, capacity_ * sizeof(T));
+      // ::operator delete(data_, capacity_ * sizeof(T));
+
+      // 3. Hand the memory back to our allocator, which (like operator delete)
+      // will not call the element's destructor.
+      _deallocate(data_, capacity_);
     }
 
     // Returns the current size of the vector
     size_t size() const { return size_; }
 
+    // Returns the number of elements we have room for without reallocating.
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief Make sure there's room for at least 'new_capacity' elements. Call
+     * this up front if you know how many elements you're about to add and
+     * you'll only pay for one allocation.
+     *
+     * @param new_capacity
+     */
+    void reserve(size_t new_capacity) {
+      if (new_capacity > capacity_) {
+        _reallocate(new_capacity);
+      }
+    }
+
+    /**
+     * @brief Give back any capacity we aren't using. An empty Vector releases
+     * its storage entirely.
+     */
+    void shrink_to_fit() {
+      if (size_ == 0) {
+        _deallocate(data_, capacity_);
+        data_ = nullptr;
+        capacity_ = 0;
+      }
+      else if (size_ < capacity_) {
+        _reallocate(size_);
+      }
+    }
+
+    /**
+     * @brief Change the number of elements to 'new_size'. New elements are
+     * "value-initialized" (zero for int, default constructor for classes) and
+     * surplus elements are destroyed.
+     *
+     * @param new_size
+     */
+    void resize(size_t new_size) {
+      _resize(new_size, [](T* ptr) { new(ptr) T(); });
+    }
+
+    // Same as above, but new elements are copies of 'value'.
+    void resize(size_t new_size, const T& value) {
+      _resize(new_size, [&value](T* ptr) { new(ptr) T(value); });
+    }
+
+    // Returns a copy of the allocator used by this container.
+    Allocator get_allocator() const { return *this; }
+
+    // Provides access to the instrumentation policy, e.g. to query counters.
+    const Instrumentation& instrumentation() const { return *this; }
+    Instrumentation& instrumentation() { return *this; }
+
     /**
      * @brief Pushes back an item by reference.
      * 
      * @param item 
      */
     void push_back(const T& item) {
-      std::cout << "pushing back item '" << item << "' by reference." << 
-        std::endl;
+      Instrumentation::on_push_back(item, "reference");
 
-      // Resize strategy: Grow the vector by half its current size.
+      // Resize strategy: Ask the growth policy (by default, grow the vector by
+      // half its current size).
       if (size_ >= capacity_) {
-        _reallocate(capacity_ + capacity_ / 2);
+        _grow();
       }
 
-      data_[size_] = item;
+      // Same as the r-value version below: data_[size_] is uninitialized
+      // memory, so we have to copy-construct the item with "placement new"
+      // rather than copy-assign it.
+      new(&data_[size_]) T(item);
       size_++;
     }
 
@@ -189,11 +396,11 @@ class Vector
      * @param item 
      */
     void push_back(T&& item) {
-      std::cout << "pushing back item '" << item << "' by r-value reference" << 
-        std::endl;
-      // Resize strategy: Grow the vector by half its current size
+      Instrumentation::on_push_back(item, "r-value reference");
+      // Resize strategy: Ask the growth policy (by default, grow the vector by
+      // half its current size).
       if (size_ >= capacity_) {
-        _reallocate(capacity_ + capacity_ / 2);
+        _grow();
       }
 
       // 1. Note that even though this function accepts 'item' as an r-value
@@ -212,9 +419,10 @@ class Vector
     // To implement 'emplace_back', we need to use "variadic templates".
     template<typename... Args>
     T& emplace_back_inefficient(Args&&... args) {
-      // Resize strategy: Grow the vector by half its current size.
+      // Resize strategy: Ask the growth policy (by default, grow the vector by
+      // half its current size).
       if (size_ >= capacity_) {
-        _reallocate(capacity_ + capacity_ / 2);
+        _grow();
       }
 
       // Forward 'args' to the constructor of T and "unpack" them via '...'.
@@ -241,9 +449,10 @@ class Vector
      */
     template<typename... Args>
     T& emplace_back(Args&&... args) {
-      // Resize strategy: Grow the vector by half its current size
+      // Resize strategy: Ask the growth policy (by default, grow the vector by
+      // half its current size).
       if (size_ >= capacity_) {
-        _reallocate(capacity_ + capacity_ / 2);
+        _grow();
       }
 
       // We can "truly" construct the element "in place" by using the
@@ -281,14 +490,140 @@ class Vector
       size_ = 0;
     }
 
-    // TODO: Add erase() function.
+    /**
+     * @brief Inserts copies of the elements in [first, last) before 'pos' and
+     * returns an iterator to the first inserted element.
+     *
+     * Existing elements are shifted exactly once (with a single memmove for
+     * trivially relocatable types) and there is at most one reallocation, so
+     * inserting n elements costs O(n + size()) rather than the O(n * size())
+     * of inserting them one at a time.
+     *
+     * NOTE: Like std::vector, [first, last) must not point into this Vector.
+     *
+     * @tparam ForwardIt Any iterator that can be traversed more than once.
+     */
+    template<typename ForwardIt>
+    Iterator insert(ConstIterator pos, ForwardIt first, ForwardIt last) {
+      size_t index = pos.get() - data_;
+      size_t n = std::distance(first, last);
+      if (n == 0) {
+        return Iterator(data_ + index);
+      }
+
+      if (size_ + n > capacity_) {
+        // Build the new block in one go: the inserted elements first, then the
+        // existing elements on either side of the gap.
+        size_t new_capacity = GrowthPolicy::grow(capacity_, size_ + n,
+          sizeof(T));
+        Instrumentation::on_reallocate(size_, capacity_, new_capacity,
+          size_ * sizeof(T));
+        T* new_block = AllocTraits::allocate(_allocator(), new_capacity);
+        _construct_range(new_block + index, first, last);
+        relocate(data_, index, new_block);
+        relocate(data_ + index, size_ - index, new_block + index + n);
+        _deallocate(data_, capacity_);
+        data_ = new_block;
+        capacity_ = new_capacity;
+      }
+      else {
+        // Open up a gap by shifting the tail right, then fill it in.
+        relocate_overlapping(data_ + index, size_ - index,
+          data_ + index + n);
+        _construct_range(data_ + index, first, last);
+      }
+
+      size_ += n;
+      return Iterator(data_ + index);
+    }
+
+    /**
+     * @brief Appends copies of the elements in [first, last) to the end of the
+     * Vector with at most one reallocation.
+     */
+    template<typename ForwardIt>
+    void append_range(ForwardIt first, ForwardIt last) {
+      insert(end(), first, last);
+    }
 
-    // TODO: Add insert() function.
+    // Same as above for anything that works with std::begin/std::end, e.g. a
+    // std::vector or a C array.
+    template<typename Range>
+    void append_range(const Range& range) {
+      append_range(std::begin(range), std::end(range));
+    }
+
+    /**
+     * @brief Removes the elements in [first, last) and returns an iterator to
+     * the element that followed the last removed element. The remaining tail
+     * is shifted left exactly once.
+     */
+    Iterator erase(ConstIterator first, ConstIterator last) {
+      T* gap_begin = data_ + (first.get() - data_);
+      T* gap_end = data_ + (last.get() - data_);
+      for (T* ptr = gap_begin; ptr != gap_end; ptr++) {
+        ptr->~T();
+      }
+      relocate_overlapping(gap_end,
+        static_cast<size_t>(data_ + size_ - gap_end), gap_begin);
+      size_ -= gap_end - gap_begin;
+      return Iterator(gap_begin);
+    }
+
+    // Removes a single element.
+    Iterator erase(ConstIterator pos) {
+      return erase(pos, pos + 1);
+    }
+
+    /**
+     * @brief Removes every element for which 'predicate' returns true and
+     * returns the number of elements removed. Survivors keep their relative
+     * order and each one is moved at most once.
+     *
+     * @tparam Predicate A callable taking a const T&.
+     */
+    template<typename Predicate>
+    size_t erase_if(Predicate predicate) {
+      size_t write = 0;
+      for (size_t read = 0; read < size_; read++) {
+        if (predicate(static_cast<const T&>(data_[read]))) {
+          data_[read].~T();
+        }
+        else {
+          if (write != read) {
+            relocate(&data_[read], 1, &data_[write]);
+          }
+          write++;
+        }
+      }
+      size_t removed = size_ - write;
+      size_ = write;
+      return removed;
+    }
 
     // (video #94) Support iteration.
     Iterator begin() { return Iterator(data_); }
     Iterator end() { return Iterator(data_ + size_); }
 
+    // Iterating over a const Vector yields const iterators.
+    ConstIterator begin() const { return ConstIterator(data_); }
+    ConstIterator end() const { return ConstIterator(data_ + size_); }
+    ConstIterator cbegin() const { return begin(); }
+    ConstIterator cend() const { return end(); }
+
+    // Reverse iteration. The STL's reverse_iterator adaptor works with any
+    // bidirectional iterator, so we don't need to write our own.
+    ReverseIterator rbegin() { return ReverseIterator(end()); }
+    ReverseIterator rend() { return ReverseIterator(begin()); }
+    ConstReverseIterator rbegin() const { return ConstReverseIterator(end()); }
+    ConstReverseIterator rend() const { return ConstReverseIterator(begin()); }
+    ConstReverseIterator crbegin() const { return rbegin(); }
+    ConstReverseIterator crend() const { return rend(); }
+
+    // Direct access to the underlying (contiguous) storage.
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+
     // Support indexing into our vector (const and non-const versions are
     // effectively a getter and setter, respectively).
     const T& operator[](size_t index) const {
@@ -306,9 +641,41 @@ class Vector
     
 
   private:
+    // Copy-construct the elements of [first, last) into uninitialized memory.
+    template<typename ForwardIt>
+    static void _construct_range(T* dest, ForwardIt first, ForwardIt last) {
+      for (; first != last; ++first, ++dest) {
+        new(dest) T(*first);
+      }
+    }
+
+    // Grow to make room for (at least) one more element.
+    void _grow() {
+      _reallocate(GrowthPolicy::grow(capacity_, size_ + 1, sizeof(T)));
+    }
+
+    template<typename Construct>
+    void _resize(size_t new_size, Construct construct) {
+      if (new_size > capacity_) {
+        // Use the growth policy unless that still isn't enough, in which case
+        // allocate exactly what was asked for.
+        _reallocate(GrowthPolicy::grow(capacity_, new_size, sizeof(T)));
+      }
+      for (size_t idx = size_; idx < new_size; idx++) {
+        construct(&data_[idx]);
+      }
+      for (size_t idx = new_size; idx < size_; idx++) {
+        data_[idx].~T();
+      }
+      size_ = new_size;
+    }
+
     void _reallocate(size_t new_capacity) {
-      std::cout << "Vector Container resizing from '" << size_ << 
-        "' elements to '" << new_capacity << "' elements." << std::endl;
+      // Let the instrumentation policy know what's about to happen. Note that
+      // this used to be an unconditional write to std::cout, which cost far
+      // more than the reallocation itself!
+      Instrumentation::on_reallocate(size_, capacity_, new_capacity,
+        (new_capacity < size_ ? new_capacity : size_) * sizeof(T));
 
       // 1a. Allocate a new block of memory. Note that we could chose to use a
       // unique pointer here, but when working with "low-level" data structures,
@@ -322,7 +689,12 @@ class Vector
       // Why? Because "operator new" does not call the T constructor. Note that 
       // operator new returns void, so we need to cast it to a T*
       // T* new_block = (T*)::operator new(new_capacity * sizeof(T));
-      T* new_block = static_cast<T*>(::operator new(new_capacity * sizeof(T)));
+      // T* new_block = static_cast<T*>(::operator new(new_capacity * sizeof(T)));
+
+      // 1c. Ask our allocator for the memory instead. The default allocator
+      // (std::allocator) just calls "operator new" for us, but this lets users
+      // plug in something faster, e.g. an arena.
+      T* new_block = AllocTraits::allocate(_allocator(), new_capacity);
 
       // TODO: For some reason, ::operator new is allocating a 'new_block' of
       // size 8 instead of size 64. Not sure what's going on here. Posted a
@@ -338,6 +710,11 @@ class Vector
       // TODO: Note that supporting downsizing may be better implemented
       // elsewhere (where?), but we'll do it here for now.
       if (new_capacity < size_) {
+        // Destroy the elements that no longer fit, otherwise any resources
+        // they own would be leaked.
+        for (size_t idx = new_capacity; idx < size_; idx++) {
+          data_[idx].~T();
+        }
         size_ = new_capacity;
       }
 
@@ -347,47 +724,74 @@ class Vector
       // primitive types (int, float), we could use memcpy, but for more complex
       // types like classes, we need to ensure that they are copied "correctly",
       // i.e. according to their own implementation of the copy constructor.
-      for (size_t idx = 0; idx < size_; idx++) {
-        // 2a. Copy data from old block to new block (bad strategy)
-        // new_block[idx] = data_[idx];
-
-        // 2b. Using std::move here instead of copying is perfectly safe to do
-        // because in the event that the type being moved does not define a move
-        // constructor, its copy constructor will be used instead. So this is
-        // really saying, "in the best case scenario, use the move constructor,
-        // but if it's not defined use the copy constructor as a fallback."
-        // new_block[idx] = std::move(data_[idx]);
-
-        // 2c. (from Nikiux133's YouTube comment) You can't use assignment
-        // operator here (either move or copy) because new_block[idx] is 
-        // uninitialized memory - it is not the object of type T, and by calling
-        // operator= (again move or not) you treat it as if it is an object of
-        // type T. So instead of that you should use "placement new" again.
-        new(&new_block[idx]) T(std::move(data_[idx]));
+      //
+      // ...unless T is "trivially relocatable" (see traits.h), in which case a
+      // move followed by a destroy is exactly the same thing as a byte copy. We
+      // make that decision at compile-time with 'if constexpr', so the slow
+      // path isn't even compiled for types like int, float and Vec2.
+      if constexpr (is_trivially_relocatable_v<T>) {
+        // Guard against memcpy'ing from a nullptr on the very first allocation.
+        if (size_ > 0) {
+          std::memcpy(static_cast<void*>(new_block), data_, size_ * sizeof(T));
+        }
       }
-
-      // 3a. Delete the old block of memory.
-      // delete[] data_;
-
-      // 3b. Manually call the destructor for each item in the "moved from" data
-      // block. Note that this was added at the same time as moving to "operator
-      // new" and "operator delete" from the standard new/delete. This is the
-      // same as calling Clear(), but it does not set t he size_ to zero.
-      for (size_t idx = 0; idx < size_; idx++) {
-        data_[idx].~T();
+      else {
+        for (size_t idx = 0; idx < size_; idx++) {
+          // 2a. Copy data from old block to new block (bad strategy)
+          // new_block[idx] = data_[idx];
+
+          // 2b. Using std::move here instead of copying is perfectly safe to do
+          // because in the event that the type being moved does not define a
+          // move constructor, its copy constructor will be used instead. So
+          // this is really saying, "in the best case scenario, use the move
+          // constructor, but if it's not defined use the copy constructor as a
+          // fallback."
+          // new_block[idx] = std::move(data_[idx]);
+
+          // 2c. (from Nikiux133's YouTube comment) You can't use assignment
+          // operator here (either move or copy) because new_block[idx] is 
+          // uninitialized memory - it is not the object of type T, and by
+          // calling operator= (again move or not) you treat it as if it is an
+          // object of type T. So instead of that you should use "placement new"
+          // again.
+          new(&new_block[idx]) T(std::move(data_[idx]));
+        }
+
+        // 3a. Delete the old block of memory.
+        // delete[] data_;
+
+        // 3b. Manually call the destructor for each item in the "moved from"
+        // data block. Note that this was added at the same time as moving to
+        // "operator new" and "operator delete" from the standard new/delete.
+        // This is the same as calling Clear(), but it does not set t he size_
+        // to zero. The trivially relocatable path skips this step because the
+        // bytes now "belong" to the elements in the new block.
+        for (size_t idx = 0; idx < size_; idx++) {
+          data_[idx].~T();
+        }
       }
 
       // 3b. Use "operator delete" instead of the method above. Why? Because 
       // "operator delete" does not call the T destructor. We do that manually
       // in the forloop above, so we want to make sure that we don't attempt to
       // free memory that's already been freed.
-      ::operator delete(data_, capacity_ * sizeof(T));
+      // ::operator delete(data_, capacity_ * sizeof(T));
+      _deallocate(data_, capacity_);
 
       // 4. Update the data block and capacity.
       data_ = new_block;
       capacity_ = new_capacity;
     }
 
+    Allocator& _allocator() { return *this; }
+
+    void _deallocate(T* block, size_t capacity) {
+      // Unlike operator delete, an allocator isn't required to accept nullptr.
+      if (block) {
+        AllocTraits::deallocate(_allocator(), block, capacity);
+      }
+    }
+
     // Store a pointer to the allocated memory
     T* data_{nullptr};
 
@@ -402,11 +806,30 @@ class Vector
 // Template functions MUST be defined in a header file (I'm pretty sure?). We
 // cannot separate a template function's declaration (typically in a .h) from
 // its definition (typically in a .cpp). 
-template<typename T>
-void print_vector(const Vector<T>& vector) {
+template<
+  typename T,
+  typename Allocator,
+  typename GrowthPolicy,
+  typename Instrumentation>
+void print_vector(
+  const Vector<T, Allocator, GrowthPolicy, Instrumentation>& vector) {
   std::cout << "-------------------------------------------------" << std::endl;
   for (size_t idx = 0; idx < vector.size(); idx++) {
     std::cout << vector[idx] << std::endl;
   }
   std::cout << "-------------------------------------------------" << std::endl;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Mirrors C++20's std::erase_if for our Vector.
+ */
+template<
+  typename T,
+  typename Allocator,
+  typename GrowthPolicy,
+  typename Instrumentation,
+  typename Predicate>
+size_t erase_if(Vector<T, Allocator, GrowthPolicy, Instrumentation>& vector,
+  Predicate predicate) {
+  return vector.erase_if(predicate);
+}
@@ -0,0 +1,92 @@
+/*
+ * Instrumentation policies for our custom Vector container.
+ *
+ * Vector calls a small set of "hooks" on its instrumentation policy whenever
+ * something interesting happens (an item is pushed back, the storage is
+ * reallocated). Every hook of the default policy is an empty inline function,
+ * so in a Release build the calls compile away to nothing.
+ */
+#pragma once
+
+// Include to get 'size_t'
+#include <cstddef>
+#include <iostream>
+
+/**
+ * @brief The "do nothing" policy. Vector privately inherits from its
+ * instrumentation policy, so thanks to the "empty base optimization" this
+ * policy doesn't even cost us a byte of storage.
+ */
+struct NoInstrumentation
+{
+  template<typename T>
+  void on_push_back(const T& /*item*/, const char* /*how*/) {}
+
+  void on_reallocate(size_t /*size*/, size_t /*old_capacity*/,
+    size_t /*new_capacity*/, size_t /*bytes_moved*/) {}
+};
+
+/**
+ * @brief Prints the same diagnostics that Vector used to unconditionally write
+ * to std::cout. Only useful for learning what the container is doing!
+ */
+struct LogInstrumentation
+{
+  template<typename T>
+  void on_push_back(const T& item, const char* how) {
+    std::cout << "pushing back item '" << item << "' by " << how << "." <<
+      std::endl;
+  }
+
+  void on_reallocate(size_t size, size_t /*old_capacity*/,
+    size_t new_capacity, size_t /*bytes_moved*/) {
+    std::cout << "Vector Container resizing from '" << size <<
+      "' elements to '" << new_capacity << "' elements." << std::endl;
+  }
+};
+
+/**
+ * @brief Records a few cheap counters that can be queried at runtime, e.g.
+ *
+ *   Vector<int, std::allocator<int>, GrowHalf, CountingInstrumentation> vec;
+ *   ...
+ *   vec.instrumentation().reallocations();
+ */
+struct CountingInstrumentation
+{
+  public:
+    template<typename T>
+    void on_push_back(const T& /*item*/, const char* /*how*/) {}
+
+    void on_reallocate(size_t /*size*/, size_t /*old_capacity*/,
+      size_t new_capacity, size_t bytes_moved) {
+      reallocations_++;
+      bytes_moved_ += bytes_moved;
+      if (new_capacity > peak_capacity_) {
+        peak_capacity_ = new_capacity;
+      }
+    }
+
+    // The number of times the storage was (re)allocated.
+    size_t reallocations() const { return reallocations_; }
+
+    // The total number of bytes moved from an old block into a new block.
+    size_t bytes_moved() const { return bytes_moved_; }
+
+    // The largest capacity (in elements) the container has ever had.
+    size_t peak_capacity() const { return peak_capacity_; }
+
+    void reset() { *this = CountingInstrumentation(); }
+
+  private:
+    size_t reallocations_{0};
+    size_t bytes_moved_{0};
+    size_t peak_capacity_{0};
+};
+
+// Mirror the LOG macro in utils.h: only print if the DEBUG_INFO option is set.
+#ifdef DEBUG_INFO
+  using DefaultVectorInstrumentation = LogInstrumentation;
+#else
+  using DefaultVectorInstrumentation = NoInstrumentation;
+#endif
@@ -0,0 +1,206 @@
+#include "allocators.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace
+{
+  // Rounds 'value' up to the next multiple of 'alignment' (a power of two).
+  size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+  }
+
+  // Returns the index of the smallest power-of-two size class that fits
+  // 'bytes', starting at 'min_size'.
+  size_t size_class_index(size_t bytes, size_t min_size) {
+    size_t index = 0;
+    size_t class_size = min_size;
+    while (class_size < bytes) {
+      class_size <<= 1;
+      index++;
+    }
+    return index;
+  }
+}
+
+/*
+ * Arena
+ */
+Arena::Arena(size_t chunk_size) : chunk_size_(chunk_size) {}
+
+Arena::~Arena() {
+  for (Chunk& chunk : chunks_) {
+    ::operator delete(chunk.data);
+  }
+}
+
+void* Arena::allocate(size_t bytes, size_t alignment) {
+  // Try to fit the request into the current chunk, then into any chunk left
+  // over from before the last reset().
+  while (current_ < chunks_.size()) {
+    Chunk& chunk = chunks_[current_];
+    uintptr_t base = reinterpret_cast<uintptr_t>(chunk.data);
+    size_t start = align_up(base + offset_, alignment) - base;
+    if (start + bytes <= chunk.size) {
+      offset_ = start + bytes;
+      return chunk.data + start;
+    }
+    current_++;
+    offset_ = 0;
+  }
+
+  // Out of chunks, so grab a new one from the system. Chunks grow
+  // geometrically so that the number of chunks stays logarithmic.
+  size_t size = std::max(chunk_size_, bytes + alignment);
+  chunk_size_ *= 2;
+  chunks_.push_back({static_cast<char*>(::operator new(size)), size});
+  current_ = chunks_.size() - 1;
+  offset_ = 0;
+  return allocate(bytes, alignment);
+}
+
+void Arena::reset() {
+  current_ = 0;
+  offset_ = 0;
+}
+
+size_t Arena::capacity() const {
+  size_t total = 0;
+  for (const Chunk& chunk : chunks_) {
+    total += chunk.size;
+  }
+  return total;
+}
+
+/*
+ * Pool
+ */
+Pool::~Pool() {
+  for (void* chunk : chunks_) {
+    ::operator delete(chunk);
+  }
+}
+
+void* Pool::allocate(size_t bytes) {
+  if (bytes > kMaxClassSize) {
+    return ::operator new(bytes);
+  }
+
+  size_t index = size_class_index(bytes, kMinClassSize);
+  if (FreeBlock* block = free_lists_[index]) {
+    free_lists_[index] = block->next;
+    return block;
+  }
+  return _refill(index);
+}
+
+void Pool::deallocate(void* ptr, size_t bytes) {
+  if (!ptr) {
+    return;
+  }
+  if (bytes > kMaxClassSize) {
+    ::operator delete(ptr);
+    return;
+  }
+
+  // Push the block onto the front of its size class's free-list.
+  size_t index = size_class_index(bytes, kMinClassSize);
+  FreeBlock* block = static_cast<FreeBlock*>(ptr);
+  block->next = free_lists_[index];
+  free_lists_[index] = block;
+}
+
+void* Pool::_refill(size_t index) {
+  // Carve a new chunk into blocks of this size class. Small classes get many
+  // blocks per chunk, the largest classes get a handful.
+  size_t class_size = kMinClassSize << index;
+  size_t n_blocks = std::max<size_t>(4, kMaxClassSize / class_size);
+  char* chunk = static_cast<char*>(::operator new(class_size * n_blocks));
+  chunks_.push_back(chunk);
+
+  // Hand out the first block and put the rest on the free-list.
+  for (size_t idx = n_blocks - 1; idx > 0; idx--) {
+    FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + idx * class_size);
+    block->next = free_lists_[index];
+    free_lists_[index] = block;
+  }
+  return chunk;
+}
+
+/*
+ * Thread-local free-lists
+ */
+namespace
+{
+  /**
+   * @brief The free-lists owned by a single thread. Blocks are allocated with
+   * operator new (rounded up to a size class), so a block freed on this
+   * thread can safely be reused here regardless of which thread allocated it.
+   */
+  struct ThreadCache
+  {
+    static constexpr size_t kMinClassSize = 16;
+    static constexpr size_t kNumClasses = 13;
+    static constexpr size_t kMaxClassSize = kMinClassSize << (kNumClasses - 1);
+
+    // Don't let a single thread hoard an unbounded amount of memory.
+    static constexpr size_t kMaxCachedBlocks = 64;
+
+    struct FreeBlock
+    {
+      FreeBlock* next;
+    };
+
+    FreeBlock* free_lists_[kNumClasses]{};
+    size_t counts_[kNumClasses]{};
+
+    // Give everything back to the system when the thread exits.
+    ~ThreadCache() {
+      for (FreeBlock* block : free_lists_) {
+        while (block) {
+          FreeBlock* next = block->next;
+          ::operator delete(block);
+          block = next;
+        }
+      }
+    }
+  };
+
+  thread_local ThreadCache t_cache;
+}
+
+void* thread_local_allocate(size_t bytes) {
+  if (bytes > ThreadCache::kMaxClassSize) {
+    return ::operator new(bytes);
+  }
+
+  size_t index = size_class_index(bytes, ThreadCache::kMinClassSize);
+  if (ThreadCache::FreeBlock* block = t_cache.free_lists_[index]) {
+    t_cache.free_lists_[index] = block->next;
+    t_cache.counts_[index]--;
+    return block;
+  }
+  return ::operator new(ThreadCache::kMinClassSize << index);
+}
+
+void thread_local_deallocate(void* ptr, size_t bytes) {
+  if (!ptr) {
+    return;
+  }
+
+  if (bytes > ThreadCache::kMaxClassSize) {
+    ::operator delete(ptr);
+    return;
+  }
+
+  size_t index = size_class_index(bytes, ThreadCache::kMinClassSize);
+  if (t_cache.counts_[index] >= ThreadCache::kMaxCachedBlocks) {
+    ::operator delete(ptr);
+    return;
+  }
+
+  auto* block = static_cast<ThreadCache::FreeBlock*>(ptr);
+  block->next = t_cache.free_lists_[index];
+  t_cache.free_lists_[index] = block;
+  t_cache.counts_[index]++;
+}
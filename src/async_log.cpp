@@ -0,0 +1,138 @@
+#include "async_log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+namespace
+{
+  const char* level_prefix(Logger::LogLevel level) {
+    switch (level) {
+      case Logger::ERROR: return "[ERROR]: ";
+      case Logger::WARNING: return "[WARNING]: ";
+      default: return "[INFO]: ";
+    }
+  }
+}
+
+AsyncLogBackend::AsyncLogBackend(std::ostream& sink)
+  : AsyncLogBackend(sink, Options()) {}
+
+AsyncLogBackend::AsyncLogBackend(std::ostream& sink, const Options& options)
+  : sink_(sink), options_(options), buffer_(options.capacity) {
+  // Start the writer last, once every other member has been initialized.
+  writer_ = std::thread(&AsyncLogBackend::_writer_loop, this);
+}
+
+AsyncLogBackend::~AsyncLogBackend() {
+  stopping_.store(true);
+  _wake_writer();
+  writer_.join();
+}
+
+bool AsyncLogBackend::enqueue(Logger::LogLevel level, const char* message) {
+  // Copy the message straight into the ring buffer slot.
+  auto fill = [level, message](LogRecord& record) {
+    size_t length = std::strlen(message);
+    length = std::min(length, LogRecord::kMaxMessageLength);
+    record.level = level;
+    record.length = static_cast<uint16_t>(length);
+    std::memcpy(record.message, message, length);
+  };
+
+  while (!buffer_.try_push(fill)) {
+    switch (options_.overflow_policy) {
+      case DROP:
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+
+      case OVERWRITE_OLDEST:
+        // Make room by throwing away the oldest message ourselves.
+        if (buffer_.try_pop([](LogRecord&) {})) {
+          dropped_.fetch_add(1, std::memory_order_relaxed);
+          consumed_.fetch_add(1, std::memory_order_release);
+        }
+        break;
+
+      case BLOCK:
+      default:
+        _wake_writer();
+        std::this_thread::yield();
+        break;
+    }
+  }
+
+  pushed_.fetch_add(1, std::memory_order_release);
+  // Pairs with the fence in _writer_loop(). Each side stores (we push, the
+  // writer sets its flag) and then loads what the other one stored, which
+  // release/acquire alone doesn't order: without the fences, the writer could
+  // see an empty queue while we see it awake, and the message would wait for
+  // the timeout.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (writer_sleeping_.load(std::memory_order_relaxed)) {
+    _wake_writer();
+  }
+  return true;
+}
+
+void AsyncLogBackend::flush() {
+  uint64_t target = pushed_.load(std::memory_order_acquire);
+  while (consumed_.load(std::memory_order_acquire) < target) {
+    _wake_writer();
+    std::this_thread::yield();
+  }
+}
+
+void AsyncLogBackend::_wake_writer() {
+  // Taking the lock (even briefly) makes sure that the writer is either
+  // already waiting, or hasn't yet re-checked the queue, so the notification
+  // can't get lost.
+  { std::lock_guard<std::mutex> lock(mutex_); }
+  wake_up_.notify_one();
+}
+
+void AsyncLogBackend::_writer_loop() {
+  std::string batch;
+  batch.reserve(options_.max_batch_size * (LogRecord::kMaxMessageLength + 16));
+
+  auto append = [&batch](LogRecord& record) {
+    batch.append(level_prefix(record.level));
+    batch.append(record.message, record.length);
+    batch.push_back('\n');
+  };
+
+  while (true) {
+    // Drain up to one batch worth of messages.
+    batch.clear();
+    size_t n_messages = 0;
+    while (n_messages < options_.max_batch_size && buffer_.try_pop(append)) {
+      n_messages++;
+    }
+
+    if (n_messages > 0) {
+      sink_.write(batch.data(), batch.size());
+      sink_.flush();
+      consumed_.fetch_add(n_messages, std::memory_order_release);
+      continue;
+    }
+
+    // Nothing to do. Only exit once we've been asked to AND the queue is
+    // empty, so that nothing logged before destruction is lost.
+    if (stopping_.load()) {
+      return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    writer_sleeping_.store(true, std::memory_order_relaxed);
+    // Re-check after announcing that we're asleep, in case a producer pushed
+    // in between. The fence pairs with the one in enqueue(): either we see its
+    // message here, or it sees the flag and wakes us. The timeout is a safety
+    // net, not a polling interval.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (buffer_.empty() && !stopping_.load()) {
+      wake_up_.wait_for(lock, std::chrono::milliseconds(100));
+    }
+    writer_sleeping_.store(false, std::memory_order_release);
+  }
+}
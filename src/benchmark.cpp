@@ -0,0 +1,566 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+
+namespace bench
+{
+  namespace
+  {
+    struct Registration
+    {
+      const char* name;
+      BenchmarkFunction fn;
+    };
+
+    // A function-local static, so that benchmarks registered during static
+    // initialization in other translation units can't run into an
+    // uninitialized list.
+    std::vector<Registration>& registry() {
+      static std::vector<Registration> benchmarks;
+      return benchmarks;
+    }
+
+    // Nanoseconds taken to run 'fn' for 'iterations' iterations. If given,
+    // 'counters' count (only) the same stretch, and the counts are added to
+    // 'counts'.
+    double time_once(BenchmarkFunction fn, size_t iterations,
+      PerfCounters* counters = nullptr,
+      PerfCounters::Sample* counts = nullptr) {
+      State state(iterations);
+      if (counters) {
+        counters->start();
+      }
+      clobber_memory();
+      auto start = std::chrono::steady_clock::now();
+      fn(state);
+      clobber_memory();
+      auto end = std::chrono::steady_clock::now();
+      if (counters) {
+        counters->stop();
+        *counts += counters->read();
+      }
+      return std::chrono::duration<double, std::nano>(end - start).count();
+    }
+
+    // The JSON/CSV key for each PerfCounters::Event.
+    const char* counter_key(PerfCounters::Event event) {
+      switch (event) {
+        case PerfCounters::CYCLES: return "cycles";
+        case PerfCounters::INSTRUCTIONS: return "instructions";
+        case PerfCounters::CACHE_MISSES: return "cache_misses";
+        default: return "branch_misses";
+      }
+    }
+
+    bool has_counters(const std::vector<Result>& results) {
+      for (const Result& result : results) {
+        for (size_t event = 0; event < PerfCounters::N_EVENTS; event++) {
+          if (result.counters.has(PerfCounters::Event(event))) {
+            return true;
+          }
+        }
+      }
+      return false;
+    }
+
+    double median(std::vector<double> values) {
+      std::sort(values.begin(), values.end());
+      size_t middle = values.size() / 2;
+      if (values.size() % 2 == 0) {
+        return (values[middle - 1] + values[middle]) / 2.0;
+      }
+      return values[middle];
+    }
+
+    // Names are identifiers, but don't let an odd one corrupt the output.
+    std::string escape_json(const std::string& text) {
+      std::string escaped;
+      for (char c : text) {
+        if (c == '"' || c == '\\') {
+          escaped.push_back('\\');
+        }
+        escaped.push_back(c);
+      }
+      return escaped;
+    }
+
+    // Just enough JSON to read our own output back in (and survive someone
+    // editing it by hand).
+    struct JsonValue
+    {
+      enum Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+      Type type = NUL;
+      double value = 0.0;
+      std::string text;
+      std::vector<JsonValue> items;
+      std::vector<std::pair<std::string, JsonValue>> members;
+
+      const JsonValue* find(const char* key) const {
+        for (const auto& [name, member] : members) {
+          if (name == key) {
+            return &member;
+          }
+        }
+        return nullptr;
+      }
+
+      // The number stored under 'key', or 0 if there isn't one.
+      double number(const char* key) const {
+        const JsonValue* member = find(key);
+        return member && member->type == NUMBER ? member->value : 0.0;
+      }
+    };
+
+    class JsonParser
+    {
+      public:
+        explicit JsonParser(const std::string& text) : text_(text) {}
+
+        JsonValue parse() {
+          JsonValue value = _value();
+          _skip_whitespace();
+          if (pos_ != text_.size()) {
+            _fail("unexpected trailing characters");
+          }
+          return value;
+        }
+
+      private:
+        [[noreturn]] void _fail(const char* what) {
+          throw std::runtime_error("invalid JSON at offset " +
+            std::to_string(pos_) + ": " + what + ".");
+        }
+
+        void _skip_whitespace() {
+          while (pos_ < text_.size() && std::isspace(
+              static_cast<unsigned char>(text_[pos_]))) {
+            pos_++;
+          }
+        }
+
+        bool _consume(char c) {
+          _skip_whitespace();
+          if (pos_ < text_.size() && text_[pos_] == c) {
+            pos_++;
+            return true;
+          }
+          return false;
+        }
+
+        void _expect(char c) {
+          if (!_consume(c)) {
+            _fail((std::string("expected '") + c + "'").c_str());
+          }
+        }
+
+        bool _keyword(const char* word) {
+          size_t length = std::strlen(word);
+          if (text_.compare(pos_, length, word) == 0) {
+            pos_ += length;
+            return true;
+          }
+          return false;
+        }
+
+        std::string _string() {
+          _expect('"');
+          std::string out;
+          while (pos_ < text_.size() && text_[pos_] != '"') {
+            char c = text_[pos_++];
+            if (c == '\\' && pos_ < text_.size()) {
+              char escaped = text_[pos_++];
+              switch (escaped) {
+                case 'n': out.push_back('\n'); break;
+                case 't': out.push_back('\t'); break;
+                // Other escapes (including \uXXXX) are kept as they are.
+                case '"': case '\\': case '/': out.push_back(escaped); break;
+                default: out.push_back('\\'); out.push_back(escaped); break;
+              }
+            }
+            else {
+              out.push_back(c);
+            }
+          }
+          _expect('"');
+          return out;
+        }
+
+        JsonValue _value() {
+          _skip_whitespace();
+          if (pos_ >= text_.size()) {
+            _fail("unexpected end of input");
+          }
+
+          JsonValue value;
+          char c = text_[pos_];
+          if (c == '{') {
+            pos_++;
+            value.type = JsonValue::OBJECT;
+            if (!_consume('}')) {
+              do {
+                std::string key = _string();
+                _expect(':');
+                value.members.emplace_back(std::move(key), _value());
+              } while (_consume(','));
+              _expect('}');
+            }
+          }
+          else if (c == '[') {
+            pos_++;
+            value.type = JsonValue::ARRAY;
+            if (!_consume(']')) {
+              do {
+                value.items.push_back(_value());
+              } while (_consume(','));
+              _expect(']');
+            }
+          }
+          else if (c == '"') {
+            value.type = JsonValue::STRING;
+            value.text = _string();
+          }
+          else if (_keyword("true")) {
+            value.type = JsonValue::BOOLEAN;
+            value.value = 1.0;
+          }
+          else if (_keyword("false")) {
+            value.type = JsonValue::BOOLEAN;
+          }
+          else if (_keyword("null")) {
+            value.type = JsonValue::NUL;
+          }
+          else {
+            const char* start = text_.c_str() + pos_;
+            char* end = nullptr;
+            value.type = JsonValue::NUMBER;
+            value.value = std::strtod(start, &end);
+            if (end == start) {
+              _fail("expected a value");
+            }
+            pos_ += end - start;
+          }
+          return value;
+        }
+
+        const std::string& text_;
+        size_t pos_{0};
+    };
+  }
+
+  bool register_benchmark(const char* name, BenchmarkFunction fn) {
+    registry().push_back({ name, fn });
+    return true;
+  }
+
+  Result run(const char* name, BenchmarkFunction fn, const Options& options) {
+    const double min_time = options.min_time_ms * 1e6;
+
+    // 1. Calibrate: grow the iteration count until one repetition takes long
+    // enough to time accurately, aiming a little past the minimum.
+    size_t iterations = 1;
+    double elapsed = time_once(fn, iterations);
+    while (elapsed < min_time) {
+      double scale = elapsed > 0.0 ? 1.2 * min_time / elapsed : 10.0;
+      scale = std::min(std::max(scale, 2.0), 10.0);
+      iterations = static_cast<size_t>(std::ceil(iterations * scale));
+      elapsed = time_once(fn, iterations);
+    }
+
+    // 2. Warm up.
+    auto warmup_start = std::chrono::steady_clock::now();
+    while (std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - warmup_start).count() <
+        options.warmup_ms) {
+      time_once(fn, iterations);
+    }
+
+    // 3. Measure.
+    Result result;
+    result.name = name;
+    result.iterations = iterations;
+    size_t repetitions = std::max<size_t>(options.repetitions, 1);
+
+    std::unique_ptr<PerfCounters> counters;
+    if (options.perf_counters) {
+      counters = std::make_unique<PerfCounters>();
+      static bool s_warned = false;
+      if (!counters->available() && !s_warned) {
+        std::cerr << "Hardware counters unavailable (" << counters->error() <<
+          "), reporting times only." << std::endl;
+        s_warned = true;
+      }
+      if (!counters->available()) {
+        counters.reset();
+      }
+    }
+
+    for (size_t rep = 0; rep < repetitions; rep++) {
+      result.samples.push_back(
+        time_once(fn, iterations, counters.get(), &result.counters) /
+        iterations);
+    }
+    result.counters /= static_cast<double>(repetitions * iterations);
+
+    result.median = median(result.samples);
+    std::vector<double> deviations;
+    for (double sample : result.samples) {
+      deviations.push_back(std::abs(sample - result.median));
+    }
+    result.mad = median(deviations);
+    auto [min, max] =
+      std::minmax_element(result.samples.begin(), result.samples.end());
+    result.min = *min;
+    result.max = *max;
+    return result;
+  }
+
+  std::vector<Result> run_all(const Options& options) {
+    std::vector<Result> results;
+    for (const Registration& benchmark : registry()) {
+      if (std::strstr(benchmark.name, options.filter.c_str())) {
+        results.push_back(run(benchmark.name, benchmark.fn, options));
+      }
+    }
+    return results;
+  }
+
+  void write_table(std::ostream& out, const std::vector<Result>& results) {
+    out << std::left << std::setw(32) << "benchmark" << std::right <<
+      std::setw(14) << "median (ns)" << std::setw(12) << "MAD (ns)" <<
+      std::setw(8) << "MAD %" << std::setw(12) << "min (ns)" <<
+      std::setw(12) << "max (ns)" << std::setw(12) << "iterations";
+    const bool counters = has_counters(results);
+    if (counters) {
+      out << std::setw(12) << "cycles" << std::setw(8) << "IPC" <<
+        std::setw(12) << "LLC misses" << std::setw(12) << "br misses";
+    }
+    out << std::endl;
+    for (const Result& result : results) {
+      double mad_percent =
+        result.median > 0.0 ? 100.0 * result.mad / result.median : 0.0;
+      out << std::left << std::setw(32) << result.name << std::right <<
+        std::fixed << std::setprecision(2) <<
+        std::setw(14) << result.median <<
+        std::setw(12) << result.mad <<
+        std::setw(8) << std::setprecision(1) << mad_percent <<
+        std::setprecision(2) <<
+        std::setw(12) << result.min <<
+        std::setw(12) << result.max <<
+        std::setw(12) << result.iterations;
+      if (counters) {
+        // Per iteration, "-" for counters this machine doesn't have.
+        auto column = [&out, &result](PerfCounters::Event event, int width) {
+          if (result.counters.has(event)) {
+            out << std::setw(width) << result.counters[event];
+          }
+          else {
+            out << std::setw(width) << "-";
+          }
+        };
+        column(PerfCounters::CYCLES, 12);
+        if (result.counters.ipc() > 0.0) {
+          out << std::setw(8) << result.counters.ipc();
+        }
+        else {
+          out << std::setw(8) << "-";
+        }
+        column(PerfCounters::CACHE_MISSES, 12);
+        column(PerfCounters::BRANCH_MISSES, 12);
+      }
+      out << std::endl;
+    }
+  }
+
+  void write_csv(std::ostream& out, const std::vector<Result>& results) {
+    out << std::defaultfloat <<
+      "name,iterations,repetitions,median_ns,mad_ns,min_ns,max_ns";
+    for (size_t event = 0; event < PerfCounters::N_EVENTS; event++) {
+      out << ',' << counter_key(PerfCounters::Event(event));
+    }
+    out << '\n';
+    for (const Result& result : results) {
+      out << result.name << ',' << result.iterations << ',' <<
+        result.samples.size() << ',' << std::setprecision(6) <<
+        result.median << ',' << result.mad << ',' << result.min << ',' <<
+        result.max;
+      // Counters that weren't collected are left empty.
+      for (size_t event = 0; event < PerfCounters::N_EVENTS; event++) {
+        out << ',';
+        if (result.counters.has(PerfCounters::Event(event))) {
+          out << result.counters[PerfCounters::Event(event)];
+        }
+      }
+      out << '\n';
+    }
+    out.flush();
+  }
+
+  void write_json(std::ostream& out, const std::vector<Result>& results) {
+    out << std::defaultfloat << "{\n  \"benchmarks\": [";
+    for (size_t idx = 0; idx < results.size(); idx++) {
+      const Result& result = results[idx];
+      out << (idx == 0 ? "\n" : ",\n") << std::setprecision(6) <<
+        "    {\"name\": \"" << escape_json(result.name) << "\", " <<
+        "\"iterations\": " << result.iterations << ", " <<
+        "\"repetitions\": " << result.samples.size() << ", " <<
+        "\"median_ns\": " << result.median << ", " <<
+        "\"mad_ns\": " << result.mad << ", " <<
+        "\"min_ns\": " << result.min << ", " <<
+        "\"max_ns\": " << result.max << ", \"samples_ns\": [";
+      for (size_t sample = 0; sample < result.samples.size(); sample++) {
+        out << (sample == 0 ? "" : ", ") << result.samples[sample];
+      }
+      out << "]";
+      if (has_counters({ result })) {
+        out << ", \"counters\": {";
+        bool first = true;
+        for (size_t event = 0; event < PerfCounters::N_EVENTS; event++) {
+          PerfCounters::Event id = PerfCounters::Event(event);
+          if (result.counters.has(id)) {
+            out << (first ? "" : ", ") << '"' << counter_key(id) << "\": " <<
+              result.counters[id];
+            first = false;
+          }
+        }
+        out << "}";
+      }
+      out << "}";
+    }
+    out << "\n  ]\n}" << std::endl;
+  }
+
+  bool parse_flag(const char* arg, const char* flag, std::string& value) {
+    size_t length = std::strlen(flag);
+    if (std::strncmp(arg, flag, length) != 0 || arg[length] != '=') {
+      return false;
+    }
+    value = arg + length + 1;
+    return true;
+  }
+
+  bool parse_option(const char* arg, Options& options) {
+    std::string value;
+    if (parse_flag(arg, "--filter", value)) {
+      options.filter = value;
+    }
+    else if (parse_flag(arg, "--repetitions", value)) {
+      options.repetitions = std::strtoull(value.c_str(), nullptr, 10);
+    }
+    else if (parse_flag(arg, "--min-time-ms", value)) {
+      options.min_time_ms = std::strtod(value.c_str(), nullptr);
+    }
+    else if (parse_flag(arg, "--warmup-ms", value)) {
+      options.warmup_ms = std::strtod(value.c_str(), nullptr);
+    }
+    else if (std::strcmp(arg, "--perf-counters") == 0) {
+      options.perf_counters = true;
+    }
+    else {
+      return false;
+    }
+    return true;
+  }
+
+  std::vector<Result> read_json(std::istream& in) {
+    std::string text((std::istreambuf_iterator<char>(in)),
+      std::istreambuf_iterator<char>());
+    JsonParser parser(text);
+    JsonValue root = parser.parse();
+
+    std::vector<Result> results;
+    const JsonValue* benchmarks = root.find("benchmarks");
+    if (!benchmarks || benchmarks->type != JsonValue::ARRAY) {
+      throw std::runtime_error("expected a \"benchmarks\" array.");
+    }
+    for (const JsonValue& entry : benchmarks->items) {
+      const JsonValue* name = entry.find("name");
+      if (!name || name->type != JsonValue::STRING) {
+        throw std::runtime_error("every benchmark needs a \"name\".");
+      }
+      Result result{};
+      result.name = name->text;
+      result.iterations = static_cast<size_t>(entry.number("iterations"));
+      result.median = entry.number("median_ns");
+      result.mad = entry.number("mad_ns");
+      result.min = entry.number("min_ns");
+      result.max = entry.number("max_ns");
+      if (const JsonValue* samples = entry.find("samples_ns")) {
+        for (const JsonValue& sample : samples->items) {
+          result.samples.push_back(sample.value);
+        }
+      }
+      if (const JsonValue* counters = entry.find("counters")) {
+        for (size_t event = 0; event < PerfCounters::N_EVENTS; event++) {
+          PerfCounters::Event id = PerfCounters::Event(event);
+          const JsonValue* count = counters->find(counter_key(id));
+          if (count && count->type == JsonValue::NUMBER) {
+            result.counters.counts[id] = count->value;
+            result.counters.valid[id] = true;
+          }
+        }
+      }
+      results.push_back(std::move(result));
+    }
+    return results;
+  }
+
+  int run_main(int argc, char** argv) {
+    Options options;
+    std::string format = "table";
+    std::string out_path;
+    for (int idx = 1; idx < argc; idx++) {
+      std::string value;
+      if (parse_option(argv[idx], options)) {
+        continue;
+      }
+      if (parse_flag(argv[idx], "--format", value) &&
+          (value == "table" || value == "csv" || value == "json")) {
+        format = value;
+      }
+      else if (parse_flag(argv[idx], "--out", value)) {
+        out_path = value;
+      }
+      else {
+        std::cerr << "unknown argument '" << argv[idx] << "'. usage: " <<
+          argv[0] << " [--filter=<substring>] [--repetitions=<n>]" <<
+          " [--min-time-ms=<ms>] [--warmup-ms=<ms>] [--perf-counters]" <<
+          " [--format=table|csv|json] [--out=<file>]" << std::endl;
+        return 1;
+      }
+    }
+
+    std::ofstream file;
+    if (!out_path.empty()) {
+      file.open(out_path);
+      if (!file) {
+        std::cerr << "failed to open '" << out_path << "'." << std::endl;
+        return 1;
+      }
+    }
+    std::ostream& out = out_path.empty() ? std::cout : file;
+
+    std::vector<Result> results = run_all(options);
+    if (format == "csv") {
+      write_csv(out, results);
+    }
+    else if (format == "json") {
+      write_json(out, results);
+    }
+    else {
+      write_table(out, results);
+    }
+    return 0;
+  }
+}
@@ -0,0 +1,214 @@
+#include "binary_log.h"
+
+#include <stdexcept>
+
+namespace binary_log
+{
+  namespace
+  {
+    template<typename T>
+    T read_as(const char* bytes) {
+      T value;
+      std::memcpy(&value, bytes, sizeof(T));
+      return value;
+    }
+
+    // Decode one argument and append it to 'out'. Returns a pointer just past
+    // the argument.
+    const char* append_arg(const char* args, std::string& out) {
+      uint8_t tag = static_cast<uint8_t>(*args++);
+      uint8_t kind = tag >> 4;
+      uint8_t size = tag & 0x0F;
+
+      if (kind == FLOATING) {
+        double value = 0.0;
+        switch (size) {
+          case 4: value = read_as<float>(args); break;
+          case 8: value = read_as<double>(args); break;
+          default: throw std::runtime_error("bad binary log argument size.");
+        }
+        out.append(std::to_string(value));
+      }
+      else if (kind == SIGNED) {
+        int64_t value = 0;
+        switch (size) {
+          case 1: value = read_as<int8_t>(args); break;
+          case 2: value = read_as<int16_t>(args); break;
+          case 4: value = read_as<int32_t>(args); break;
+          case 8: value = read_as<int64_t>(args); break;
+          default: throw std::runtime_error("bad binary log argument size.");
+        }
+        out.append(std::to_string(value));
+      }
+      else if (kind == UNSIGNED) {
+        uint64_t value = 0;
+        switch (size) {
+          case 1: value = read_as<uint8_t>(args); break;
+          case 2: value = read_as<uint16_t>(args); break;
+          case 4: value = read_as<uint32_t>(args); break;
+          case 8: value = read_as<uint64_t>(args); break;
+          default: throw std::runtime_error("bad binary log argument size.");
+        }
+        out.append(std::to_string(value));
+      }
+      else {
+        throw std::runtime_error("bad binary log argument type.");
+      }
+      return args + size;
+    }
+  }
+
+  const char* format_args(const std::string& format, size_t n_args,
+    const char* args, std::string& out) {
+    size_t pos = 0;
+    size_t n_used = 0;
+    while (pos < format.size()) {
+      size_t placeholder = format.find("{}", pos);
+      if (placeholder == std::string::npos || n_used == n_args) {
+        break;
+      }
+      out.append(format, pos, placeholder - pos);
+      args = append_arg(args, out);
+      n_used++;
+      pos = placeholder + 2;
+    }
+    out.append(format, pos, std::string::npos);
+
+    // Don't silently lose arguments that didn't have a placeholder.
+    for (; n_used < n_args; n_used++) {
+      out.push_back(' ');
+      args = append_arg(args, out);
+    }
+    return args;
+  }
+}
+
+uint32_t BinaryLogFormats::register_format(Logger::LogLevel level,
+  const char* text) {
+  std::lock_guard<std::mutex> lock(_mutex());
+  std::deque<Format>& formats = _formats();
+  formats.push_back({ level, text });
+  return static_cast<uint32_t>(formats.size() - 1);
+}
+
+const BinaryLogFormats::Format& BinaryLogFormats::get(uint32_t id) {
+  std::lock_guard<std::mutex> lock(_mutex());
+  return _formats().at(id);
+}
+
+// Function-local statics, so that call sites in other translation units can
+// safely register formats during static initialization.
+std::mutex& BinaryLogFormats::_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::deque<BinaryLogFormats::Format>& BinaryLogFormats::_formats() {
+  static std::deque<Format> formats;
+  return formats;
+}
+
+BinaryLogWriter::BinaryLogWriter(std::ostream& out, size_t buffer_size)
+  : out_(out), buffer_(buffer_size) {
+  char* header = _reserve(sizeof(binary_log::kMagic) + 1);
+  std::memcpy(header, binary_log::kMagic, sizeof(binary_log::kMagic));
+  header[sizeof(binary_log::kMagic)] = binary_log::kVersion;
+}
+
+BinaryLogWriter::~BinaryLogWriter() {
+  flush();
+}
+
+void BinaryLogWriter::flush() {
+  out_.write(buffer_.data(), size_);
+  out_.flush();
+  size_ = 0;
+}
+
+void BinaryLogWriter::_define_format(uint32_t format_id) {
+  const BinaryLogFormats::Format& format = BinaryLogFormats::get(format_id);
+  uint8_t level = static_cast<uint8_t>(format.level);
+  uint32_t length = static_cast<uint32_t>(format.text.size());
+
+  char* out = _reserve(1 + 4 + 1 + 4 + length);
+  *out++ = binary_log::FORMAT;
+  std::memcpy(out, &format_id, 4);
+  std::memcpy(out + 4, &level, 1);
+  std::memcpy(out + 5, &length, 4);
+  std::memcpy(out + 9, format.text.data(), length);
+
+  if (format_id >= defined_.size()) {
+    defined_.resize(format_id + 1, false);
+  }
+  defined_[format_id] = true;
+}
+
+BinaryLogReader::BinaryLogReader(std::istream& in) : in_(in) {
+  char header[sizeof(binary_log::kMagic) + 1];
+  if (!in_.read(header, sizeof(header)) ||
+      std::memcmp(header, binary_log::kMagic, sizeof(binary_log::kMagic)) != 0)
+  {
+    throw std::runtime_error("not a binary log file.");
+  }
+  if (static_cast<uint8_t>(header[sizeof(binary_log::kMagic)]) !=
+      binary_log::kVersion) {
+    throw std::runtime_error("unsupported binary log version.");
+  }
+}
+
+bool BinaryLogReader::next(Message& message) {
+  auto read = [this](void* dest, size_t n_bytes) {
+    if (!in_.read(static_cast<char*>(dest), n_bytes)) {
+      throw std::runtime_error("truncated binary log record.");
+    }
+  };
+
+  while (true) {
+    char type;
+    if (!in_.get(type)) {
+      return false;
+    }
+
+    uint32_t id;
+    read(&id, 4);
+    if (type == binary_log::FORMAT) {
+      uint8_t level;
+      uint32_t length;
+      read(&level, 1);
+      read(&length, 4);
+      BinaryLogFormats::Format& format = formats_[id];
+      format.level = static_cast<Logger::LogLevel>(level);
+      format.text.resize(length);
+      read(format.text.data(), length);
+      continue;
+    }
+    if (type != binary_log::MESSAGE) {
+      throw std::runtime_error("bad binary log record type.");
+    }
+
+    uint8_t n_args;
+    read(&message.timestamp, 8);
+    read(&n_args, 1);
+
+    // Arguments aren't length-prefixed, so read them one tag at a time.
+    args_.clear();
+    for (uint8_t arg = 0; arg < n_args; arg++) {
+      uint8_t tag;
+      read(&tag, 1);
+      size_t offset = args_.size();
+      args_.resize(offset + 1 + (tag & 0x0F));
+      args_[offset] = static_cast<char>(tag);
+      read(args_.data() + offset + 1, tag & 0x0F);
+    }
+
+    auto format = formats_.find(id);
+    if (format == formats_.end()) {
+      throw std::runtime_error("binary log message with an unknown format.");
+    }
+    message.level = format->second.level;
+    message.text.clear();
+    binary_log::format_args(format->second.text, n_args, args_.data(),
+      message.text);
+    return true;
+  }
+}
@@ -0,0 +1,366 @@
+#include "city_loader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+  #define CITY_LOADER_HAS_MMAP 1
+#else
+  #define CITY_LOADER_HAS_MMAP 0
+#endif
+
+namespace
+{
+  // std::from_chars for floating point only arrived in GCC 11 / MSVC 19.24.
+  // Elsewhere, fall back to strtod on a NUL-terminated copy.
+  bool parse_double(const char* first, const char* last, double& value) {
+#if defined(__cpp_lib_to_chars)
+    auto [end, error] = std::from_chars(first, last, value);
+    return error == std::errc() && end == last;
+#else
+    char buffer[64];
+    size_t length = static_cast<size_t>(last - first);
+    if (length == 0 || length >= sizeof(buffer)) {
+      return false;
+    }
+    std::memcpy(buffer, first, length);
+    buffer[length] = '\0';
+    char* end = nullptr;
+    value = std::strtod(buffer, &end);
+    return end == buffer + length;
+#endif
+  }
+
+  bool parse_uint(const char* first, const char* last, uint64_t& value) {
+    auto [end, error] = std::from_chars(first, last, value);
+    return error == std::errc() && end == last;
+  }
+
+  // The end of the field starting at 'first', i.e. the next comma (or 'last').
+  const char* field_end(const char* first, const char* last) {
+    const void* comma =
+      std::memchr(first, ',', static_cast<size_t>(last - first));
+    return comma ? static_cast<const char*>(comma) : last;
+  }
+
+  /**
+   * @brief Parse the name field at the start of [first, last) into 'name'.
+   * Returns a pointer to the comma after it, or nullptr if it's malformed.
+   */
+  const char* parse_name(const char* first, const char* last,
+    std::string& name) {
+    if (first == last || *first != '"') {
+      const char* end = field_end(first, last);
+      name.assign(first, end);
+      return end;
+    }
+
+    // A quoted name: "" stands for a single quote.
+    name.clear();
+    const char* pos = first + 1;
+    while (pos < last) {
+      const void* quote =
+        std::memchr(pos, '"', static_cast<size_t>(last - pos));
+      if (!quote) {
+        return nullptr;
+      }
+      const char* end = static_cast<const char*>(quote);
+      name.append(pos, end);
+      if (end + 1 < last && end[1] == '"') {
+        name.push_back('"');
+        pos = end + 2;
+        continue;
+      }
+      return end + 1 < last && end[1] == ',' ? end + 1 : nullptr;
+    }
+    return nullptr;
+  }
+
+  bool parse_row(const char* first, const char* last, CityRecord& city) {
+    const char* pos = parse_name(first, last, city.name);
+    if (!pos || pos == last) {
+      return false;
+    }
+    const char* end = field_end(++pos, last);
+    if (end == last || !parse_uint(pos, end, city.population)) {
+      return false;
+    }
+    pos = end + 1;
+    end = field_end(pos, last);
+    if (end == last || !parse_double(pos, end, city.latitude)) {
+      return false;
+    }
+    return parse_double(end + 1, last, city.longitude);
+  }
+
+  /**
+   * @brief Parse every row of 'text' and hand each one to emit(CityRecord&),
+   * which may move from it. See city_csv::parse().
+   */
+  template<typename Emit>
+  void parse_rows(std::string_view text, size_t offset, Emit emit) {
+    const char* const begin = text.data();
+    const char* const end = begin + text.size();
+    const char* line = begin;
+
+    // Only the first line of the file can be a header.
+    if (offset == 0 && text.compare(0, 5, "name,") == 0) {
+      const void* newline = std::memchr(line, '\n', text.size());
+      line = newline ? static_cast<const char*>(newline) + 1 : end;
+    }
+
+    CityRecord city;
+    while (line < end) {
+      const void* newline =
+        std::memchr(line, '\n', static_cast<size_t>(end - line));
+      const char* next = newline ? static_cast<const char*>(newline) + 1 : end;
+      const char* last = newline ? static_cast<const char*>(newline) : end;
+      if (last > line && last[-1] == '\r') {
+        last--;
+      }
+
+      if (last > line) {
+        if (!parse_row(line, last, city)) {
+          throw std::runtime_error("malformed CSV row at byte offset " +
+            std::to_string(offset + static_cast<size_t>(line - begin)) +
+            ": '" + std::string(line, last) + "'");
+        }
+        emit(city);
+      }
+      line = next;
+    }
+  }
+
+  // A very rough stand-in for real place names: a few random syllables.
+  std::string random_name(std::mt19937& rng) {
+    static const char* const kSyllables[] = {
+      "ber", "lin", "san", "ta", "fe", "mon", "ro", "vi", "ka", "lo", "mar",
+      "den", "ver", "bou", "der", "el", "pa", "so", "al", "bu", "quer", "que",
+      "red", "mond", "spring", "field", "port", "land", "ville", "ton"
+    };
+    const size_t n_syllables = sizeof(kSyllables) / sizeof(kSyllables[0]);
+
+    std::string name;
+    size_t length = 2 + rng() % 3;
+    for (size_t idx = 0; idx < length; idx++) {
+      name += kSyllables[rng() % n_syllables];
+    }
+    name[0] = static_cast<char>(name[0] - 'a' + 'A');
+    return name;
+  }
+}
+
+MappedFile::MappedFile(const std::string& path) {
+#if CITY_LOADER_HAS_MMAP
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("failed to open '" + path + "': " +
+      std::strerror(errno));
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    throw std::runtime_error("failed to stat '" + path + "': " +
+      std::strerror(errno));
+  }
+  size_ = static_cast<size_t>(info.st_size);
+  if (size_ == 0) {
+    // mmap() refuses to map nothing.
+    close(fd);
+    data_ = "";
+    return;
+  }
+
+  void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps the file open on its own.
+  close(fd);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error("failed to map '" + path + "': " +
+      std::strerror(errno));
+  }
+  // We read front to back, so ask the kernel to read ahead aggressively.
+  madvise(data, size_, MADV_SEQUENTIAL);
+  data_ = static_cast<const char*>(data);
+  mapped_ = true;
+#else
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    throw std::runtime_error("failed to open '" + path + "'");
+  }
+  buffer_.resize(static_cast<size_t>(file.tellg()));
+  file.seekg(0);
+  file.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+#endif
+}
+
+MappedFile::~MappedFile() {
+#if CITY_LOADER_HAS_MMAP
+  if (mapped_) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+#endif
+}
+
+void city_csv::parse(std::string_view text, std::vector<CityRecord>& cities,
+  size_t offset) {
+  parse_rows(text, offset, [&cities](CityRecord& city) {
+    cities.push_back(std::move(city));
+  });
+}
+
+size_t city_csv::parse(std::string_view text, CityRecord* cities,
+  size_t offset) {
+  size_t n_rows = 0;
+  parse_rows(text, offset, [cities, &n_rows](CityRecord& city) {
+    cities[n_rows++] = std::move(city);
+  });
+  return n_rows;
+}
+
+size_t city_csv::max_rows(std::string_view text) {
+  size_t n_lines =
+    static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+  // The last line may not end with a newline.
+  return n_lines + (!text.empty() && text.back() != '\n' ? 1 : 0);
+}
+
+std::vector<size_t> city_csv::split_lines(std::string_view text,
+  size_t n_chunks) {
+  n_chunks = std::max<size_t>(1, n_chunks);
+  std::vector<size_t> bounds = {0};
+  for (size_t chunk = 1; chunk < n_chunks; chunk++) {
+    size_t target = std::max(bounds.back(), text.size() / n_chunks * chunk);
+    size_t newline = text.find('\n', target);
+    if (newline == std::string_view::npos) {
+      break;
+    }
+    if (newline + 1 > bounds.back()) {
+      bounds.push_back(newline + 1);
+    }
+  }
+  if (bounds.back() != text.size()) {
+    bounds.push_back(text.size());
+  }
+  return bounds;
+}
+
+void city_csv::write_synthetic(std::ostream& out, size_t n_rows,
+  uint32_t seed) {
+  std::mt19937 rng(seed);
+  // Populations are log-uniform between 100 and 10 million, like real ones.
+  std::uniform_real_distribution<double> log_population(2.0, 7.0);
+  std::uniform_real_distribution<double> latitude(-90.0, 90.0);
+  std::uniform_real_distribution<double> longitude(-180.0, 180.0);
+
+  // Format into a large buffer and write it out in blocks: much faster than
+  // many small writes to the stream.
+  std::string buffer = "name,population,latitude,longitude\n";
+  char number[32];
+  for (size_t row = 0; row < n_rows; row++) {
+    // Make every name unique, and quote some of them (as if they contained a
+    // comma) to keep the loader honest.
+    std::string name = random_name(rng) + " " + std::to_string(row);
+    if (row % 50 == 0) {
+      buffer += "\"" + name + ", Province\"";
+    }
+    else {
+      buffer += name;
+    }
+
+    auto population =
+      static_cast<uint64_t>(std::pow(10.0, log_population(rng)));
+    buffer += ',';
+    buffer += std::to_string(population);
+    std::snprintf(number, sizeof(number), ",%.5f,%.5f\n", latitude(rng),
+      longitude(rng));
+    buffer += number;
+
+    if (buffer.size() >= (1 << 20)) {
+      out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      buffer.clear();
+    }
+  }
+  out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+}
+
+std::vector<CityRecord> load_cities_csv(const std::string& path,
+  ThreadPool& pool) {
+  MappedFile file(path);
+  std::string_view text = file.view();
+
+  // A few chunks per thread, so that threads that finish early can help with
+  // the rest.
+  std::vector<size_t> bounds =
+    city_csv::split_lines(text, (pool.size() + 1) * 4);
+  const size_t n_chunks = bounds.size() - 1;
+  auto chunk_text = [&](size_t chunk) {
+    return text.substr(bounds[chunk], bounds[chunk + 1] - bounds[chunk]);
+  };
+
+  // First count the lines in each chunk (a fast, vectorized scan), so that
+  // every chunk knows where its rows go in ONE vector allocated up front.
+  std::vector<size_t> starts(n_chunks + 1, 0);
+  pool.parallel_for(0, n_chunks, [&](size_t chunk) {
+    starts[chunk + 1] = city_csv::max_rows(chunk_text(chunk));
+  }, 1);
+  for (size_t chunk = 0; chunk < n_chunks; chunk++) {
+    starts[chunk + 1] += starts[chunk];
+  }
+
+  std::vector<CityRecord> cities(starts.back());
+  std::vector<size_t> n_rows(n_chunks, 0);
+  pool.parallel_for(0, n_chunks, [&](size_t chunk) {
+    n_rows[chunk] = city_csv::parse(chunk_text(chunk),
+      cities.data() + starts[chunk], bounds[chunk]);
+  }, 1);
+
+  // Blank lines and the header don't produce a row, which leaves a gap at the
+  // end of their chunk. Close the gaps (there usually aren't any).
+  size_t n_cities = 0;
+  for (size_t chunk = 0; chunk < n_chunks; chunk++) {
+    if (n_cities != starts[chunk]) {
+      std::move(cities.begin() + starts[chunk],
+        cities.begin() + starts[chunk] + n_rows[chunk],
+        cities.begin() + n_cities);
+    }
+    n_cities += n_rows[chunk];
+  }
+  cities.resize(n_cities);
+  return cities;
+}
+
+std::vector<CityRecord> load_cities_csv(const std::string& path) {
+  MappedFile file(path);
+  std::string_view text = file.view();
+  std::vector<CityRecord> cities(city_csv::max_rows(text));
+  cities.resize(city_csv::parse(text, cities.data()));
+  return cities;
+}
+
+FlatHashMap<std::string, CityRecord> build_city_map(
+  std::vector<CityRecord>&& cities) {
+  FlatHashMap<std::string, CityRecord> map;
+  map.reserve(cities.size());
+  for (CityRecord& city : cities) {
+    // Copy the name for the key BEFORE moving the record into the map.
+    std::string name = city.name;
+    map.try_emplace(std::move(name), std::move(city));
+  }
+  cities.clear();
+  return map;
+}
@@ -1,6 +1,7 @@
 // C++ standard library header files have no .h file extension (C header files do)
 #include <iostream>
 
+#include "async_log.h"
 #include "log.h"
 
 void log(const char* message)
@@ -10,26 +11,27 @@ void log(const char* message)
 
 void Logger::set_level(LogLevel log_level) { log_level_ = log_level; }
 
-void Logger::error(const char* message)
-{
-  if (this->log_level_ >= this->ERROR)
-  {
-    std::cout << "[ERROR]: " << message << std::endl; 
-  }
+void Logger::set_async_backend(AsyncLogBackend* backend) {
+  async_backend_ = backend;
 }
 
-void Logger::warn(const char* message)
+void Logger::_write(LogLevel log_level, const char* message)
 {
-  if (this->log_level_ >= this->WARNING)
-  {
-    std::cout << "[WARNING]: " << message << std::endl; 
+  if (async_backend_) {
+    async_backend_->enqueue(log_level, message);
+    return;
   }
-}
 
-void Logger::info(const char* message)
-{
-  if (this->log_level_ >= this->INFO)
+  switch (log_level)
   {
-    std::cout << "[INFO]: " << message << std::endl; 
+    case ERROR:
+      std::cout << "[ERROR]: " << message << std::endl;
+      break;
+    case WARNING:
+      std::cout << "[WARNING]: " << message << std::endl;
+      break;
+    case INFO:
+      std::cout << "[INFO]: " << message << std::endl;
+      break;
   }
-}
\ No newline at end of file
+}
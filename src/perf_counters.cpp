@@ -0,0 +1,198 @@
+#include "perf_counters.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+
+#ifdef __linux__
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef __linux__
+  // glibc doesn't wrap perf_event_open, so make the system call ourselves.
+  int open_counter(uint64_t config, uint32_t type) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    // Only count our own (user space) code.
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // If there are more events than hardware counters, the kernel takes turns
+    // ("multiplexing"). These let us scale the counts back up.
+    attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // pid = 0, cpu = -1: the calling thread, on whichever CPU it runs.
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+#endif
+}
+
+PerfCounters::Sample& PerfCounters::Sample::operator+=(const Sample& other) {
+  for (size_t event = 0; event < N_EVENTS; event++) {
+    counts[event] += other.counts[event];
+    valid[event] = valid[event] || other.valid[event];
+  }
+  return *this;
+}
+
+PerfCounters::Sample& PerfCounters::Sample::operator/=(double divisor) {
+  for (size_t event = 0; event < N_EVENTS; event++) {
+    counts[event] /= divisor;
+  }
+  return *this;
+}
+
+const char* PerfCounters::name(Event event) {
+  switch (event) {
+    case CYCLES: return "cycles";
+    case INSTRUCTIONS: return "instructions";
+    case CACHE_MISSES: return "cache misses";
+    case BRANCH_MISSES: return "branch misses";
+    default: return "unknown";
+  }
+}
+
+PerfCounters::PerfCounters() {
+  for (size_t event = 0; event < N_EVENTS; event++) {
+    fds_[event] = -1;
+  }
+
+#ifdef __linux__
+  const uint64_t configs[N_EVENTS] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+  };
+  for (size_t event = 0; event < N_EVENTS; event++) {
+    fds_[event] = open_counter(configs[event], PERF_TYPE_HARDWARE);
+    if (fds_[event] < 0 && error_.empty()) {
+      error_ = std::string("perf_event_open(") + name(Event(event)) +
+        ") failed: " + std::strerror(errno);
+    }
+  }
+#else
+  error_ = "hardware counters are only supported on Linux";
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+  for (int fd : fds_) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+#endif
+}
+
+bool PerfCounters::available() const {
+  for (int fd : fds_) {
+    if (fd >= 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void PerfCounters::start() {
+#ifdef __linux__
+  for (int fd : fds_) {
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+#endif
+}
+
+void PerfCounters::stop() {
+#ifdef __linux__
+  for (int fd : fds_) {
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+  }
+#endif
+}
+
+PerfCounters::Sample PerfCounters::read() const {
+  Sample sample;
+#ifdef __linux__
+  for (size_t event = 0; event < N_EVENTS; event++) {
+    // value, time enabled, time running
+    uint64_t values[3];
+    if (fds_[event] < 0 ||
+        ::read(fds_[event], values, sizeof(values)) != sizeof(values) ||
+        values[2] == 0) {
+      continue;
+    }
+    double scale = static_cast<double>(values[1]) / values[2];
+    sample.counts[event] = values[0] * scale;
+    sample.valid[event] = true;
+  }
+#endif
+  return sample;
+}
+
+PerfTimer::PerfTimer(size_t iterations, std::ostream& out)
+  : iterations_(iterations == 0 ? 1 : iterations), out_(out) {
+  counters_.start();
+  start_ = std::chrono::steady_clock::now();
+}
+
+PerfTimer::~PerfTimer() {
+  auto end = std::chrono::steady_clock::now();
+  counters_.stop();
+
+  std::chrono::duration<double, std::milli> elapsed = end - start_;
+  out_ << "Timer took " << elapsed.count() << "ms." << std::endl;
+  if (!counters_.available()) {
+    out_ << "  (no hardware counters: " << counters_.error() << ")" <<
+      std::endl;
+    return;
+  }
+
+  PerfCounters::Sample sample = counters_.read();
+  out_ << "  " << sample << std::endl;
+  if (iterations_ > 1) {
+    sample /= static_cast<double>(iterations_);
+    out_ << "  per iteration: " << sample << std::endl;
+  }
+}
+
+std::ostream& operator<<(std::ostream& stream,
+  const PerfCounters::Sample& sample) {
+  std::ios::fmtflags flags = stream.flags();
+  std::streamsize precision = stream.precision();
+  stream << std::fixed << std::setprecision(2);
+
+  bool first = true;
+  for (size_t event = 0; event < PerfCounters::N_EVENTS; event++) {
+    PerfCounters::Event id = PerfCounters::Event(event);
+    if (!sample.has(id)) {
+      continue;
+    }
+    stream << (first ? "" : ", ") << PerfCounters::name(id) << ": " <<
+      sample[id];
+    if (id == PerfCounters::INSTRUCTIONS && sample.has(PerfCounters::CYCLES)) {
+      stream << " (IPC " << sample.ipc() << ")";
+    }
+    first = false;
+  }
+  if (first) {
+    stream << "no counters";
+  }
+
+  stream.flags(flags);
+  stream.precision(precision);
+  return stream;
+}
@@ -0,0 +1,191 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+
+namespace
+{
+  // Scope names are usually identifiers, but escape anything that would break
+  // the JSON just in case.
+  void write_json_string(std::ostream& out, const char* text) {
+    out << '"';
+    for (const char* c = text; *c; c++) {
+      switch (*c) {
+        case '"': out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\t': out << "\\t"; break;
+        default:
+          if (static_cast<unsigned char>(*c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", *c);
+            out << escaped;
+          }
+          else {
+            out << *c;
+          }
+      }
+    }
+    out << '"';
+  }
+
+  // Nearest-rank percentile of a sorted list.
+  uint64_t percentile(const std::vector<uint64_t>& sorted, double p) {
+    size_t rank = static_cast<size_t>(p * sorted.size());
+    return sorted[std::min(rank, sorted.size() - 1)];
+  }
+}
+
+Profiler::Profiler()
+  : origin_ticks_(now()), origin_time_(std::chrono::steady_clock::now()) {}
+
+double Profiler::_ns_per_tick() const {
+#if PROFILER_HAS_RDTSC
+  // Compare how far the counter and the steady clock have moved. Give them at
+  // least 10 ms, or the ratio will be mostly noise.
+  const auto kMinElapsed = std::chrono::milliseconds(10);
+  auto elapsed = std::chrono::steady_clock::now() - origin_time_;
+  if (elapsed < kMinElapsed) {
+    std::this_thread::sleep_for(kMinElapsed - elapsed);
+  }
+  uint64_t ticks = now();
+  elapsed = std::chrono::steady_clock::now() - origin_time_;
+  return std::chrono::duration<double, std::nano>(elapsed).count() /
+    static_cast<double>(ticks - origin_ticks_);
+#else
+  // now() already counts nanoseconds.
+  return 1.0;
+#endif
+}
+
+Profiler::ThreadProfile* Profiler::_register_thread() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  threads_.push_back(std::make_unique<ThreadProfile>());
+  ThreadProfile* profile = threads_.back().get();
+  profile->thread_id = static_cast<uint32_t>(threads_.size() - 1);
+  // Reserve room so that opening a scope doesn't allocate either, unless
+  // scopes nest deeper than this.
+  profile->stack.reserve(64);
+  profile->events.resize(kMaxEvents);
+  return profile;
+}
+
+std::vector<Profiler::ScopeStats> Profiler::summary() const {
+  // Scopes with the same name in different translation units may not share a
+  // pointer, so group by the string itself.
+  const double ns_per_tick = _ns_per_tick();
+  std::unordered_map<std::string, std::vector<uint64_t>> durations;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const std::unique_ptr<ThreadProfile>& thread : threads_) {
+      thread->for_each_event([&](const Event& event) {
+        durations[event.name].push_back(static_cast<uint64_t>(
+          (event.end - event.start) * ns_per_tick));
+      });
+    }
+  }
+
+  std::vector<ScopeStats> stats;
+  stats.reserve(durations.size());
+  for (auto& [name, times] : durations) {
+    std::sort(times.begin(), times.end());
+    uint64_t total = 0;
+    for (uint64_t time : times) {
+      total += time;
+    }
+    stats.push_back({ name, times.size(), total, times.front(), times.back(),
+      percentile(times, 0.50), percentile(times, 0.99) });
+  }
+  std::sort(stats.begin(), stats.end(),
+    [](const ScopeStats& lhs, const ScopeStats& rhs) {
+      return lhs.total > rhs.total;
+    });
+  return stats;
+}
+
+void Profiler::print_summary(std::ostream& out) const {
+  // Print times in microseconds, nanoseconds are too noisy to read.
+  auto us = [](uint64_t ns) { return ns / 1000.0; };
+  // Leave the caller's stream formatted the way we found it.
+  std::ios_base::fmtflags flags = out.flags();
+  std::streamsize precision = out.precision();
+
+  out << std::left << std::setw(32) << "scope" << std::right <<
+    std::setw(10) << "count" << std::setw(14) << "total (us)" <<
+    std::setw(12) << "min" << std::setw(12) << "p50" <<
+    std::setw(12) << "p99" << std::setw(12) << "max" << std::endl;
+  for (const ScopeStats& scope : summary()) {
+    out << std::left << std::setw(32) << scope.name << std::right <<
+      std::setw(10) << scope.count << std::fixed << std::setprecision(3) <<
+      std::setw(14) << us(scope.total) <<
+      std::setw(12) << us(scope.min) <<
+      std::setw(12) << us(scope.p50) <<
+      std::setw(12) << us(scope.p99) <<
+      std::setw(12) << us(scope.max) << std::endl;
+  }
+  if (uint64_t dropped = n_dropped()) {
+    out << "(" << dropped << " older events were overwritten and are not " <<
+      "counted)" << std::endl;
+  }
+  out.flags(flags);
+  out.precision(precision);
+}
+
+void Profiler::write_chrome_trace(std::ostream& out) const {
+  const double us_per_tick = _ns_per_tick() / 1000.0;
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Timestamps are relative to the first event, in (fractional) microseconds.
+  uint64_t origin = std::numeric_limits<uint64_t>::max();
+  for (const std::unique_ptr<ThreadProfile>& thread : threads_) {
+    thread->for_each_event([&](const Event& event) {
+      origin = std::min(origin, event.start);
+    });
+  }
+
+  out << "{\"traceEvents\":[";
+  bool first = true;
+  char times[64];
+  for (const std::unique_ptr<ThreadProfile>& thread : threads_) {
+    thread->for_each_event([&](const Event& event) {
+      out << (first ? "\n" : ",\n");
+      first = false;
+      out << "{\"name\":";
+      write_json_string(out, event.name);
+      std::snprintf(times, sizeof(times), "\"ts\":%.3f,\"dur\":%.3f",
+        (event.start - origin) * us_per_tick,
+        (event.end - event.start) * us_per_tick);
+      out << ",\"cat\":\"scope\",\"ph\":\"X\"," << times << ",\"pid\":0," <<
+        "\"tid\":" << thread->thread_id;
+      if (event.parent) {
+        out << ",\"args\":{\"parent\":";
+        write_json_string(out, event.parent);
+        out << "}";
+      }
+      out << "}";
+    });
+  }
+  out << "\n],\"displayTimeUnit\":\"ns\"}" << std::endl;
+}
+
+uint64_t Profiler::n_dropped() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t dropped = 0;
+  for (const std::unique_ptr<ThreadProfile>& thread : threads_) {
+    if (thread->n_recorded > kMaxEvents) {
+      dropped += thread->n_recorded - kMaxEvents;
+    }
+  }
+  return dropped;
+}
+
+void Profiler::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const std::unique_ptr<ThreadProfile>& thread : threads_) {
+    thread->n_recorded = 0;
+  }
+}
@@ -0,0 +1,45 @@
+#include "shared_string.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+SharedString::SharedString(std::string_view string) {
+  if (!string.empty()) {
+    buffer_ = _allocate(string);
+    data_ = buffer_->chars();
+    size_ = string.size();
+  }
+}
+
+SharedString SharedString::substr(size_t pos, size_t count) const {
+  pos = std::min(pos, size_);
+  SharedString result(*this);
+  result.data_ = data_ + pos;
+  result.size_ = std::min(count, size_ - pos);
+  return result;
+}
+
+// The reference count and the characters share a single allocation.
+SharedString::Buffer* SharedString::_allocate(std::string_view string) {
+  void* block = ::operator new(sizeof(Buffer) + string.size());
+  Buffer* buffer = new(block) Buffer{{1}};
+  std::memcpy(buffer->chars(), string.data(), string.size());
+  return buffer;
+}
+
+void SharedString::_free(Buffer* buffer) {
+  buffer->~Buffer();
+  ::operator delete(buffer);
+}
+
+void SharedString::_make_unique() {
+  Buffer* buffer = _allocate(view());
+  _release();
+  buffer_ = buffer;
+  data_ = buffer->chars();
+}
+
+std::ostream& operator<<(std::ostream& stream, const SharedString& string) {
+  return stream << string.view();
+}
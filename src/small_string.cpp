@@ -0,0 +1,56 @@
+#include "small_string.h"
+
+#include <algorithm>
+
+void SmallString::reserve(size_t new_capacity) {
+  if (new_capacity > capacity()) {
+    _grow(new_capacity);
+  }
+}
+
+SmallString& SmallString::append(std::string_view string) {
+  size_t old_size = size();
+  size_t new_size = old_size + string.size();
+  if (new_size > capacity()) {
+    _grow(new_size, string);
+    return *this;
+  }
+  // 'string' may overlap our own characters (e.g. s.append(s)).
+  std::memmove(data() + old_size, string.data(), string.size());
+  _set_size(new_size);
+  return *this;
+}
+
+void SmallString::_assign(std::string_view string) {
+  if (string.size() <= kInlineCapacity) {
+    std::memcpy(bytes_, string.data(), string.size());
+    _set_inline_size(string.size());
+    return;
+  }
+  heap_.data = new char[string.size() + 1];
+  std::memcpy(heap_.data, string.data(), string.size());
+  heap_.size = string.size();
+  heap_.data[string.size()] = '\0';
+  _set_heap_capacity(string.size());
+}
+
+// Grow geometrically, so that repeated appends are amortized O(1).
+void SmallString::_grow(size_t min_capacity, std::string_view suffix) {
+  size_t old_size = size();
+  size_t new_capacity = std::max(min_capacity, 2 * capacity());
+  char* new_data = new char[new_capacity + 1];
+  std::memcpy(new_data, data(), old_size);
+  if (!suffix.empty()) {
+    std::memcpy(new_data + old_size, suffix.data(), suffix.size());
+  }
+  _release();
+
+  heap_.data = new_data;
+  heap_.size = old_size + suffix.size();
+  heap_.data[heap_.size] = '\0';
+  _set_heap_capacity(new_capacity);
+}
+
+std::ostream& operator<<(std::ostream& stream, const SmallString& string) {
+  return stream << std::string_view(string);
+}
@@ -0,0 +1,230 @@
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+  constexpr double kPi = 3.14159265358979323846;
+  constexpr double kRadiansPerDegree = kPi / 180.0;
+
+  double coordinate(const geo::UnitVector& vector, uint8_t axis) {
+    return axis == 0 ? vector.x : axis == 1 ? vector.y : vector.z;
+  }
+}
+
+geo::UnitVector geo::to_unit_vector(double latitude, double longitude) {
+  double lat = latitude * kRadiansPerDegree;
+  double lon = longitude * kRadiansPerDegree;
+  return {std::cos(lat) * std::cos(lon), std::cos(lat) * std::sin(lon),
+    std::sin(lat)};
+}
+
+// A chord of length c spans an angle of 2 * asin(c / 2) radians.
+double geo::chord2_to_km(double chord2) {
+  double half_chord = std::min(1.0, std::sqrt(chord2) / 2.0);
+  return 2.0 * std::asin(half_chord) * kEarthRadiusKm;
+}
+
+double geo::km_to_chord2(double km) {
+  double angle = std::min(kPi, km / kEarthRadiusKm);
+  double chord = 2.0 * std::sin(angle / 2.0);
+  return chord * chord;
+}
+
+double geo::distance_km(const GeoPoint& a, const GeoPoint& b) {
+  double dlat = (b.latitude - a.latitude) * kRadiansPerDegree;
+  double dlon = (b.longitude - a.longitude) * kRadiansPerDegree;
+  double h = std::sin(dlat / 2.0) * std::sin(dlat / 2.0) +
+    std::cos(a.latitude * kRadiansPerDegree) *
+    std::cos(b.latitude * kRadiansPerDegree) *
+    std::sin(dlon / 2.0) * std::sin(dlon / 2.0);
+  return 2.0 * std::asin(std::min(1.0, std::sqrt(h))) * kEarthRadiusKm;
+}
+
+SpatialIndex::SpatialIndex(const std::vector<CityRecord>& cities) {
+  points_.reserve(cities.size());
+  for (size_t idx = 0; idx < cities.size(); idx++) {
+    points_.push_back({geo::to_unit_vector(cities[idx].latitude,
+      cities[idx].longitude), static_cast<uint32_t>(idx)});
+  }
+  axes_.resize(points_.size(), 0);
+  _build(0, points_.size());
+}
+
+SpatialIndex::SpatialIndex(const std::vector<GeoPoint>& points) {
+  points_.reserve(points.size());
+  for (size_t idx = 0; idx < points.size(); idx++) {
+    points_.push_back({geo::to_unit_vector(points[idx].latitude,
+      points[idx].longitude), static_cast<uint32_t>(idx)});
+  }
+  axes_.resize(points_.size(), 0);
+  _build(0, points_.size());
+}
+
+// Split [begin, end) at its median along the axis where the points are most
+// spread out, then build both halves.
+void SpatialIndex::_build(size_t begin, size_t end) {
+  if (end - begin <= kLeafSize) {
+    return;
+  }
+
+  geo::UnitVector min = points_[begin].position;
+  geo::UnitVector max = min;
+  for (size_t idx = begin + 1; idx < end; idx++) {
+    const geo::UnitVector& position = points_[idx].position;
+    min = {std::min(min.x, position.x), std::min(min.y, position.y),
+      std::min(min.z, position.z)};
+    max = {std::max(max.x, position.x), std::max(max.y, position.y),
+      std::max(max.z, position.z)};
+  }
+  double extent[3] = {max.x - min.x, max.y - min.y, max.z - min.z};
+  uint8_t axis = static_cast<uint8_t>(
+    std::max_element(extent, extent + 3) - extent);
+
+  size_t middle = begin + (end - begin) / 2;
+  std::nth_element(points_.begin() + begin, points_.begin() + middle,
+    points_.begin() + end, [axis](const Point& lhs, const Point& rhs) {
+      return coordinate(lhs.position, axis) < coordinate(rhs.position, axis);
+    });
+  axes_[middle] = axis;
+
+  _build(begin, middle);
+  _build(middle + 1, end);
+}
+
+std::vector<SpatialIndex::Neighbor> SpatialIndex::nearest(
+  const GeoPoint& query, size_t k) const {
+  std::vector<std::pair<double, uint32_t>> heap;
+  if (k > 0) {
+    heap.reserve(k);
+    _nearest(0, points_.size(),
+      geo::to_unit_vector(query.latitude, query.longitude), k, heap);
+  }
+  return _to_neighbors(heap);
+}
+
+// 'heap' is a max-heap (by squared chord) of the best 'k' points so far.
+void SpatialIndex::_nearest(size_t begin, size_t end,
+  const geo::UnitVector& query, size_t k,
+  std::vector<std::pair<double, uint32_t>>& heap) const {
+  auto consider = [&](const Point& point) {
+    double distance = geo::chord2(query, point.position);
+    if (heap.size() < k) {
+      heap.emplace_back(distance, point.index);
+      std::push_heap(heap.begin(), heap.end());
+    }
+    else if (distance < heap.front().first) {
+      std::pop_heap(heap.begin(), heap.end());
+      heap.back() = {distance, point.index};
+      std::push_heap(heap.begin(), heap.end());
+    }
+  };
+
+  if (end - begin <= kLeafSize) {
+    for (size_t idx = begin; idx < end; idx++) {
+      consider(points_[idx]);
+    }
+    return;
+  }
+
+  size_t middle = begin + (end - begin) / 2;
+  const Point& node = points_[middle];
+  uint8_t axis = axes_[middle];
+  double offset = coordinate(query, axis) - coordinate(node.position, axis);
+
+  // Search the side the query is on first: it's most likely to contain the
+  // nearest points, which then lets us skip the other side entirely.
+  bool left_first = offset < 0.0;
+  if (left_first) {
+    _nearest(begin, middle, query, k, heap);
+  }
+  else {
+    _nearest(middle + 1, end, query, k, heap);
+  }
+  consider(node);
+  // Every point on the other side is at least |offset| away.
+  if (heap.size() < k || offset * offset < heap.front().first) {
+    if (left_first) {
+      _nearest(middle + 1, end, query, k, heap);
+    }
+    else {
+      _nearest(begin, middle, query, k, heap);
+    }
+  }
+}
+
+std::vector<SpatialIndex::Neighbor> SpatialIndex::within(
+  const GeoPoint& query, double radius_km) const {
+  std::vector<std::pair<double, uint32_t>> found;
+  if (radius_km >= 0.0) {
+    _within(0, points_.size(),
+      geo::to_unit_vector(query.latitude, query.longitude),
+      geo::km_to_chord2(radius_km), found);
+  }
+  return _to_neighbors(found);
+}
+
+void SpatialIndex::_within(size_t begin, size_t end,
+  const geo::UnitVector& query, double max_chord2,
+  std::vector<std::pair<double, uint32_t>>& found) const {
+  auto consider = [&](const Point& point) {
+    double distance = geo::chord2(query, point.position);
+    if (distance <= max_chord2) {
+      found.emplace_back(distance, point.index);
+    }
+  };
+
+  if (end - begin <= kLeafSize) {
+    for (size_t idx = begin; idx < end; idx++) {
+      consider(points_[idx]);
+    }
+    return;
+  }
+
+  size_t middle = begin + (end - begin) / 2;
+  const Point& node = points_[middle];
+  uint8_t axis = axes_[middle];
+  double offset = coordinate(query, axis) - coordinate(node.position, axis);
+
+  consider(node);
+  // Only cross the splitting plane if the ball around the query does.
+  if (offset <= 0.0 || offset * offset <= max_chord2) {
+    _within(begin, middle, query, max_chord2, found);
+  }
+  if (offset >= 0.0 || offset * offset <= max_chord2) {
+    _within(middle + 1, end, query, max_chord2, found);
+  }
+}
+
+std::vector<std::vector<SpatialIndex::Neighbor>> SpatialIndex::nearest(
+  const std::vector<GeoPoint>& queries, size_t k, ThreadPool& pool) const {
+  std::vector<std::vector<Neighbor>> results(queries.size());
+  pool.parallel_for(0, queries.size(), [&](size_t idx) {
+    results[idx] = nearest(queries[idx], k);
+  });
+  return results;
+}
+
+std::vector<std::vector<SpatialIndex::Neighbor>> SpatialIndex::within(
+  const std::vector<GeoPoint>& queries, double radius_km,
+  ThreadPool& pool) const {
+  std::vector<std::vector<Neighbor>> results(queries.size());
+  pool.parallel_for(0, queries.size(), [&](size_t idx) {
+    results[idx] = within(queries[idx], radius_km);
+  });
+  return results;
+}
+
+// Sort by distance (then index, for ties) and convert to kilometers.
+std::vector<SpatialIndex::Neighbor> SpatialIndex::_to_neighbors(
+  std::vector<std::pair<double, uint32_t>>& found) {
+  std::sort(found.begin(), found.end());
+  std::vector<Neighbor> neighbors;
+  neighbors.reserve(found.size());
+  for (const auto& [chord2, index] : found) {
+    neighbors.push_back({index, geo::chord2_to_km(chord2)});
+  }
+  return neighbors;
+}
@@ -0,0 +1,121 @@
+#include "stop_token.h"
+
+#include <algorithm>
+
+namespace
+{
+  /**
+   * @brief Registers an Event's mutex and condition variable with a token's
+   * stop state for as long as it's in scope, so that request_stop() wakes the
+   * Event's waiters too.
+   */
+  class WaiterRegistration
+  {
+    public:
+      WaiterRegistration(stop_detail::StopState* state, std::mutex* mutex,
+        std::condition_variable* condition)
+        : state_(state), waiter_(mutex, condition) {
+        if (state_) {
+          std::lock_guard<std::mutex> lock(state_->mutex);
+          state_->waiters.push_back(waiter_);
+        }
+      }
+
+      ~WaiterRegistration() {
+        if (state_) {
+          std::lock_guard<std::mutex> lock(state_->mutex);
+          auto& waiters = state_->waiters;
+          waiters.erase(std::find(waiters.begin(), waiters.end(), waiter_));
+        }
+      }
+
+      WaiterRegistration(const WaiterRegistration& other) = delete;
+      WaiterRegistration& operator=(const WaiterRegistration& other) = delete;
+
+    private:
+      stop_detail::StopState* state_;
+      std::pair<std::mutex*, std::condition_variable*> waiter_;
+  };
+}
+
+bool StopToken::sleep_until(
+  std::chrono::steady_clock::time_point deadline) const {
+  if (!state_) {
+    std::this_thread::sleep_until(deadline);
+    return true;
+  }
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  return !state_->condition.wait_until(lock, deadline, [this]() {
+    return state_->stopped.load(std::memory_order_acquire);
+  });
+}
+
+void StopToken::wait() const {
+  if (!state_) {
+    // Nobody can ever wake us up.
+    while (true) {
+      std::this_thread::sleep_for(std::chrono::hours(24));
+    }
+  }
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  state_->condition.wait(lock, [this]() {
+    return state_->stopped.load(std::memory_order_acquire);
+  });
+}
+
+bool StopSource::request_stop() {
+  if (state_->stopped.exchange(true, std::memory_order_acq_rel)) {
+    return false;
+  }
+
+  // A waiter checks 'stopped' while holding its mutex, right before it goes
+  // to sleep. Taking (and releasing) that same mutex here means it has either
+  // seen the flag or is already asleep, so the notify can't get lost.
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  state_->condition.notify_all();
+  for (auto& [mutex, condition] : state_->waiters) {
+    { std::lock_guard<std::mutex> waiter_lock(*mutex); }
+    condition->notify_all();
+  }
+  return true;
+}
+
+void Event::set() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    set_ = true;
+  }
+  condition_.notify_all();
+}
+
+void Event::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  set_ = false;
+}
+
+bool Event::is_set() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return set_;
+}
+
+bool Event::wait(const StopToken& token) {
+  return _wait(false, std::chrono::steady_clock::time_point(), token);
+}
+
+bool Event::_wait(bool has_deadline,
+  std::chrono::steady_clock::time_point deadline, const StopToken& token) {
+  // Register BEFORE checking the token below, or a stop requested in between
+  // would never wake us up. (We mustn't hold 'mutex_' here: request_stop()
+  // locks the stop state first and then 'mutex_'.)
+  WaiterRegistration registration(token.state_.get(), &mutex_, &condition_);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto ready = [this, &token]() { return set_ || token.stop_requested(); };
+  if (has_deadline) {
+    condition_.wait_until(lock, deadline, ready);
+  }
+  else {
+    condition_.wait(lock, ready);
+  }
+  return set_;
+}
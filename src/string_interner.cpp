@@ -0,0 +1,144 @@
+#include "string_interner.h"
+
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+namespace
+{
+  constexpr size_t kInitialTableSize = 1024;
+
+  size_t hash_string(std::string_view string) {
+    return std::hash<std::string_view>()(string);
+  }
+}
+
+// Id 0 is the empty string, so that a default-constructed InternedString is
+// valid in every interner.
+StringInterner::StringInterner() : table_(kInitialTableSize, 0) {
+  std::unique_lock lock(mutex_);
+  _insert(std::string_view(), hash_string(std::string_view()));
+}
+
+StringInterner::~StringInterner() {
+  for (std::atomic<Entry*>& block : blocks_) {
+    delete[] block.load(std::memory_order_relaxed);
+  }
+}
+
+InternedString StringInterner::intern(std::string_view string) {
+  size_t hash = hash_string(string);
+  {
+    std::shared_lock lock(mutex_);
+    if (std::optional<InternedString> found = _find(string, hash)) {
+      return *found;
+    }
+  }
+
+  // Another thread may have interned it between the two locks.
+  std::unique_lock lock(mutex_);
+  if (std::optional<InternedString> found = _find(string, hash)) {
+    return *found;
+  }
+  return _insert(string, hash);
+}
+
+std::optional<InternedString> StringInterner::find(
+  std::string_view string) const {
+  size_t hash = hash_string(string);
+  std::shared_lock lock(mutex_);
+  return _find(string, hash);
+}
+
+size_t StringInterner::size() const {
+  std::shared_lock lock(mutex_);
+  return size_;
+}
+
+size_t StringInterner::memory_usage() const {
+  std::shared_lock lock(mutex_);
+  size_t bytes = sizeof(*this) + characters_.capacity() +
+    table_.capacity() * sizeof(uint64_t);
+  for (size_t block = 0; block < kNumBlocks; block++) {
+    if (blocks_[block].load(std::memory_order_relaxed)) {
+      bytes += (size_t(1) << (block + kFirstBlockBits)) * sizeof(Entry);
+    }
+  }
+  return bytes;
+}
+
+// Linear probing, starting at the slot picked by the low bits of the hash.
+std::optional<InternedString> StringInterner::_find(std::string_view string,
+  size_t hash) const {
+  size_t mask = table_.size() - 1;
+  uint64_t hash_bits = _hash_bits(hash);
+  for (size_t idx = hash & mask; table_[idx] != 0; idx = (idx + 1) & mask) {
+    uint64_t slot = table_[idx];
+    if (_hash_bits(slot) != hash_bits) {
+      continue;
+    }
+    uint32_t id = static_cast<uint32_t>(slot) - 1;
+    const Entry& entry = _entry(id);
+    if (entry.size == string.size() &&
+        std::memcmp(entry.data, string.data(), string.size()) == 0) {
+      return InternedString(id);
+    }
+  }
+  return std::nullopt;
+}
+
+InternedString StringInterner::_insert(std::string_view string,
+  size_t hash) {
+  if (size_ == UINT32_MAX || string.size() > UINT32_MAX) {
+    throw std::length_error("StringInterner is full.");
+  }
+  // Keep the table at most half full, so that probe sequences stay short.
+  if (2 * (size_ + 1) > table_.size()) {
+    _grow_table();
+  }
+
+  uint32_t id = size_;
+  size_t block = _block(id);
+  Entry* entries = blocks_[block].load(std::memory_order_relaxed);
+  if (!entries) {
+    entries = new Entry[size_t(1) << (block + kFirstBlockBits)];
+    blocks_[block].store(entries, std::memory_order_release);
+  }
+
+  char* data = static_cast<char*>(
+    characters_.allocate(string.size() + 1, alignof(char)));
+  if (!string.empty()) {
+    std::memcpy(data, string.data(), string.size());
+  }
+  data[string.size()] = '\0';
+  entries[_offset(id, block)] = {data, hash,
+    static_cast<uint32_t>(string.size())};
+  size_++;
+
+  size_t mask = table_.size() - 1;
+  size_t idx = hash & mask;
+  while (table_[idx] != 0) {
+    idx = (idx + 1) & mask;
+  }
+  table_[idx] = _slot(hash, id);
+  return InternedString(id);
+}
+
+// Double the table. The hashes are stored in the entries, so no string has to
+// be hashed again.
+void StringInterner::_grow_table() {
+  std::vector<uint64_t> table(2 * table_.size(), 0);
+  size_t mask = table.size() - 1;
+  for (uint64_t slot : table_) {
+    if (slot == 0) {
+      continue;
+    }
+    size_t hash = _entry(static_cast<uint32_t>(slot) - 1).hash;
+    size_t idx = hash & mask;
+    while (table[idx] != 0) {
+      idx = (idx + 1) & mask;
+    }
+    table[idx] = slot;
+  }
+  table_.swap(table);
+}
@@ -0,0 +1,121 @@
+#include "thread_pool.h"
+
+namespace
+{
+  // Which pool (if any) the current thread works for, and its queue. Lets
+  // _enqueue keep tasks submitted by a task on the same worker.
+  thread_local ThreadPool* t_pool = nullptr;
+  thread_local size_t t_index = 0;
+}
+
+ThreadPool::ThreadPool(size_t n_threads) {
+  // hardware_concurrency() is allowed to return 0 if it can't tell.
+  if (n_threads == 0) {
+    n_threads = 1;
+  }
+  queues_.reserve(n_threads);
+  for (size_t idx = 0; idx < n_threads; idx++) {
+    queues_.push_back(std::make_unique<WorkQueue>());
+  }
+  // Create every queue before starting any worker, since workers steal from
+  // each other's.
+  workers_.reserve(n_threads);
+  for (size_t idx = 0; idx < n_threads; idx++) {
+    workers_.emplace_back(&ThreadPool::_worker_loop, this, idx);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stopping_ = true;
+  }
+  wake_up_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+bool ThreadPool::run_pending_task() {
+  Task task;
+  bool found = t_pool == this ?
+    _try_pop(t_index, task) || _try_steal(t_index + 1, task) :
+    _try_steal(next_queue_.load(std::memory_order_relaxed), task);
+  if (found) {
+    task();
+  }
+  return found;
+}
+
+void ThreadPool::_enqueue(Task task) {
+  size_t index = t_pool == this ? t_index :
+    next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+
+  // Count the task before it's visible, so a worker that takes it can never
+  // see the count drop below zero.
+  pending_++;
+  {
+    std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+    queues_[index]->tasks.push_back(std::move(task));
+  }
+
+  // A worker going to sleep increments 'n_sleeping_' BEFORE it checks
+  // 'pending_', and we incremented 'pending_' before checking 'n_sleeping_',
+  // so either it sees our task or we see it sleeping. Taking the lock makes
+  // sure it's actually waiting before we notify.
+  if (n_sleeping_ > 0) {
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    wake_up_.notify_one();
+  }
+}
+
+bool ThreadPool::_try_pop(size_t index, Task& task) {
+  WorkQueue& queue = *queues_[index];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task = std::move(queue.tasks.back());
+  queue.tasks.pop_back();
+  pending_--;
+  return true;
+}
+
+bool ThreadPool::_try_steal(size_t start, Task& task) {
+  for (size_t offset = 0; offset < queues_.size(); offset++) {
+    WorkQueue& queue = *queues_[(start + offset) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      pending_--;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::_worker_loop(size_t index) {
+  t_pool = this;
+  t_index = index;
+
+  while (true) {
+    Task task;
+    // Our own newest task first, then the oldest task of the next worker
+    // along (our own queue comes last in that loop, and is empty anyway).
+    if (_try_pop(index, task) || _try_steal(index + 1, task)) {
+      task();
+      continue;
+    }
+
+    // Sleep until there's a task to run (or we're shutting down).
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    n_sleeping_++;
+    wake_up_.wait(lock, [this]() { return pending_ > 0 || stopping_; });
+    n_sleeping_--;
+    if (stopping_ && pending_ == 0) {
+      // Only reachable once every queue has drained.
+      return;
+    }
+  }
+}
@@ -0,0 +1,219 @@
+#include "vec3_soa.h"
+#include "growth_policy.h"
+#include "simd_pack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+
+using simd::for_each_pack;
+using simd::SimdPack;
+
+namespace
+{
+  constexpr size_t kFloatsPerLine = Vec3SoA::kAlignment / sizeof(float);
+
+  // Folds the lanes of a pack into one float, e.g. with math::min.
+  template<typename Pack, typename Op>
+  float reduce(typename Pack::V value, float init, Op op) {
+    float lanes[Pack::kWidth];
+    Pack::store(lanes, value);
+    for (float lane : lanes) {
+      init = op(init, lane);
+    }
+    return init;
+  }
+}
+
+Vec3SoA::Vec3SoA(size_t size) {
+  resize(size);
+}
+
+Vec3SoA::Vec3SoA(const Vector<Vec3>& vecs) {
+  reserve(vecs.size());
+  for (size_t idx = 0; idx < vecs.size(); idx++) {
+    x()[idx] = vecs[idx].x;
+    y()[idx] = vecs[idx].y;
+    z()[idx] = vecs[idx].z;
+  }
+  size_ = vecs.size();
+}
+
+Vec3SoA::Vec3SoA(const Vec3SoA& other) {
+  reserve(other.size_);
+  std::copy_n(other.x(), other.size_, x());
+  std::copy_n(other.y(), other.size_, y());
+  std::copy_n(other.z(), other.size_, z());
+  size_ = other.size_;
+}
+
+Vec3SoA::Vec3SoA(Vec3SoA&& other) noexcept :
+  block_(std::exchange(other.block_, nullptr)),
+  size_(std::exchange(other.size_, 0)),
+  capacity_(std::exchange(other.capacity_, 0)) {}
+
+Vec3SoA& Vec3SoA::operator=(const Vec3SoA& other) {
+  if (this != &other) {
+    *this = Vec3SoA(other);
+  }
+  return *this;
+}
+
+Vec3SoA& Vec3SoA::operator=(Vec3SoA&& other) noexcept {
+  std::swap(block_, other.block_);
+  std::swap(size_, other.size_);
+  std::swap(capacity_, other.capacity_);
+  return *this;
+}
+
+Vec3SoA::~Vec3SoA() {
+  ::operator delete(block_, std::align_val_t(kAlignment));
+}
+
+void Vec3SoA::to_vector(Vector<Vec3>& vecs) const {
+  vecs.clear();
+  vecs.reserve(size_);
+  for (size_t idx = 0; idx < size_; idx++) {
+    vecs.emplace_back(x()[idx], y()[idx], z()[idx]);
+  }
+}
+
+void Vec3SoA::reserve(size_t new_capacity) {
+  if (new_capacity > capacity_) {
+    _reallocate(growth::round_up(new_capacity, kFloatsPerLine));
+  }
+}
+
+void Vec3SoA::resize(size_t new_size) {
+  reserve(new_size);
+  if (new_size > size_) {
+    std::fill(x() + size_, x() + new_size, 0.0f);
+    std::fill(y() + size_, y() + new_size, 0.0f);
+    std::fill(z() + size_, z() + new_size, 0.0f);
+  }
+  size_ = new_size;
+}
+
+void Vec3SoA::push_back(math::Vec3 value) {
+  if (size_ == capacity_) {
+    reserve(GrowHalf::grow(capacity_, size_ + 1, 3 * sizeof(float)));
+  }
+  x()[size_] = value.x;
+  y()[size_] = value.y;
+  z()[size_] = value.z;
+  size_++;
+}
+
+void Vec3SoA::_reallocate(size_t new_capacity) {
+  float* block = static_cast<float*>(::operator new(
+    3 * new_capacity * sizeof(float), std::align_val_t(kAlignment)));
+  if (size_ > 0) {
+    std::memcpy(block, x(), size_ * sizeof(float));
+    std::memcpy(block + new_capacity, y(), size_ * sizeof(float));
+    std::memcpy(block + 2 * new_capacity, z(), size_ * sizeof(float));
+  }
+  ::operator delete(block_, std::align_val_t(kAlignment));
+  block_ = block;
+  capacity_ = new_capacity;
+}
+
+/*
+ * With the x's, y's and z's in separate arrays, the kernels need none of the
+ * shuffling that the "array of structs" ones in vec_math.cpp do: every load
+ * fills a register with the same coordinate of consecutive elements.
+ */
+void Vec3SoA::transform(const math::Mat3& matrix, math::Vec3 translation) {
+  float* px = x();
+  float* py = y();
+  float* pz = z();
+  for_each_pack<SimdPack>(size_, [=, &matrix](auto pack, size_t idx) {
+    using P = decltype(pack);
+    auto vx = P::load(px + idx);
+    auto vy = P::load(py + idx);
+    auto vz = P::load(pz + idx);
+    // The same order of operations as math::dot(row, p) + translation.
+    auto row = [&](math::Vec3 r, float t) {
+      return P::add(P::add(P::add(P::mul(P::set1(r.x), vx),
+        P::mul(P::set1(r.y), vy)), P::mul(P::set1(r.z), vz)), P::set1(t));
+    };
+    auto tx = row(matrix.rows[0], translation.x);
+    auto ty = row(matrix.rows[1], translation.y);
+    auto tz = row(matrix.rows[2], translation.z);
+    P::store(px + idx, tx);
+    P::store(py + idx, ty);
+    P::store(pz + idx, tz);
+  });
+}
+
+// Keeps one running sum per lane, and only adds the lanes up at the end.
+math::Vec3 Vec3SoA::sum() const {
+  using P = SimdPack;
+  P::V sx = P::set1(0.0f);
+  P::V sy = sx;
+  P::V sz = sx;
+  size_t idx = 0;
+  for (; idx + P::kWidth <= size_; idx += P::kWidth) {
+    sx = P::add(sx, P::load(x() + idx));
+    sy = P::add(sy, P::load(y() + idx));
+    sz = P::add(sz, P::load(z() + idx));
+  }
+
+  auto plus = [](float a, float b) { return a + b; };
+  math::Vec3 total{reduce<P>(sx, 0.0f, plus), reduce<P>(sy, 0.0f, plus),
+    reduce<P>(sz, 0.0f, plus)};
+  for (; idx < size_; idx++) {
+    total = total + math::Vec3{x()[idx], y()[idx], z()[idx]};
+  }
+  return total;
+}
+
+// The same idea as sum(), with a running min and max per lane. The point comes
+// first in every min/max, so a NaN coordinate leaves the box alone.
+math::Box3 Vec3SoA::bounding_box() const {
+  using P = SimdPack;
+  math::Box3 box;
+  P::V min_x = P::set1(box.min.x);
+  P::V min_y = min_x;
+  P::V min_z = min_x;
+  P::V max_x = P::set1(box.max.x);
+  P::V max_y = max_x;
+  P::V max_z = max_x;
+  size_t idx = 0;
+  for (; idx + P::kWidth <= size_; idx += P::kWidth) {
+    P::V vx = P::load(x() + idx);
+    P::V vy = P::load(y() + idx);
+    P::V vz = P::load(z() + idx);
+    min_x = P::min(vx, min_x);
+    min_y = P::min(vy, min_y);
+    min_z = P::min(vz, min_z);
+    max_x = P::max(vx, max_x);
+    max_y = P::max(vy, max_y);
+    max_z = P::max(vz, max_z);
+  }
+
+  auto min = [](float a, float b) { return math::min(a, b); };
+  auto max = [](float a, float b) { return math::max(a, b); };
+  box.min = {reduce<P>(min_x, box.min.x, min),
+    reduce<P>(min_y, box.min.y, min), reduce<P>(min_z, box.min.z, min)};
+  box.max = {reduce<P>(max_x, box.max.x, max),
+    reduce<P>(max_y, box.max.y, max), reduce<P>(max_z, box.max.z, max)};
+  for (; idx < size_; idx++) {
+    box = math::grow(box, math::Vec3{x()[idx], y()[idx], z()[idx]});
+  }
+  return box;
+}
+
+void Vec3SoA::distances_to(math::Vec3 point, float* out) const {
+  const float* px = x();
+  const float* py = y();
+  const float* pz = z();
+  for_each_pack<SimdPack>(size_, [=](auto pack, size_t idx) {
+    using P = decltype(pack);
+    auto dx = P::sub(P::load(px + idx), P::set1(point.x));
+    auto dy = P::sub(P::load(py + idx), P::set1(point.y));
+    auto dz = P::sub(P::load(pz + idx), P::set1(point.z));
+    P::store(out + idx, P::sqrt(
+      P::add(P::add(P::mul(dx, dx), P::mul(dy, dy)), P::mul(dz, dz))));
+  });
+}
@@ -0,0 +1,246 @@
+#include "vec_math.h"
+#include "simd_pack.h"
+
+using simd::for_each_pack;
+using simd::ScalarPack;
+using simd::SimdPack;
+
+namespace
+{
+  template<typename Vec>
+  const float* floats(const Vec* vecs) {
+    return reinterpret_cast<const float*>(vecs);
+  }
+  template<typename Vec>
+  float* floats(Vec* vecs) {
+    return reinterpret_cast<float*>(vecs);
+  }
+
+  /*
+   * Every batch operation, for one Pack type. Component-wise operations treat
+   * the vectors as one long array of floats; the others split the vectors into
+   * x's, y's and z's first.
+   */
+  template<typename Pack>
+  struct Kernels
+  {
+    template<typename Vec>
+    static void add(const Vec* a, const Vec* b, Vec* out, size_t n) {
+      const float* fa = floats(a);
+      const float* fb = floats(b);
+      float* fout = floats(out);
+      for_each_pack<Pack>(n * sizeof(Vec) / sizeof(float),
+        [=](auto pack, size_t idx) {
+          using P = decltype(pack);
+          P::store(fout + idx, P::add(P::load(fa + idx), P::load(fb + idx)));
+        });
+    }
+
+    template<typename Vec>
+    static void sub(const Vec* a, const Vec* b, Vec* out, size_t n) {
+      const float* fa = floats(a);
+      const float* fb = floats(b);
+      float* fout = floats(out);
+      for_each_pack<Pack>(n * sizeof(Vec) / sizeof(float),
+        [=](auto pack, size_t idx) {
+          using P = decltype(pack);
+          P::store(fout + idx, P::sub(P::load(fa + idx), P::load(fb + idx)));
+        });
+    }
+
+    template<typename Vec>
+    static void scale(const Vec* a, float s, Vec* out, size_t n) {
+      const float* fa = floats(a);
+      float* fout = floats(out);
+      for_each_pack<Pack>(n * sizeof(Vec) / sizeof(float),
+        [=](auto pack, size_t idx) {
+          using P = decltype(pack);
+          P::store(fout + idx, P::mul(P::load(fa + idx), P::set1(s)));
+        });
+    }
+
+    // a + (b - a) * t
+    template<typename Vec>
+    static void lerp(const Vec* a, const Vec* b, float t, Vec* out,
+      size_t n) {
+      const float* fa = floats(a);
+      const float* fb = floats(b);
+      float* fout = floats(out);
+      for_each_pack<Pack>(n * sizeof(Vec) / sizeof(float),
+        [=](auto pack, size_t idx) {
+          using P = decltype(pack);
+          auto va = P::load(fa + idx);
+          auto diff = P::sub(P::load(fb + idx), va);
+          P::store(fout + idx, P::add(va, P::mul(diff, P::set1(t))));
+        });
+    }
+
+    template<typename Vec>
+    static void min(const Vec* a, const Vec* b, Vec* out, size_t n) {
+      const float* fa = floats(a);
+      const float* fb = floats(b);
+      float* fout = floats(out);
+      for_each_pack<Pack>(n * sizeof(Vec) / sizeof(float),
+        [=](auto pack, size_t idx) {
+          using P = decltype(pack);
+          P::store(fout + idx, P::min(P::load(fa + idx), P::load(fb + idx)));
+        });
+    }
+
+    template<typename Vec>
+    static void max(const Vec* a, const Vec* b, Vec* out, size_t n) {
+      const float* fa = floats(a);
+      const float* fb = floats(b);
+      float* fout = floats(out);
+      for_each_pack<Pack>(n * sizeof(Vec) / sizeof(float),
+        [=](auto pack, size_t idx) {
+          using P = decltype(pack);
+          P::store(fout + idx, P::max(P::load(fa + idx), P::load(fb + idx)));
+        });
+    }
+
+    static void dot(const math::Vec2* a, const math::Vec2* b, float* out,
+      size_t n) {
+      for_each_pack<Pack>(n, [=](auto pack, size_t idx) {
+        using P = decltype(pack);
+        typename P::V ax, ay, bx, by;
+        P::load2(floats(a + idx), ax, ay);
+        P::load2(floats(b + idx), bx, by);
+        P::store(out + idx, P::add(P::mul(ax, bx), P::mul(ay, by)));
+      });
+    }
+
+    static void dot(const math::Vec3* a, const math::Vec3* b, float* out,
+      size_t n) {
+      for_each_pack<Pack>(n, [=](auto pack, size_t idx) {
+        using P = decltype(pack);
+        typename P::V ax, ay, az, bx, by, bz;
+        P::load3(floats(a + idx), ax, ay, az);
+        P::load3(floats(b + idx), bx, by, bz);
+        P::store(out + idx, P::add(P::add(P::mul(ax, bx), P::mul(ay, by)),
+          P::mul(az, bz)));
+      });
+    }
+
+    static void cross(const math::Vec2* a, const math::Vec2* b, float* out,
+      size_t n) {
+      for_each_pack<Pack>(n, [=](auto pack, size_t idx) {
+        using P = decltype(pack);
+        typename P::V ax, ay, bx, by;
+        P::load2(floats(a + idx), ax, ay);
+        P::load2(floats(b + idx), bx, by);
+        P::store(out + idx, P::sub(P::mul(ax, by), P::mul(ay, bx)));
+      });
+    }
+
+    static void cross(const math::Vec3* a, const math::Vec3* b,
+      math::Vec3* out, size_t n) {
+      for_each_pack<Pack>(n, [=](auto pack, size_t idx) {
+        using P = decltype(pack);
+        typename P::V ax, ay, az, bx, by, bz;
+        P::load3(floats(a + idx), ax, ay, az);
+        P::load3(floats(b + idx), bx, by, bz);
+        P::store3(floats(out + idx),
+          P::sub(P::mul(ay, bz), P::mul(az, by)),
+          P::sub(P::mul(az, bx), P::mul(ax, bz)),
+          P::sub(P::mul(ax, by), P::mul(ay, bx)));
+      });
+    }
+
+    static void length(const math::Vec2* a, float* out, size_t n) {
+      for_each_pack<Pack>(n, [=](auto pack, size_t idx) {
+        using P = decltype(pack);
+        typename P::V x, y;
+        P::load2(floats(a + idx), x, y);
+        P::store(out + idx, P::sqrt(P::add(P::mul(x, x), P::mul(y, y))));
+      });
+    }
+
+    static void length(const math::Vec3* a, float* out, size_t n) {
+      for_each_pack<Pack>(n, [=](auto pack, size_t idx) {
+        using P = decltype(pack);
+        typename P::V x, y, z;
+        P::load3(floats(a + idx), x, y, z);
+        P::store(out + idx, P::sqrt(
+          P::add(P::add(P::mul(x, x), P::mul(y, y)), P::mul(z, z))));
+      });
+    }
+
+    // A division (not an approximate reciprocal), to match the scalar code.
+    static void normalize(const math::Vec2* a, math::Vec2* out, size_t n) {
+      for_each_pack<Pack>(n, [=](auto pack, size_t idx) {
+        using P = decltype(pack);
+        typename P::V x, y;
+        P::load2(floats(a + idx), x, y);
+        auto len = P::sqrt(P::add(P::mul(x, x), P::mul(y, y)));
+        P::store2(floats(out + idx), P::if_positive(len, P::div(x, len)),
+          P::if_positive(len, P::div(y, len)));
+      });
+    }
+
+    static void normalize(const math::Vec3* a, math::Vec3* out, size_t n) {
+      for_each_pack<Pack>(n, [=](auto pack, size_t idx) {
+        using P = decltype(pack);
+        typename P::V x, y, z;
+        P::load3(floats(a + idx), x, y, z);
+        auto len = P::sqrt(
+          P::add(P::add(P::mul(x, x), P::mul(y, y)), P::mul(z, z)));
+        P::store3(floats(out + idx), P::if_positive(len, P::div(x, len)),
+          P::if_positive(len, P::div(y, len)),
+          P::if_positive(len, P::div(z, len)));
+      });
+    }
+  };
+}
+
+const char* math::simd_instruction_set() { return simd::kInstructionSet; }
+
+/*
+ * The public functions just pick the Kernels: SimdPack for math::,
+ * ScalarPack for math::scalar::.
+ */
+#define VEC_MATH_DEFINE_BATCH_FUNCTIONS(PACK, Vec, Cross)                      \
+  void add(const Vec* a, const Vec* b, Vec* out, size_t n) {                   \
+    Kernels<PACK>::add(a, b, out, n);                                          \
+  }                                                                            \
+  void sub(const Vec* a, const Vec* b, Vec* out, size_t n) {                   \
+    Kernels<PACK>::sub(a, b, out, n);                                          \
+  }                                                                            \
+  void scale(const Vec* a, float s, Vec* out, size_t n) {                      \
+    Kernels<PACK>::scale(a, s, out, n);                                        \
+  }                                                                            \
+  void dot(const Vec* a, const Vec* b, float* out, size_t n) {                 \
+    Kernels<PACK>::dot(a, b, out, n);                                          \
+  }                                                                            \
+  void cross(const Vec* a, const Vec* b, Cross* out, size_t n) {               \
+    Kernels<PACK>::cross(a, b, out, n);                                        \
+  }                                                                            \
+  void length(const Vec* a, float* out, size_t n) {                            \
+    Kernels<PACK>::length(a, out, n);                                          \
+  }                                                                            \
+  void normalize(const Vec* a, Vec* out, size_t n) {                           \
+    Kernels<PACK>::normalize(a, out, n);                                       \
+  }                                                                            \
+  void lerp(const Vec* a, const Vec* b, float t, Vec* out, size_t n) {         \
+    Kernels<PACK>::lerp(a, b, t, out, n);                                      \
+  }                                                                            \
+  void min(const Vec* a, const Vec* b, Vec* out, size_t n) {                   \
+    Kernels<PACK>::min(a, b, out, n);                                          \
+  }                                                                            \
+  void max(const Vec* a, const Vec* b, Vec* out, size_t n) {                   \
+    Kernels<PACK>::max(a, b, out, n);                                          \
+  }
+
+namespace math
+{
+  VEC_MATH_DEFINE_BATCH_FUNCTIONS(SimdPack, Vec2, float)
+  VEC_MATH_DEFINE_BATCH_FUNCTIONS(SimdPack, Vec3, Vec3)
+
+  namespace scalar
+  {
+    VEC_MATH_DEFINE_BATCH_FUNCTIONS(ScalarPack, Vec2, float)
+    VEC_MATH_DEFINE_BATCH_FUNCTIONS(ScalarPack, Vec3, Vec3)
+  }
+}
+
+#undef VEC_MATH_DEFINE_BATCH_FUNCTIONS
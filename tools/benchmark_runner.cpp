@@ -0,0 +1,200 @@
+/*
+ * The benchmark regression gate. Runs every benchmark registered with
+ * BENCHMARK() that's linked into it (see CMakeLists.txt:
+ * app/74_benchmarking.cpp and every source file in bench/regression/) and
+ * compares each median against a baseline recorded earlier on the same
+ * machine.
+ *
+ * A benchmark has regressed if its median got slower by more than the
+ * allowed noise, which is the larger of:
+ * - --threshold percent (default 5%), and
+ * - --mad-factor (default 3) times the combined relative MAD of the baseline
+ *   and current runs, so that noisy benchmarks need a bigger change to count.
+ * Getting faster by more than the allowed noise is reported as an improvement.
+ *
+ * Typical use:
+ *   ./benchmark_runner --update-baseline     # on the commit before a change
+ *   ./benchmark_runner                       # after the change
+ *
+ * Exits with 0 if nothing regressed, 1 if something did and 2 on bad arguments
+ * or a missing/corrupt baseline.
+ *
+ * usage: benchmark_runner [--baseline=<file>] [--update-baseline]
+ *   [--threshold=<percent>] [--mad-factor=<k>] [--out=<file>]
+ *   [--filter=<substring>] [--repetitions=<n>] [--min-time-ms=<ms>]
+ *   [--warmup-ms=<ms>] [--perf-counters]
+ */
+
+#include "benchmark.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  void print_usage(const char* program) {
+    std::cerr << "usage: " << program << " [--baseline=<file>]" <<
+      " [--update-baseline] [--threshold=<percent>] [--mad-factor=<k>]" <<
+      " [--out=<file>] [--filter=<substring>] [--repetitions=<n>]" <<
+      " [--min-time-ms=<ms>] [--warmup-ms=<ms>] [--perf-counters]" <<
+      std::endl;
+  }
+
+  bool write_results(const std::string& path,
+    const std::vector<bench::Result>& results) {
+    std::ofstream file(path);
+    if (!file) {
+      std::cerr << "failed to open '" << path << "' for writing." << std::endl;
+      return false;
+    }
+    bench::write_json(file, results);
+    return true;
+  }
+
+  double relative_mad(const bench::Result& result) {
+    return result.median > 0.0 ? result.mad / result.median : 0.0;
+  }
+}
+
+int main(int argc, char** argv) {
+  bench::Options options;
+  std::string baseline_path = "benchmark_baseline.json";
+  std::string out_path;
+  bool update_baseline = false;
+  double threshold = 5.0;
+  double mad_factor = 3.0;
+
+  for (int idx = 1; idx < argc; idx++) {
+    std::string value;
+    if (bench::parse_option(argv[idx], options)) {
+      continue;
+    }
+    if (bench::parse_flag(argv[idx], "--baseline", value)) {
+      baseline_path = value;
+    }
+    else if (std::strcmp(argv[idx], "--update-baseline") == 0) {
+      update_baseline = true;
+    }
+    else if (bench::parse_flag(argv[idx], "--threshold", value)) {
+      threshold = std::strtod(value.c_str(), nullptr);
+    }
+    else if (bench::parse_flag(argv[idx], "--mad-factor", value)) {
+      mad_factor = std::strtod(value.c_str(), nullptr);
+    }
+    else if (bench::parse_flag(argv[idx], "--out", value)) {
+      out_path = value;
+    }
+    else {
+      std::cerr << "unknown argument '" << argv[idx] << "'." << std::endl;
+      print_usage(argv[0]);
+      return 2;
+    }
+  }
+
+  // Read the baseline BEFORE spending minutes on the benchmarks.
+  std::vector<bench::Result> baseline;
+  if (!update_baseline) {
+    std::ifstream file(baseline_path);
+    if (!file) {
+      std::cerr << "no baseline at '" << baseline_path << "'. Record one " <<
+        "first with --update-baseline." << std::endl;
+      return 2;
+    }
+    try {
+      baseline = bench::read_json(file);
+    }
+    catch (const std::exception& error) {
+      std::cerr << baseline_path << ": " << error.what() << std::endl;
+      return 2;
+    }
+  }
+
+  std::vector<bench::Result> results = bench::run_all(options);
+  if (!out_path.empty() && !write_results(out_path, results)) {
+    return 2;
+  }
+
+  if (update_baseline) {
+    if (!write_results(baseline_path, results)) {
+      return 2;
+    }
+    bench::write_table(std::cout, results);
+    std::cout << "\nWrote a baseline of " << results.size() <<
+      " benchmarks to '" << baseline_path << "'." << std::endl;
+    return 0;
+  }
+
+  size_t n_regressions = 0;
+  size_t n_improvements = 0;
+  size_t n_unchanged = 0;
+  size_t n_new = 0;
+
+  std::cout << std::left << std::setw(32) << "benchmark" << std::right <<
+    std::setw(16) << "baseline (ns)" << std::setw(16) << "current (ns)" <<
+    std::setw(10) << "change" << std::setw(10) << "allowed" << "  status" <<
+    std::endl;
+  for (const bench::Result& result : results) {
+    auto base = std::find_if(baseline.begin(), baseline.end(),
+      [&result](const bench::Result& entry) {
+        return entry.name == result.name;
+      });
+
+    std::cout << std::left << std::setw(32) << result.name << std::right <<
+      std::fixed << std::setprecision(2);
+    if (base == baseline.end() || base->median <= 0.0) {
+      n_new++;
+      std::cout << std::setw(16) << "-" << std::setw(16) << result.median <<
+        std::setw(10) << "-" << std::setw(10) << "-" << "  NEW" << std::endl;
+      continue;
+    }
+
+    double change = 100.0 * (result.median - base->median) / base->median;
+    double allowed = std::max(threshold,
+      100.0 * mad_factor * (relative_mad(*base) + relative_mad(result)));
+    const char* status = "ok";
+    if (change > allowed) {
+      status = "REGRESSION";
+      n_regressions++;
+    }
+    else if (change < -allowed) {
+      status = "improvement";
+      n_improvements++;
+    }
+    else {
+      n_unchanged++;
+    }
+
+    std::cout << std::setw(16) << base->median <<
+      std::setw(16) << result.median <<
+      std::setw(9) << std::showpos << std::setprecision(1) << change << "%" <<
+      std::noshowpos << std::setw(9) << allowed << "%" <<
+      "  " << status << std::endl;
+  }
+
+  // Benchmarks in the baseline that didn't run (and weren't filtered out) have
+  // probably been renamed or removed, which deserves a mention.
+  size_t n_missing = 0;
+  for (const bench::Result& entry : baseline) {
+    bool ran = std::any_of(results.begin(), results.end(),
+      [&entry](const bench::Result& result) {
+        return result.name == entry.name;
+      });
+    if (!ran && entry.name.find(options.filter) != std::string::npos) {
+      std::cout << std::left << std::setw(32) << entry.name << std::right <<
+        "  MISSING (in the baseline, but not run)" << std::endl;
+      n_missing++;
+    }
+  }
+
+  std::cout << "\n" << n_regressions << " regression(s), " <<
+    n_improvements << " improvement(s), " << n_unchanged << " unchanged, " <<
+    n_new << " new, " << n_missing << " missing." << std::endl;
+  return n_regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,70 @@
+/*
+ * Turns a binary log file written by BinaryLogWriter (see binary_log.h) back
+ * into the same text the Logger would have printed, one message per line:
+ *
+ *   [2024-05-01 12:34:56.123456789] [INFO]: loaded 1000 cities in 12 ms
+ *
+ * usage: binary_log_decode <file.binlog>
+ */
+
+#include "binary_log.h"
+
+#include <cstdio>
+#include <ctime>
+#include <exception>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+  const char* level_name(Logger::LogLevel level) {
+    switch (level) {
+      case Logger::ERROR: return "ERROR";
+      case Logger::WARNING: return "WARNING";
+      default: return "INFO";
+    }
+  }
+
+  // Format a timestamp (nanoseconds since the epoch) as UTC.
+  void print_timestamp(std::ostream& out, uint64_t timestamp) {
+    std::time_t seconds = static_cast<std::time_t>(timestamp / 1'000'000'000);
+    std::tm utc;
+    gmtime_r(&seconds, &utc);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &utc);
+    char nanoseconds[16];
+    std::snprintf(nanoseconds, sizeof(nanoseconds), ".%09llu",
+      static_cast<unsigned long long>(timestamp % 1'000'000'000));
+    out << date << nanoseconds;
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    std::cerr << "usage: " << argv[0] << " <file.binlog>" << std::endl;
+    return 2;
+  }
+
+  std::ifstream in(argv[1], std::ios::binary);
+  if (!in) {
+    std::cerr << "failed to open '" << argv[1] << "'." << std::endl;
+    return 1;
+  }
+
+  try {
+    BinaryLogReader reader(in);
+    BinaryLogReader::Message message;
+    while (reader.next(message)) {
+      std::cout << "[";
+      print_timestamp(std::cout, message.timestamp);
+      std::cout << "] [" << level_name(message.level) << "]: " <<
+        message.text << '\n';
+    }
+  }
+  catch (const std::exception& error) {
+    std::cout.flush();
+    std::cerr << argv[1] << ": " << error.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,53 @@
+/*
+ * Writes a synthetic CSV file of cities for load_cities_csv (see
+ * city_loader.h) to chew on, e.g. for bench_city_loader:
+ *
+ *   name,population,latitude,longitude
+ *   "Santaber 0, Province",48213,12.34567,-98.76543
+ *   Kalomar 1,2150,-45.12345,101.23456
+ *   ...
+ *
+ * 10^6 rows are about 40 MB. The output defaults to data/cities.csv, which is
+ * deliberately not checked in (see .gitignore).
+ *
+ * usage: generate_cities_csv [n_rows] [output] [seed]
+ */
+
+#include "city_loader.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+  size_t n_rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+  std::string path = argc > 2 ? argv[2] : "data/cities.csv";
+  uint32_t seed = argc > 3 ?
+    static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 42;
+
+  std::filesystem::path parent = std::filesystem::path(path).parent_path();
+  std::error_code error;
+  if (!parent.empty() && !std::filesystem::create_directories(parent, error) &&
+      error) {
+    std::cerr << "failed to create '" << parent.string() << "': " <<
+      error.message() << std::endl;
+    return 1;
+  }
+
+  std::ofstream file(path, std::ios::binary);
+  if (!file) {
+    std::cerr << "failed to open '" << path << "' for writing." << std::endl;
+    return 1;
+  }
+  city_csv::write_synthetic(file, n_rows, seed);
+  file.close();
+  if (!file) {
+    std::cerr << "failed to write '" << path << "'." << std::endl;
+    return 1;
+  }
+  std::cout << "Wrote " << n_rows << " cities to '" << path << "'." <<
+    std::endl;
+  return 0;
+}